@@ -0,0 +1,246 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+
+//coroutines need C++20, and the rest of the library doesn't, so this header is empty without them.
+#ifdef __has_include
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define CRU_EVENT_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef CRU_EVENT_HAS_COROUTINES
+#include <coroutine>
+#include <optional>
+#include <stop_token>
+
+namespace cru
+{
+    //the awaiter of "co_await event": suspend until the next emit of the event,
+    //then resume with its arguments as std::tuple<std::decay_t<Args>...>.
+    //
+    //  Event<void(int, std::string)> received;
+    //  auto [id, text] = co_await received;
+    //
+    //the awaiter is the node the event keeps in its list of waiters, and it lives in the coroutine frame,
+    //so a wait allocates nothing, and registers nothing in the event that outlives it.
+    //the coroutine resumes inside the emit, after the handlers, on the thread that emits.
+    //if it's destroyed while waiting, it just leaves the list;
+    //if the event is destroyed first, the coroutine is never resumed.
+    template<typename... Args>
+    class EmitAwaiter : private internal::EmitWaiter<Args...>
+    {
+    public:
+        using ValueType = std::tuple<std::decay_t<Args>...>;
+
+        explicit EmitAwaiter(internal::EmitWaiter<Args...>*& waiters) : waiters_(waiters) { }
+        EmitAwaiter(const EmitAwaiter&) = delete;
+        EmitAwaiter& operator = (const EmitAwaiter&) = delete;
+        ~EmitAwaiter() { this->Unlink(); }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        ValueType await_resume() { return std::move(*value_); }
+
+    private:
+        static void Resume(internal::EmitWaiter<Args...>& waiter, Args&... args);
+
+        internal::EmitWaiter<Args...>*& waiters_;
+        std::coroutine_handle<> handle_;
+        std::optional<ValueType> value_;
+    };
+
+    //the same as EmitAwaiter, but a stop request on "token" resumes the coroutine at once with an empty optional.
+    //the stop must be requested on the thread that emits the event, as the event is no more thread safe than that.
+    template<typename... Args>
+    class CancellableEmitAwaiter : private internal::EmitWaiter<Args...>
+    {
+    public:
+        using ValueType = std::tuple<std::decay_t<Args>...>;
+
+        CancellableEmitAwaiter(internal::EmitWaiter<Args...>*& waiters, std::stop_token token) : waiters_(waiters), token_(std::move(token)) { }
+        CancellableEmitAwaiter(const CancellableEmitAwaiter&) = delete;
+        CancellableEmitAwaiter& operator = (const CancellableEmitAwaiter&) = delete;
+        ~CancellableEmitAwaiter() { this->Unlink(); }
+
+        bool await_ready() const noexcept { return token_.stop_requested(); }
+        void await_suspend(std::coroutine_handle<> handle);
+        std::optional<ValueType> await_resume() { return std::move(value_); }
+
+    private:
+        struct Cancel
+        {
+            CancellableEmitAwaiter* awaiter;
+
+            void operator()() const
+            {
+                awaiter->Unlink();
+                awaiter->handle_.resume();
+            }
+        };
+
+        static void Resume(internal::EmitWaiter<Args...>& waiter, Args&... args);
+
+        internal::EmitWaiter<Args...>*& waiters_;
+        std::stop_token token_;
+        std::coroutine_handle<> handle_;
+        std::optional<ValueType> value_;
+        std::optional<std::stop_callback<Cancel>> stopCallback_;
+    };
+
+    template<typename R, typename... Args, typename Instrumentation>
+    EmitAwaiter<Args...> operator co_await(Event<R(Args...), Instrumentation>& event)
+    {
+        return EmitAwaiter<Args...>(internal::EventAccess::GetWaiters(event));
+    }
+
+    //"co_await NextEmit(event, token)" gives the arguments of the next emit, or nothing if "token" is stopped first.
+    template<typename R, typename... Args, typename Instrumentation>
+    CancellableEmitAwaiter<Args...> NextEmit(Event<R(Args...), Instrumentation>& event, std::stop_token token)
+    {
+        return CancellableEmitAwaiter<Args...>(internal::EventAccess::GetWaiters(event), std::move(token));
+    }
+
+    template<typename ...Args>
+    inline void EmitAwaiter<Args...>::await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        this->resume = &Resume;
+        this->Push(waiters_);
+    }
+
+    template<typename ...Args>
+    inline void EmitAwaiter<Args...>::Resume(internal::EmitWaiter<Args...>& waiter, Args&... args)
+    {
+        auto& self = static_cast<EmitAwaiter&>(waiter);
+        self.value_.emplace(args...);
+        self.handle_.resume();
+    }
+
+    template<typename ...Args>
+    inline void CancellableEmitAwaiter<Args...>::await_suspend(std::coroutine_handle<> handle)
+    {
+        handle_ = handle;
+        this->resume = &Resume;
+        this->Push(waiters_);
+        //await_ready saw no stop request, and no other thread may make one, so this doesn't resume at once.
+        stopCallback_.emplace(token_, Cancel{ this });
+    }
+
+    template<typename ...Args>
+    inline void CancellableEmitAwaiter<Args...>::Resume(internal::EmitWaiter<Args...>& waiter, Args&... args)
+    {
+        auto& self = static_cast<CancellableEmitAwaiter&>(waiter);
+        self.value_.emplace(args...);
+        self.handle_.resume();
+    }
+
+
+    template<typename >
+    class EventStream;
+
+    //the successive emits of an event as a stream a coroutine reads one by one:
+    //
+    //  EventStream<void(int)> stream(event);
+    //  while (auto value = co_await stream.Next())
+    //      Process(std::get<0>(*value));
+    //
+    //unlike awaiting the event again and again, it misses no emit that happens while the reader is busy:
+    //a handler connected for the life of the stream buffers them, at most "maxBuffered" of them,
+    //dropping the oldest ones beyond that.
+    //Close stops the stream, and a reader waiting in Next is resumed with an empty optional, which is how it's cancelled.
+    //only one coroutine may wait in Next at a time, and it's resumed inside the emit, after the handlers before the stream's.
+    template<typename... Args>
+    class EventStream<void(Args...)>
+    {
+    public:
+        using ValueType = std::tuple<std::decay_t<Args>...>;
+
+        class NextAwaiter
+        {
+        public:
+            explicit NextAwaiter(EventStream& stream) : stream_(stream) { }
+
+            bool await_ready() const noexcept { return !stream_.buffer_.empty() || stream_.closed_; }
+            void await_suspend(std::coroutine_handle<> handle) { stream_.reader_ = handle; }
+            std::optional<ValueType> await_resume();
+
+        private:
+            EventStream& stream_;
+        };
+
+        template<typename Instrumentation>
+        explicit EventStream(Event<void(Args...), Instrumentation>& event, std::size_t maxBuffered = std::numeric_limits<std::size_t>::max());
+        EventStream(const EventStream&) = delete;
+        EventStream& operator = (const EventStream&) = delete;
+        //a reader still waiting is never resumed.
+        ~EventStream() = default;
+
+        NextAwaiter Next() { return NextAwaiter(*this); }
+        void Close();
+
+        bool IsClosed() const { return closed_; }
+        std::size_t GetBufferedCount() const { return buffer_.size(); }
+        std::uint64_t GetDroppedCount() const { return dropped_; }
+
+    private:
+        void Push(Args&... args);
+
+        std::deque<ValueType> buffer_;
+        std::size_t maxBuffered_;
+        std::uint64_t dropped_ = 0;
+        bool closed_ = false;
+        std::coroutine_handle<> reader_;
+        ScopedConnection connection_;
+    };
+
+    template<typename ...Args>
+    template<typename Instrumentation>
+    inline EventStream<void(Args...)>::EventStream(Event<void(Args...), Instrumentation>& event, std::size_t maxBuffered)
+        : maxBuffered_(maxBuffered == 0 ? 1 : maxBuffered)
+    {
+        connection_ = event.AddHandler([this](Args... args) { Push(args...); });
+    }
+
+    template<typename ...Args>
+    inline void EventStream<void(Args...)>::Close()
+    {
+        if (closed_)
+            return;
+        closed_ = true;
+        connection_.Disconnect();
+        if (reader_)
+            std::exchange(reader_, nullptr).resume();
+    }
+
+    template<typename ...Args>
+    inline void EventStream<void(Args...)>::Push(Args&... args)
+    {
+        if (buffer_.size() == maxBuffered_)
+        {
+            buffer_.pop_front();
+            dropped_++;
+        }
+        buffer_.emplace_back(args...);
+        if (reader_)
+            std::exchange(reader_, nullptr).resume();
+    }
+
+    template<typename ...Args>
+    inline auto EventStream<void(Args...)>::NextAwaiter::await_resume() -> std::optional<ValueType>
+    {
+        if (stream_.buffer_.empty())
+            return std::nullopt;
+        std::optional<ValueType> value(std::move(stream_.buffer_.front()));
+        stream_.buffer_.pop_front();
+        return value;
+    }
+}
+#endif
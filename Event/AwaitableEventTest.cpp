@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "AwaitableEvent.h"
+#include "ParallelDispatch.h"
+#include "Test.h"
+
+//the waiters need coroutines, so these tests are only built as C++20.
+#ifdef CRU_EVENT_HAS_COROUTINES
+
+using namespace cru;
+
+namespace
+{
+    //a coroutine that starts at once and frees itself when it returns.
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object() { return Task(); }
+            std::suspend_never initial_suspend() { return std::suspend_never(); }
+            std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+            void return_void() { }
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    Task WaitTwice(Event<void(int, const std::string&)>& event, std::vector<std::string>& log, int id)
+    {
+        auto [value, text] = co_await event;
+        log.push_back(std::to_string(id) + ":" + std::to_string(value) + text);
+        auto next = co_await event;
+        log.push_back(std::to_string(id) + "#" + std::to_string(std::get<0>(next)));
+    }
+
+    Task WaitOrStop(Event<void(int)>& event, std::stop_token token, int& result)
+    {
+        auto value = co_await NextEmit(event, token);
+        result = value ? std::get<0>(*value) : -1;
+    }
+
+    Task ReadAll(EventStream<void(int)>& stream, std::vector<int>& values)
+    {
+        while (auto value = co_await stream.Next())
+            values.push_back(std::get<0>(*value));
+        values.push_back(-1);
+    }
+
+    //log every value received, and the length of the log before it.
+    Task WaitForEach(Event<void(int)>& event, int count, std::vector<int>& log, std::vector<int>& lengths)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            auto [value] = co_await event;
+            lengths.push_back(static_cast<int>(log.size()));
+            log.push_back(value);
+        }
+    }
+
+    template<typename EventType>
+    Task WaitOnce(EventType& event, int& resumeCount, int& value)
+    {
+        auto arguments = co_await event;
+        value = std::get<0>(arguments);
+        resumeCount++;
+    }
+}
+
+CRU_TEST(WaitersResumeAfterTheHandlers)
+{
+    Event<void(int, const std::string&)> event;
+    std::vector<std::string> log;
+    event.AddHandler([&log](int, const std::string&) { log.push_back("handler"); });
+    WaitTwice(event, log, 1);
+    WaitTwice(event, log, 2);
+    CRU_CHECK(log.empty());
+
+    //the order of the waiters is unspecified.
+    event(5, std::string("x"));
+    std::sort(log.begin() + 1, log.end());
+    CRU_CHECK((log == std::vector<std::string>{ "handler", "1:5x", "2:5x" }));
+    //a waiter waiting again inside the emit gets the next emit, not the same one.
+    event(6, std::string("y"));
+    std::sort(log.begin() + 4, log.end());
+    CRU_CHECK(log.size() == 6 && log[3] == "handler" && log[4] == "1#6" && log[5] == "2#6");
+    event(7, std::string("z"));
+    CRU_CHECK(log.size() == 7);
+}
+
+CRU_TEST(EmitBatchResumesWaitersPerRecord)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    event.AddHandler([&log](int value) { log.push_back(value); });
+    std::vector<int> lengths;
+    WaitForEach(event, 3, log, lengths);
+    const std::vector<Event<void(int)>::Record> records{ std::make_tuple(1), std::make_tuple(2), std::make_tuple(3) };
+    //each record once, all of them after the handlers got the whole batch.
+    event.EmitBatch(records);
+    CRU_CHECK((log == std::vector<int>{ 1, 2, 3, 1, 2, 3 }));
+    CRU_CHECK((lengths == std::vector<int>{ 3, 4, 5 }));
+}
+
+CRU_TEST(NextEmitStopsOnRequest)
+{
+    Event<void(int)> event;
+    std::stop_source source;
+    int result = 0;
+    WaitOrStop(event, source.get_token(), result);
+    CRU_CHECK(result == 0);
+    source.request_stop();
+    CRU_CHECK(result == -1);
+    event(3);
+    CRU_CHECK(result == -1);
+
+    std::stop_source emitted;
+    WaitOrStop(event, emitted.get_token(), result);
+    event(9);
+    CRU_CHECK(result == 9);
+    emitted.request_stop();
+    CRU_CHECK(result == 9);
+
+    std::stop_source stopped;
+    stopped.request_stop();
+    result = 0;
+    WaitOrStop(event, stopped.get_token(), result);
+    CRU_CHECK(result == -1);
+}
+
+CRU_TEST(EventStreamBuffersUntilClosed)
+{
+    Event<void(int)> event;
+    EventStream<void(int)> stream(event, 2);
+    event(1);
+    event(2);
+    event(3);
+    CRU_CHECK(stream.GetDroppedCount() == 1);
+
+    std::vector<int> values;
+    ReadAll(stream, values);
+    CRU_CHECK((values == std::vector<int>{ 2, 3 }));
+    event(4);
+    CRU_CHECK((values == std::vector<int>{ 2, 3, 4 }));
+    stream.Close();
+    CRU_CHECK((values == std::vector<int>{ 2, 3, 4, -1 }));
+    event(5);
+    CRU_CHECK(values.size() == 4);
+}
+
+CRU_TEST(ParallelInvokeResumesWaiters)
+{
+    ThreadPool pool(4);
+    Event<void(int)> event;
+    std::atomic<int> calls(0);
+    for (int i = 0; i < 64; i++)
+        event.AddHandler([&calls](int) { calls++; });
+    int resumeCount = 0;
+    int value = 0;
+    WaitOnce(event, resumeCount, value);
+    //the handlers run on the pool, and the waiter on this thread once they have all returned.
+    ParallelInvoke(pool, event, 4, 7);
+    CRU_CHECK(calls == 64 && resumeCount == 1 && value == 7);
+    ParallelInvoke(pool, event, 4, 8);
+    CRU_CHECK(resumeCount == 1);
+
+    //sequential below the chunk size, as an emit.
+    WaitOnce(event, resumeCount, value);
+    ParallelInvoke(pool, event, 64, 9);
+    CRU_CHECK(resumeCount == 2 && value == 9);
+}
+
+CRU_TEST(ParallelInvokeAsyncResumesWaiters)
+{
+    ThreadPool pool(4);
+    Event<void(int)> event;
+    std::atomic<int> calls(0);
+    for (int i = 0; i < 64; i++)
+        event.AddHandler([&calls](int) { calls++; });
+    int resumeCount = 0;
+    int value = 0;
+    WaitOnce(event, resumeCount, value);
+    //the waiter was resumed before the future became ready.
+    ParallelInvokeAsync(pool, event, 4, 7).get();
+    CRU_CHECK(calls == 64 && resumeCount == 1 && value == 7);
+    ParallelInvokeAsync(pool, event, 4, 8).get();
+    CRU_CHECK(resumeCount == 1);
+
+    //no waiter is resumed when a handler threw.
+    event.AddHandler([](int) { throw std::runtime_error("handler"); });
+    WaitOnce(event, resumeCount, value);
+    bool thrown = false;
+    try
+    {
+        ParallelInvokeAsync(pool, event, 4, 9).get();
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CRU_CHECK(thrown && resumeCount == 1);
+    event.ClearHandlers();
+    event(10);
+    CRU_CHECK(resumeCount == 2 && value == 10);
+}
+
+#endif
@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <future>
+#include <memory>
+
+#include "../AwaitableEvent.h"
+#include "Benchmark.h"
+
+//coroutines need C++20, so this benchmark is only built as C++20.
+#ifdef CRU_EVENT_HAS_COROUTINES
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int waitCount = 1000000;
+    const int repeat = 5;
+
+    //a coroutine that starts at once and frees itself when it returns.
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object() { return Task(); }
+            std::suspend_never initial_suspend() { return std::suspend_never(); }
+            std::suspend_never final_suspend() noexcept { return std::suspend_never(); }
+            void return_void() { }
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    //wait for "count" emits in a row, each one a co_await of the event.
+    Task WaitForEach(Event<void(int)>& event, int count, long& sum)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            auto [value] = co_await event;
+            sum += value;
+        }
+    }
+
+    //what co_await replaces: a handler that completes a promise once, and disconnects itself so emits don't pile up.
+    std::future<int> WaitWithFuture(Event<void(int)>& event)
+    {
+        auto promise = std::make_shared<std::promise<int>>();
+        auto future = promise->get_future();
+        auto connection = std::make_shared<Connection>();
+        *connection = event.AddHandler([promise, connection](int value) {
+            promise->set_value(value);
+            connection->Disconnect();
+        });
+        return future;
+    }
+}
+
+//a wait for the next emit and its resumption, with co_await and with a one-shot handler completing a promise and its future.
+//the awaiter lives in the coroutine frame, so co_await must not allocate, and it must be far cheaper than a future.
+CRU_BENCHMARK(AwaitableEventAgainstFuture)
+{
+    Event<void(int)> event;
+    long awaitedSum = 0;
+    //one coroutine for every wait of every run, created before the allocations are counted.
+    WaitForEach(event, waitCount * repeat, awaitedSum);
+    long allocationsBefore = GetAllocationCount();
+    const double awaitSeconds = MeasureBest([&event]() {
+        for (int i = 0; i < waitCount; i++)
+            event(i);
+    }, repeat);
+    const double awaitAllocations = static_cast<double>(GetAllocationCount() - allocationsBefore) / (repeat * waitCount);
+
+    long futureSum = 0;
+    allocationsBefore = GetAllocationCount();
+    const double futureSeconds = MeasureBest([&event, &futureSum]() {
+        for (int i = 0; i < waitCount; i++)
+        {
+            auto future = WaitWithFuture(event);
+            event(i);
+            futureSum += future.get();
+        }
+    }, repeat);
+    const double futureAllocations = static_cast<double>(GetAllocationCount() - allocationsBefore) / (repeat * waitCount);
+    Consume(awaitedSum + futureSum);
+
+    std::printf("  co_await %.1f ns and %.2f allocations, future %.1f ns and %.2f allocations per wait\n",
+        awaitSeconds * 1e9 / waitCount, awaitAllocations, futureSeconds * 1e9 / waitCount, futureAllocations);
+    CheckAtMost("co_await allocations per wait", awaitAllocations, 0);
+    CheckAtMost("difference of the sums", static_cast<double>(awaitedSum > futureSum ? awaitedSum - futureSum : futureSum - awaitedSum), 0);
+    CheckAtMost("co_await / future", awaitSeconds / futureSeconds, 0.5);
+}
+
+#endif
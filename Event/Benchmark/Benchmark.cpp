@@ -0,0 +1,50 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "Benchmark.h"
+
+using namespace cru::benchmark;
+
+namespace
+{
+    std::atomic<long> allocationCount{ 0 };
+}
+
+//count the allocations of the whole benchmark program.
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* result = std::malloc(size == 0 ? 1 : size))
+        return result;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+long cru::benchmark::GetAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+//run the benchmarks whose names contain one of the arguments, or all of them without arguments.
+//exit with a failure if any check of a regression failed.
+int main(int argc, char** argv)
+{
+    for (auto& benchmarkCase : GetBenchmarkCases())
+    {
+        bool selected = argc <= 1;
+        for (int i = 1; i < argc; i++)
+            if (std::strstr(benchmarkCase.name, argv[i]))
+                selected = true;
+        if (!selected)
+            continue;
+        std::printf("%s\n", benchmarkCase.name);
+        benchmarkCase.function();
+    }
+    std::printf("%zu failed checks\n", GetFailureCount());
+    return GetFailureCount() == 0 ? 0 : 1;
+}
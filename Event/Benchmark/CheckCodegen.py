@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""Check that abstractions compile to the code written by hand.
+
+Compile each source to assembly and compare every extern "C" function "Name"
+with its counterpart "NameExpected": the instructions must be the same and
+"Name" must not call anything.
+
+    CheckCodegen.py [source...]        (default: StaticEventCodegen.cpp)
+
+The compiler is $CXX, or g++, with the flags in $CXXFLAGS added.
+It understands the assembly of gcc and clang on x86-64 and AArch64.
+"""
+
+import os
+import re
+import shlex
+import subprocess
+import sys
+
+DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_SOURCES = ["StaticEventCodegen.cpp"]
+
+
+def compile_to_assembly(source):
+    command = [os.environ.get("CXX", "g++"), "-std=c++14", "-O2", "-DNDEBUG", "-S", "-o", "-",
+               "-fno-asynchronous-unwind-tables", "-fno-stack-protector"]
+    command += shlex.split(os.environ.get("CXXFLAGS", ""))
+    command.append(source)
+    return subprocess.run(command, check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+
+
+def split_functions(assembly):
+    """Return the instructions of every function, by name."""
+    functions = {}
+    current = None
+    for line in assembly.splitlines():
+        line = line.split("#")[0].split("//")[0].rstrip()
+        label = re.match(r"^_?([A-Za-z_][A-Za-z0-9_]*):$", line)
+        if label:
+            current = functions.setdefault(label.group(1), [])
+            continue
+        stripped = line.strip()
+        if current is None or not stripped:
+            continue
+        if stripped.startswith(".size") or stripped.startswith(".cfi_endproc"):
+            current = None
+        elif re.match(r"^\.?L[A-Za-z0-9_]*:$", stripped):
+            current.append("label:")
+        elif not stripped.startswith("."):
+            #local labels are numbered differently in each function.
+            current.append(re.sub(r"\.?L[A-Za-z]*[0-9]+", "label", " ".join(stripped.split())))
+    return functions
+
+
+def calls_something(instructions):
+    return any(re.match(r"^(call|bl|jmp|b)\s+(?!label)", i) for i in instructions)
+
+
+def check(source):
+    functions = split_functions(compile_to_assembly(source))
+    names = sorted(name for name in functions if name + "Expected" in functions)
+    if not names:
+        print("%s: no function to check" % source)
+        return 1
+    failureCount = 0
+    for name in names:
+        actual = functions[name]
+        expected = functions[name + "Expected"]
+        if calls_something(actual) and not calls_something(expected):
+            print("failed %s: calls something" % name)
+        elif actual != expected:
+            print("failed %s: differs from %sExpected" % (name, name))
+        else:
+            print("passed %s (%d instructions)" % (name, len(actual)))
+            continue
+        failureCount += 1
+        print("  actual:   " + "; ".join(actual))
+        print("  expected: " + "; ".join(expected))
+    return failureCount
+
+
+def main(arguments):
+    sources = arguments or [os.path.join(DIRECTORY, i) for i in DEFAULT_SOURCES]
+    failureCount = sum(check(i) for i in sources)
+    print("%d failed checks" % failureCount)
+    return 0 if failureCount == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
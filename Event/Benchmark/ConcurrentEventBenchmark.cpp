@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../ConcurrentEvent.h"
+#include "../Event.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int handlerCount = 8;
+    const int emitCount = 1000000;
+
+    //emit from "threadCount" threads at once and return the emits per second of all of them.
+    template<typename Emit>
+    double MeasureEmitRate(int threadCount, Emit emit)
+    {
+        const double seconds = MeasureBest([threadCount, &emit]() {
+            std::vector<std::thread> threads;
+            for (int i = 0; i < threadCount; i++)
+                threads.emplace_back([&emit]() {
+                    for (int j = 0; j < emitCount; j++)
+                        emit(j);
+                });
+            for (auto& i : threads)
+                i.join();
+        }, 3);
+        return threadCount * static_cast<double>(emitCount) / seconds;
+    }
+}
+
+//emit throughput as threads are added, against an Event guarded by a mutex, which is what ConcurrentEvent replaces.
+//ConcurrentEvent should scale with the cores, the mutex shouldn't.
+CRU_BENCHMARK(ConcurrentEventEmitScaling)
+{
+    std::atomic<long> hits{ 0 };
+    ConcurrentEvent<void(int)> concurrentEvent;
+    Event<void(int)> lockedEvent;
+    std::mutex mutex;
+    for (int i = 0; i < handlerCount; i++)
+    {
+        //handlers that read their argument but touch nothing shared, so only the dispatch is measured.
+        concurrentEvent.AddHandler([&hits](int value) { if (value < 0) hits++; });
+        lockedEvent.AddHandler([&hits](int value) { if (value < 0) hits++; });
+    }
+
+    const int maxThreadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    double concurrentBase = 0;
+    for (int threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreadCount))
+    {
+        const double concurrentRate = MeasureEmitRate(threadCount, [&concurrentEvent](int value) { concurrentEvent(value); });
+        const double lockedRate = MeasureEmitRate(threadCount, [&lockedEvent, &mutex](int value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            lockedEvent(value);
+        });
+        if (threadCount == 1)
+            concurrentBase = concurrentRate;
+        std::printf("  %2d threads: ConcurrentEvent %7.1f M emits/s (x%.2f), Event with mutex %7.1f M emits/s\n",
+            threadCount, concurrentRate / 1e6, concurrentRate / concurrentBase, lockedRate / 1e6);
+        if (threadCount == maxThreadCount)
+            break;
+    }
+    Consume(hits.load());
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <vector>
+
+#include "../Event.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    typedef Event<void(int, double)> ReplayEvent;
+
+    const std::size_t recordCount = 1 << 20;
+
+    //handlers that each keep a sum of their own, as the subscribers of a replay would.
+    void AddHandlers(ReplayEvent& event, std::vector<double>& sums)
+    {
+        for (std::size_t i = 0; i < sums.size(); i++)
+        {
+            double* sum = &sums[i];
+            const double weight = 1.0 + static_cast<double>(i);
+            event.AddHandler([sum, weight](int id, double value) { *sum += value * weight + id; });
+        }
+    }
+
+    std::vector<ReplayEvent::Record> MakeRecords(std::size_t batchSize)
+    {
+        std::vector<ReplayEvent::Record> records;
+        records.reserve(batchSize);
+        for (std::size_t i = 0; i < batchSize; i++)
+            records.emplace_back(static_cast<int>(i % 97), static_cast<double>(i) * 0.5);
+        return records;
+    }
+}
+
+//replay the same records with EmitBatch and with one emit per record, over a few handlers and batch sizes,
+//the batches repeated to make up the same number of records each time.
+//every handler runs over the whole batch at once, so a batch must not be slower than the emits it replaces.
+CRU_BENCHMARK(EmitBatchAgainstPerRecordEmit)
+{
+    double batchTotal = 0;
+    double perRecordTotal = 0;
+    for (std::size_t handlerCount : { 2, 4, 16 })
+    {
+        for (std::size_t batchSize : { 16, 256, 4096 })
+        {
+            ReplayEvent event;
+            std::vector<double> sums(handlerCount);
+            AddHandlers(event, sums);
+            const auto records = MakeRecords(batchSize);
+            const std::size_t batchCount = recordCount / batchSize;
+
+            const double perRecordSeconds = MeasureBest([&]() {
+                for (std::size_t i = 0; i < batchCount; i++)
+                    for (auto& record : records)
+                        event(std::get<0>(record), std::get<1>(record));
+            });
+            const double batchSeconds = MeasureBest([&]() {
+                for (std::size_t i = 0; i < batchCount; i++)
+                    event.EmitBatch(records);
+            });
+            double sum = 0;
+            for (double i : sums)
+                sum += i;
+            Consume(sum);
+
+            std::printf("  %2zu handlers, batches of %4zu: per record %.2f ns, batch %.2f ns per record (x%.2f)\n", handlerCount, batchSize,
+                perRecordSeconds * 1e9 / recordCount, batchSeconds * 1e9 / recordCount, perRecordSeconds / batchSeconds);
+            batchTotal += batchSeconds;
+            perRecordTotal += perRecordSeconds;
+            //a single small batch may win nothing, but it must not lose more than the noise.
+            CheckAtMost("batch / per record emit", batchSeconds / perRecordSeconds, 1.15);
+        }
+    }
+    CheckAtMost("batch / per record emit, over every case", batchTotal / perRecordTotal, 1.0);
+}
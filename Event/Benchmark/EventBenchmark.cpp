@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <functional>
+#include <list>
+
+#include "../Event.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int handlerCount = 8;
+    const int emitCount = 5000000;
+}
+
+//emit an event whose handlers emit it again, against copying the handler list before every emit,
+//which is how it was made reentrancy safe before Event deferred the changes itself.
+//the emit of Event must not allocate.
+CRU_BENCHMARK(EventReentrantEmit)
+{
+    long total = 0;
+    Event<void(int)> event;
+    std::list<std::function<void(int)>> handlers;
+    for (int i = 0; i < handlerCount; i++)
+    {
+        event.AddHandler([&total, &event](int depth) {
+            total += depth;
+            if (depth == 0)
+                event(1);
+        });
+        handlers.push_back([&total, &handlers](int depth) {
+            total += depth;
+            if (depth == 0)
+                for (auto& i : std::list<std::function<void(int)>>(handlers))
+                    i(1);
+        });
+    }
+
+    const long allocationsBefore = GetAllocationCount();
+    const double eventSeconds = MeasureBest([&event]() {
+        for (int i = 0; i < emitCount; i++)
+            event(0);
+    });
+    const double allocationsPerEmit = static_cast<double>(GetAllocationCount() - allocationsBefore) / (5.0 * emitCount);
+    const double copySeconds = MeasureBest([&handlers]() {
+        for (int i = 0; i < emitCount / 10; i++)
+            for (auto& j : std::list<std::function<void(int)>>(handlers))
+                j(0);
+    });
+    std::printf("  Event %.1f ns, copied list %.1f ns per emit and its %d nested emits, Event allocates %.3f times per emit\n",
+        eventSeconds * 1e9 / emitCount, copySeconds * 1e9 / (emitCount / 10), handlerCount, allocationsPerEmit);
+    Consume(total);
+
+    CheckAtMost("allocations per emit", allocationsPerEmit, 0);
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include "../EventBus.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int roundCount = 2000000;
+
+    template<int Id>
+    struct Payload
+    {
+        int value;
+    };
+
+    //the bus EventBus replaces: events looked up by the std::type_index of the payload in a hash map.
+    class HashMapBus
+    {
+    public:
+        template<typename Payload, typename Handler>
+        Connection Subscribe(Handler&& handler)
+        {
+            auto& holder = events_[std::type_index(typeid(Payload))];
+            if (!holder)
+                holder.reset(new EventHolder<Payload>());
+            return GetEvent<Payload>()->AddHandler(std::forward<Handler>(handler));
+        }
+
+        template<typename Payload>
+        void Publish(const Payload& payload) const
+        {
+            if (auto event = GetEvent<Payload>())
+                (*event)(payload);
+        }
+
+    private:
+        struct EventHolderBase
+        {
+            virtual ~EventHolderBase() = default;
+        };
+
+        template<typename Payload>
+        struct EventHolder : EventHolderBase
+        {
+            Event<void(const Payload&)> event;
+        };
+
+        template<typename Payload>
+        Event<void(const Payload&)>* GetEvent() const
+        {
+            const auto iterator = events_.find(std::type_index(typeid(Payload)));
+            if (iterator == events_.end())
+                return nullptr;
+            return &static_cast<EventHolder<Payload>*>(iterator->second.get())->event;
+        }
+
+        std::unordered_map<std::type_index, std::unique_ptr<EventHolderBase>> events_;
+    };
+
+    template<typename Bus, int... Ids>
+    void SubscribeAll(Bus& bus, long& total, std::integer_sequence<int, Ids...>)
+    {
+        using Expand = int[];
+        (void)Expand{ 0, (bus.template Subscribe<Payload<Ids>>([&total](const Payload<Ids>& payload) { total += payload.value; }), 0)... };
+    }
+
+    template<typename Bus, int... Ids>
+    void PublishAll(const Bus& bus, int value, std::integer_sequence<int, Ids...>)
+    {
+        using Expand = int[];
+        (void)Expand{ 0, (bus.Publish(Payload<Ids>{ value + Ids }), 0)... };
+    }
+
+    template<typename Bus, typename Ids>
+    double MeasureNanosecondsPerPublish(const Bus& bus, Ids ids)
+    {
+        const double seconds = MeasureBest([&bus, ids]() {
+            for (int i = 0; i < roundCount; i++)
+                PublishAll(bus, i, ids);
+        });
+        return seconds * 1e9 / (static_cast<double>(roundCount) * ids.size());
+    }
+
+    using PayloadIds = std::make_integer_sequence<int, 16>;
+
+    template<typename >
+    struct EventBusOf;
+
+    template<int... Ids>
+    struct EventBusOf<std::integer_sequence<int, Ids...>>
+    {
+        using Type = EventBus<Payload<Ids>...>;
+    };
+}
+
+//publish to 16 payload types with one subscriber each, on EventBus and on a bus looking the events up in a hash map.
+//EventBus should spend only the emit of the event.
+CRU_BENCHMARK(EventBusPublish)
+{
+    const PayloadIds ids;
+    long total = 0;
+    EventBusOf<PayloadIds>::Type eventBus;
+    HashMapBus hashMapBus;
+    SubscribeAll(eventBus, total, ids);
+    SubscribeAll(hashMapBus, total, ids);
+
+    const double eventBusCost = MeasureNanosecondsPerPublish(eventBus, ids);
+    const double hashMapCost = MeasureNanosecondsPerPublish(hashMapBus, ids);
+    std::printf("  EventBus %.2f ns, hash map bus %.2f ns per publish\n", eventBusCost, hashMapCost);
+    Consume(total);
+
+    CheckAtMost("EventBus / hash map bus", eventBusCost / hashMapCost, 1.0);
+}
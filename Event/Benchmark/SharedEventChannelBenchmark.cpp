@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../SharedEventChannel.h"
+#include "Benchmark.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int roundTripCount = 20000;
+    const std::size_t channelCapacity = 1024;
+
+    struct Tick
+    {
+        std::int64_t sentNanoseconds;
+        int id;
+    };
+
+    std::int64_t NowNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //the names of the two channels, made unique by the id of the process that measures.
+    struct ChannelNames
+    {
+        char ping[64];
+        char pong[64];
+
+        explicit ChannelNames(unsigned long id)
+        {
+#ifdef _WIN32
+            std::snprintf(ping, sizeof(ping), "Local\\cru_benchmark_%lu_ping", id);
+            std::snprintf(pong, sizeof(pong), "Local\\cru_benchmark_%lu_pong", id);
+#else
+            std::snprintf(ping, sizeof(ping), "/cru_benchmark_%lu_ping", id);
+            std::snprintf(pong, sizeof(pong), "/cru_benchmark_%lu_pong", id);
+#endif
+        }
+    };
+
+    //the other process: send every ping back as a pong, until the ping channel is closed.
+    void RunEcho(const ChannelNames& names)
+    {
+        SharedEventPublisher<void(Tick)> pong;
+        if (pong.Create(names.pong, channelCapacity) != SharedEventChannelError::None)
+            return;
+        Event<void(Tick)> pings;
+        pings += [&pong](Tick tick) { pong.Publish(tick); };
+        SharedEventSubscriber<void(Tick)> subscriber(pings);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (subscriber.Open(names.ping) != SharedEventChannelError::None)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        while (!subscriber.IsClosed())
+            if (subscriber.Wait(std::chrono::milliseconds(100)))
+                subscriber.Dispatch();
+    }
+
+#ifdef _WIN32
+    const char echoVariable[] = "CRU_BENCHMARK_ECHO";
+
+    //the benchmark starts its own executable again as the echo process, which does nothing else.
+    const bool isEchoProcess = []() {
+        char id[32];
+        if (::GetEnvironmentVariableA(echoVariable, id, sizeof(id)) == 0)
+            return false;
+        RunEcho(ChannelNames(std::strtoul(id, nullptr, 10)));
+        std::exit(0);
+    }();
+
+    class EchoProcess
+    {
+    public:
+        bool Start(unsigned long id)
+        {
+            char path[MAX_PATH];
+            char value[32];
+            std::snprintf(value, sizeof(value), "%lu", id);
+            STARTUPINFOA startup = {};
+            startup.cb = sizeof(startup);
+            ::SetEnvironmentVariableA(echoVariable, value);
+            const bool started = ::GetModuleFileNameA(nullptr, path, MAX_PATH) != 0
+                && ::CreateProcessA(path, nullptr, nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startup, &process_);
+            ::SetEnvironmentVariableA(echoVariable, nullptr);
+            return started;
+        }
+
+        void Join()
+        {
+            ::WaitForSingleObject(process_.hProcess, INFINITE);
+            ::CloseHandle(process_.hThread);
+            ::CloseHandle(process_.hProcess);
+        }
+
+    private:
+        PROCESS_INFORMATION process_ = {};
+    };
+
+    unsigned long CurrentProcessId() { return ::GetCurrentProcessId(); }
+#else
+    class EchoProcess
+    {
+    public:
+        bool Start(unsigned long id)
+        {
+            pid_ = ::fork();
+            if (pid_ == 0)
+            {
+                RunEcho(ChannelNames(id));
+                ::_exit(0);
+            }
+            return pid_ > 0;
+        }
+
+        void Join()
+        {
+            int status;
+            ::waitpid(pid_, &status, 0);
+        }
+
+    private:
+        pid_t pid_ = -1;
+    };
+
+    unsigned long CurrentProcessId() { return static_cast<unsigned long>(::getpid()); }
+#endif
+
+    double Microseconds(std::int64_t nanoseconds)
+    {
+        return nanoseconds / 1000.0;
+    }
+}
+
+//round trips of a message through two channels, to another process and back, one at a time.
+//that process subscribes to the first channel and publishes what it receives into the second one,
+//so each round trip is two publications and two wake-ups across processes.
+//the median must stay within the time of a few context switches.
+CRU_BENCHMARK(SharedEventChannelRoundTrip)
+{
+    const auto id = CurrentProcessId();
+    const ChannelNames names(id);
+    SharedEventPublisher<void(Tick)> ping;
+    if (ping.Create(names.ping, channelCapacity) != SharedEventChannelError::None)
+    {
+        CheckAtMost("channel creation failures", 1, 0);
+        return;
+    }
+    EchoProcess echo;
+    if (!echo.Start(id))
+    {
+        CheckAtMost("echo process start failures", 1, 0);
+        return;
+    }
+
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(roundTripCount);
+    bool received = false;
+    Event<void(Tick)> pongs;
+    pongs += [&](Tick tick) {
+        received = true;
+        if (tick.id >= 0)
+            latencies.push_back(NowNanoseconds() - tick.sentNanoseconds);
+    };
+    SharedEventSubscriber<void(Tick)> subscriber(pongs);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (subscriber.Open(names.pong) != SharedEventChannelError::None && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    //pings are lost until the echo process has opened the channel, so the first pong tells it has.
+    while (!received && subscriber.IsOpen() && std::chrono::steady_clock::now() < deadline)
+    {
+        ping.Publish(Tick{ 0, -1 });
+        if (subscriber.Wait(std::chrono::milliseconds(10)))
+            subscriber.Dispatch();
+    }
+    subscriber.Dispatch();
+
+    for (int i = 0; received && i < roundTripCount; i++)
+    {
+        ping.Publish(Tick{ NowNanoseconds(), i });
+        while (latencies.size() <= static_cast<std::size_t>(i) && subscriber.Wait(std::chrono::seconds(2)))
+            subscriber.Dispatch();
+        if (latencies.size() <= static_cast<std::size_t>(i))
+            break;
+    }
+    ping.Close();
+    echo.Join();
+
+    if (latencies.size() != roundTripCount)
+    {
+        std::printf("  %zu of %d round trips\n", latencies.size(), roundTripCount);
+        CheckAtMost("round trips lost", static_cast<double>(roundTripCount - latencies.size()), 0);
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto median = latencies[latencies.size() / 2];
+    std::printf("  %d round trips: median %.2f us, p99 %.2f us, p99.9 %.2f us, max %.2f us\n", roundTripCount,
+        Microseconds(median), Microseconds(latencies[latencies.size() * 99 / 100]),
+        Microseconds(latencies[latencies.size() * 999 / 1000]), Microseconds(latencies.back()));
+    CheckAtMost("median round trip in us", Microseconds(median), 100);
+}
@@ -0,0 +1,79 @@
+#include <cstdio>
+#include <vector>
+
+#include "../Event.h"
+#include "../StaticEvent.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int emitCount = 50000000;
+
+    int sum;
+    int maximum;
+    int count;
+
+    void UpdateMaximum(int value)
+    {
+        if (maximum < value)
+            maximum = value;
+    }
+
+    struct AddToSum
+    {
+        void operator()(int value) const { sum += value; }
+    };
+
+    struct CountCalls
+    {
+        void operator()(int) const { ++count; }
+    };
+
+    //arguments read from memory so the loop can't be folded into a formula.
+    std::vector<int> MakeValues()
+    {
+        std::vector<int> values(1024);
+        for (std::size_t i = 0; i < values.size(); i++)
+            values[i] = static_cast<int>(i * 7919 % 1000);
+        return values;
+    }
+
+    template<typename Emit>
+    double MeasureNanosecondsPerEmit(const std::vector<int>& values, Emit emit)
+    {
+        const double seconds = MeasureBest([&values, &emit]() {
+            for (int i = 0; i < emitCount; i++)
+                emit(values[i & 1023]);
+        });
+        return seconds * 1e9 / emitCount;
+    }
+}
+
+//emit with three handlers fixed at compile time, against calling them by hand and against an Event holding them.
+//StaticEvent should cost what the calls by hand cost.
+CRU_BENCHMARK(StaticEventEmit)
+{
+    const auto values = MakeValues();
+    StaticEvent<void(int), AddToSum, StaticFunctionHandler(UpdateMaximum), CountCalls> staticEvent;
+    Event<void(int)> event;
+    event.AddHandler(AddToSum());
+    event.AddHandler(&UpdateMaximum);
+    event.AddHandler(CountCalls());
+
+    const double direct = MeasureNanosecondsPerEmit(values, [](int value) {
+        sum += value;
+        UpdateMaximum(value);
+        ++count;
+    });
+    const double staticCost = MeasureNanosecondsPerEmit(values, [&staticEvent](int value) { staticEvent(value); });
+    const double eventCost = MeasureNanosecondsPerEmit(values, [&event](int value) { event(value); });
+    std::printf("  by hand %.2f ns, StaticEvent %.2f ns, Event %.2f ns per emit\n", direct, staticCost, eventCost);
+    Consume(sum + maximum + count);
+
+    //a generous margin as both take about a nanosecond, so noise shows.
+    //CheckCodegen.py is the exact check that they are the same code.
+    CheckAtMost("StaticEvent / by hand", staticCost / direct, 2.0);
+}
@@ -0,0 +1,69 @@
+//functions whose assembly CheckCodegen.py inspects, it is not run.
+//every function "Name" is compared to "NameExpected", the same work written by hand:
+//both must compile to the same instructions, so emitting a StaticEvent is only the inlined handler bodies.
+
+#include "../Combiner.h"
+#include "../StaticEvent.h"
+
+namespace
+{
+    int sum;
+    int maximum;
+    int count;
+
+    void UpdateMaximum(int value)
+    {
+        if (maximum < value)
+            maximum = value;
+    }
+
+    struct AddToSum
+    {
+        void operator()(int value) const { sum += value; }
+    };
+
+    struct CountCalls
+    {
+        void operator()(int) const { ++count; }
+    };
+
+    struct Twice
+    {
+        int operator()(int value) const { return value * 2; }
+    };
+
+    struct Next
+    {
+        int operator()(int value) const { return value + 1; }
+    };
+}
+
+extern "C" void StaticEventEmit(int value)
+{
+    cru::StaticEvent<void(int), AddToSum, StaticFunctionHandler(UpdateMaximum), CountCalls> event;
+    event(value);
+}
+
+extern "C" void StaticEventEmitExpected(int value)
+{
+    sum += value;
+    UpdateMaximum(value);
+    ++count;
+}
+
+extern "C" int StaticEventInvoke(int value)
+{
+    cru::StaticEvent<int(int), Twice, Next> event;
+    return event.Invoke(cru::Sum<int>(), value);
+}
+
+extern "C" int StaticEventInvokeExpected(int value)
+{
+    return value * 2 + (value + 1);
+}
+
+//keep the globals observable so the stores are not optimized away.
+extern "C" int StaticEventCodegenResult()
+{
+    return sum + maximum + count;
+}
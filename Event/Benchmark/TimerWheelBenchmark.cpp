@@ -0,0 +1,130 @@
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "../TimerWheel.h"
+#include "Benchmark.h"
+
+using namespace cru;
+using namespace cru::benchmark;
+
+namespace
+{
+    const int timerCount = 1000000;
+    const std::uint64_t maxDelay = 600000;
+
+    //the scheduler TimerWheel replaces: a heap of expiry times in seconds, cancelled by flagging.
+    class HeapScheduler
+    {
+    public:
+        std::size_t Schedule(Event<void()>& event, double delay)
+        {
+            const auto id = events_.size();
+            events_.push_back(&event);
+            heap_.push(Timer{ now_ + delay, id });
+            return id;
+        }
+
+        void Cancel(std::size_t id) { events_[id] = nullptr; }
+
+        void Advance(double elapsed)
+        {
+            now_ += elapsed;
+            while (!heap_.empty() && heap_.top().expiry <= now_)
+            {
+                const auto id = heap_.top().id;
+                heap_.pop();
+                if (events_[id])
+                    (*events_[id])();
+            }
+        }
+
+    private:
+        struct Timer
+        {
+            double expiry;
+            std::size_t id;
+
+            bool operator > (const Timer& other) const { return expiry > other.expiry; }
+        };
+
+        double now_ = 0;
+        std::vector<Event<void()>*> events_;
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> heap_;
+    };
+
+    struct Costs
+    {
+        double schedule;
+        double cancel;
+        double advance;
+
+        double GetTotal() const { return schedule + cancel + advance; }
+    };
+
+    //schedule "timerCount" timers within ten minutes, cancel half of them, then let all the others fire.
+    template<typename Scheduler, typename Handle, typename Delay>
+    Costs Measure(const std::vector<std::uint64_t>& delays, Delay toDelay, std::function<void(Scheduler&, double)> advance)
+    {
+        Costs best{};
+        for (int repeat = 0; repeat < 3; repeat++)
+        {
+            std::unique_ptr<Scheduler> scheduler(new Scheduler());
+            Event<void()> event;
+            long firedCount = 0;
+            event += [&firedCount]() { firedCount++; };
+            std::vector<Handle> handles(timerCount);
+
+            Costs costs;
+            costs.schedule = MeasureBest([&]() {
+                for (int i = 0; i < timerCount; i++)
+                    handles[i] = scheduler->Schedule(event, toDelay(delays[i]));
+            }, 1);
+            costs.cancel = MeasureBest([&]() {
+                for (int i = 0; i < timerCount; i += 2)
+                    scheduler->Cancel(handles[i]);
+            }, 1);
+            costs.advance = MeasureBest([&]() { advance(*scheduler, maxDelay / 1000.0); }, 1);
+            Consume(firedCount);
+            if (repeat == 0 || costs.GetTotal() < best.GetTotal())
+                best = costs;
+        }
+        return best;
+    }
+
+    struct MillisecondWheel : TimerWheel
+    {
+        MillisecondWheel() : TimerWheel(unit::ms(1)) { }
+    };
+}
+
+//one million pending timers on TimerWheel and on a heap of expiry times.
+//scheduling and cancelling on the wheel are O(1) and must keep it ahead of the heap.
+CRU_BENCHMARK(TimerWheelMillionTimers)
+{
+    std::mt19937_64 random(1);
+    std::vector<std::uint64_t> delays(timerCount);
+    for (auto& i : delays)
+        i = 1 + random() % maxDelay;
+
+    const auto wheel = Measure<MillisecondWheel, TimerHandle>(delays,
+        [](std::uint64_t delay) { return unit::ms(static_cast<double>(delay)); },
+        [](MillisecondWheel& scheduler, double seconds) { scheduler.Advance(unit::s(seconds)); });
+    //the heap moves one millisecond at a time too, like a loop driving a scheduler would.
+    const auto heap = Measure<HeapScheduler, std::size_t>(delays,
+        [](std::uint64_t delay) { return delay / 1000.0; },
+        [](HeapScheduler& scheduler, double seconds) {
+            for (std::uint64_t i = 0; i < static_cast<std::uint64_t>(seconds * 1000); i++)
+                scheduler.Advance(0.001);
+        });
+
+    std::printf("  ns per timer     schedule  cancel  fire\n");
+    std::printf("  TimerWheel       %8.1f %7.1f %5.1f\n", wheel.schedule * 1e9 / timerCount, wheel.cancel * 2e9 / timerCount, wheel.advance * 2e9 / timerCount);
+    std::printf("  heap             %8.1f %7.1f %5.1f\n", heap.schedule * 1e9 / timerCount, heap.cancel * 2e9 / timerCount, heap.advance * 2e9 / timerCount);
+
+    CheckAtMost("TimerWheel / heap", wheel.GetTotal() / heap.GetTotal(), 1.0);
+}
@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+
+namespace cru
+{
+    struct CoalescingEventStatistics
+    {
+        std::uint64_t emitted;    //calls of operator().
+        std::uint64_t dispatched; //times the handlers were invoked.
+    };
+
+    template<typename >
+    class CoalescingEvent;
+
+    //an event that collapses a burst of emits into one invocation of its handlers.
+    //operator() only records the arguments, and the handlers run when the event is flushed,
+    //either by calling Flush/FlushIfDue or by a timer started with StartTimer.
+    //
+    //by default the last arguments win. with a reducer the incoming arguments are folded into the pending ones:
+    //  CoalescingEvent<void(double)> event([](std::tuple<double>& sum, std::tuple<double>&& value) { std::get<0>(sum) += std::get<0>(value); });
+    //with a minimum interval, FlushIfDue doesn't invoke the handlers more often than that.
+    //
+    //operator() can be called from any thread and never runs a handler, so producers don't wait for handlers.
+    //flushes are serialized, so the handlers never run concurrently.
+    //a handler may emit the event again, which waits for the next flush.
+    //a flush from a handler does nothing and returns false, rather than waiting for the flush running it,
+    //and StopTimer from a handler run by the timer only asks it to stop after that flush.
+    template<typename... Args>
+    class CoalescingEvent<void(Args...)>
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using ValueType = std::tuple<typename std::decay<Args>::type...>;
+        using Reducer = InlineFunction<void(ValueType& pending, ValueType&& incoming)>;
+
+        CoalescingEvent() = default;
+        explicit CoalescingEvent(Reducer reducer) : reducer_(std::move(reducer)) { }
+        CoalescingEvent(const CoalescingEvent&) = delete;
+        CoalescingEvent(CoalescingEvent&&) = delete;
+        CoalescingEvent& operator = (const CoalescingEvent&) = delete;
+        CoalescingEvent& operator = (CoalescingEvent&&) = delete;
+        ~CoalescingEvent();
+
+        //the handlers live in an ordinary Event; change them only when no flush is running.
+        template<typename Handler>
+        Connection AddHandler(Handler&& handler) { return event_.AddHandler(std::forward<Handler>(handler)); }
+        template<typename Handler>
+        Connection operator+=(Handler&& handler) { return event_.AddHandler(std::forward<Handler>(handler)); }
+        void ClearHandlers() { event_.ClearHandlers(); }
+
+        void SetMinInterval(Clock::duration interval);
+
+        template<typename... T>
+        void operator()(T&&... args);
+
+        //invoke the handlers with the pending arguments if there are any.
+        //return whether the handlers were invoked, which they aren't from inside one of them.
+        bool Flush();
+        //like Flush, but do nothing if the last dispatch is more recent than the minimum interval.
+        bool FlushIfDue(Clock::time_point now = Clock::now());
+
+        //call FlushIfDue every "period" on a background thread until StopTimer or destruction.
+        //StartTimer must not be called from a handler run by the timer, as it stops the timer first.
+        void StartTimer(Clock::duration period);
+        //wait for the timer to stop, unless called from the timer itself.
+        void StopTimer();
+
+        CoalescingEventStatistics GetStatistics() const;
+
+    private:
+        bool Dispatch(bool checkInterval, Clock::time_point now);
+
+        ValueType* GetPending() { return reinterpret_cast<ValueType*>(&pending_); }
+
+        template<std::size_t... Indexes>
+        void Emit(ValueType& value, std::index_sequence<Indexes...>) { event_(std::get<Indexes>(value)...); }
+
+        Event<void(Args...)> event_;
+        Reducer reducer_;
+
+        mutable std::mutex mutex_;
+        typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type pending_;
+        bool hasPending_ = false;
+        std::uint64_t emitted_ = 0;
+        std::uint64_t dispatched_ = 0;
+        Clock::duration minInterval_ = Clock::duration::zero();
+        Clock::time_point lastDispatch_;
+
+        //serializes the invocation of the handlers.
+        std::mutex dispatchMutex_;
+        //the thread holding dispatchMutex_, which would deadlock locking it again.
+        std::atomic<std::thread::id> dispatchThread_{ std::thread::id() };
+
+        std::mutex timerMutex_;
+        std::condition_variable timerCondition_;
+        std::thread timer_;
+        bool stopTimer_ = false;
+    };
+
+    template<typename ...Args>
+    inline CoalescingEvent<void(Args...)>::~CoalescingEvent()
+    {
+        StopTimer();
+        if (hasPending_)
+            GetPending()->~ValueType();
+    }
+
+    template<typename ...Args>
+    inline void CoalescingEvent<void(Args...)>::SetMinInterval(Clock::duration interval)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        minInterval_ = interval;
+    }
+
+    template<typename ...Args>
+    template<typename ...T>
+    inline void CoalescingEvent<void(Args...)>::operator()(T&&... args)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        emitted_++;
+        if (!hasPending_)
+        {
+            ::new (static_cast<void*>(&pending_)) ValueType(std::forward<T>(args)...);
+            hasPending_ = true;
+        }
+        else if (reducer_)
+            reducer_(*GetPending(), ValueType(std::forward<T>(args)...));
+        else
+            *GetPending() = ValueType(std::forward<T>(args)...);
+    }
+
+    template<typename ...Args>
+    inline bool CoalescingEvent<void(Args...)>::Flush()
+    {
+        return Dispatch(false, Clock::now());
+    }
+
+    template<typename ...Args>
+    inline bool CoalescingEvent<void(Args...)>::FlushIfDue(Clock::time_point now)
+    {
+        return Dispatch(true, now);
+    }
+
+    template<typename ...Args>
+    inline bool CoalescingEvent<void(Args...)>::Dispatch(bool checkInterval, Clock::time_point now)
+    {
+        //only this thread can have set its own id, so reading it without the lock is enough to tell.
+        if (dispatchThread_.load(std::memory_order_relaxed) == std::this_thread::get_id())
+            return false;
+        std::lock_guard<std::mutex> dispatchLock(dispatchMutex_);
+        struct DispatchThread
+        {
+            std::atomic<std::thread::id>& id;
+            explicit DispatchThread(std::atomic<std::thread::id>& _id) : id(_id) { id.store(std::this_thread::get_id(), std::memory_order_relaxed); }
+            ~DispatchThread() { id.store(std::thread::id(), std::memory_order_relaxed); }
+        } dispatchThread(dispatchThread_);
+        typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type storage;
+        auto value = reinterpret_cast<ValueType*>(&storage);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!hasPending_ || (checkInterval && dispatched_ != 0 && now - lastDispatch_ < minInterval_))
+                return false;
+            ::new (static_cast<void*>(value)) ValueType(std::move(*GetPending()));
+            GetPending()->~ValueType();
+            hasPending_ = false;
+            dispatched_++;
+            lastDispatch_ = now;
+        }
+
+        //run the handlers without holding mutex_, so producers are never blocked by them.
+        struct Destroyer
+        {
+            ValueType* value;
+            ~Destroyer() { value->~ValueType(); }
+        } destroyer{ value };
+        Emit(*value, std::index_sequence_for<Args...>());
+        return true;
+    }
+
+    template<typename ...Args>
+    inline void CoalescingEvent<void(Args...)>::StartTimer(Clock::duration period)
+    {
+        StopTimer();
+        stopTimer_ = false;
+        timer_ = std::thread([this, period]()
+        {
+            std::unique_lock<std::mutex> lock(timerMutex_);
+            while (!timerCondition_.wait_for(lock, period, [this]() { return stopTimer_; }))
+            {
+                lock.unlock();
+                FlushIfDue();
+                lock.lock();
+            }
+        });
+    }
+
+    template<typename ...Args>
+    inline void CoalescingEvent<void(Args...)>::StopTimer()
+    {
+        if (!timer_.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(timerMutex_);
+            stopTimer_ = true;
+        }
+        timerCondition_.notify_all();
+        //the timer can't join itself; it stops after the running flush, and is joined by the next StopTimer or the destructor.
+        if (timer_.get_id() != std::this_thread::get_id())
+            timer_.join();
+    }
+
+    template<typename ...Args>
+    inline CoalescingEventStatistics CoalescingEvent<void(Args...)>::GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return CoalescingEventStatistics{ emitted_, dispatched_ };
+    }
+}
@@ -0,0 +1,149 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "CoalescingEvent.h"
+#include "Test.h"
+
+using namespace cru;
+
+CRU_TEST(CoalescingEventLastArgumentsWin)
+{
+    CoalescingEvent<void(int, const std::string&)> event;
+    std::vector<std::pair<int, std::string>> log;
+    event += [&log](int value, const std::string& text) { log.emplace_back(value, text); };
+    CRU_CHECK(!event.Flush());
+    for (int i = 0; i < 1000; i++)
+        event(i, std::to_string(i));
+    CRU_CHECK(log.empty());
+    CRU_CHECK(event.Flush());
+    CRU_CHECK(!event.Flush());
+    CRU_CHECK(log.size() == 1 && log[0].first == 999 && log[0].second == "999");
+}
+
+CRU_TEST(CoalescingEventReducesArguments)
+{
+    CoalescingEvent<void(double)> event([](std::tuple<double>& pending, std::tuple<double>&& incoming) { std::get<0>(pending) += std::get<0>(incoming); });
+    double total = 0;
+    event += [&total](double value) { total = value; };
+    for (int i = 0; i < 10; i++)
+        event(1.0);
+    CRU_CHECK(event.Flush() && total == 10.0);
+    //the reduction starts over after a flush.
+    event(2.0);
+    CRU_CHECK(event.Flush() && total == 2.0);
+    const auto statistics = event.GetStatistics();
+    CRU_CHECK(statistics.emitted == 11 && statistics.dispatched == 2);
+}
+
+CRU_TEST(CoalescingEventMinInterval)
+{
+    CoalescingEvent<void(int)> event;
+    int last = 0;
+    event += [&last](int value) { last = value; };
+    event.SetMinInterval(std::chrono::hours(1));
+    event(1);
+    const auto now = CoalescingEvent<void(int)>::Clock::now();
+    CRU_CHECK(event.FlushIfDue(now) && last == 1);
+    event(2);
+    CRU_CHECK(!event.FlushIfDue(now + std::chrono::minutes(59)) && last == 1);
+    CRU_CHECK(event.FlushIfDue(now + std::chrono::hours(2)) && last == 2);
+    //Flush ignores the interval.
+    event(3);
+    CRU_CHECK(event.Flush() && last == 3);
+}
+
+CRU_TEST(CoalescingEventTimerFlushes)
+{
+    CoalescingEvent<void(int)> event;
+    std::atomic<int> last{ -1 };
+    std::atomic<int> dispatchCount{ 0 };
+    event += [&](int value) { last = value; dispatchCount++; };
+    event.StartTimer(std::chrono::milliseconds(1));
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 3; i++)
+        producers.emplace_back([&event]() {
+            for (int j = 0; j < 20000; j++)
+                event(j);
+        });
+    for (auto& i : producers)
+        i.join();
+    event(-2);
+    for (int i = 0; i < 5000 && last.load() != -2; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    event.StopTimer();
+    CRU_CHECK(last.load() == -2);
+    CRU_CHECK(!event.Flush());
+    const auto statistics = event.GetStatistics();
+    CRU_CHECK(statistics.emitted == 60001);
+    CRU_CHECK(statistics.dispatched == static_cast<std::uint64_t>(dispatchCount.load()));
+    CRU_CHECK(statistics.dispatched < statistics.emitted);
+}
+
+CRU_TEST(CoalescingEventDestroysPendingArguments)
+{
+    auto shared = std::make_shared<int>(1);
+    {
+        CoalescingEvent<void(std::shared_ptr<int>)> event;
+        event(shared);
+        CRU_CHECK(shared.use_count() == 2);
+    }
+    CRU_CHECK(shared.use_count() == 1);
+}
+
+CRU_TEST(CoalescingEventHandlerFlushesItsOwnEvent)
+{
+    CoalescingEvent<void(int)> event;
+    std::vector<int> values;
+    bool nestedFlush = true;
+    event += [&](int value) {
+        values.push_back(value);
+        if (value == 1)
+        {
+            //emitted again for the next flush, and not flushed from here.
+            event(2);
+            nestedFlush = event.Flush() || event.FlushIfDue();
+        }
+    };
+    event(1);
+    CRU_CHECK(event.Flush());
+    CRU_CHECK(!nestedFlush && (values == std::vector<int>{ 1 }));
+    CRU_CHECK(event.Flush());
+    CRU_CHECK((values == std::vector<int>{ 1, 2 }));
+}
+
+CRU_TEST(CoalescingEventHandlerStopsTheTimer)
+{
+    CoalescingEvent<void(int)> event;
+    std::atomic<int> dispatchCount{ 0 };
+    event += [&](int) {
+        dispatchCount++;
+        event.StopTimer();
+    };
+    event.StartTimer(std::chrono::milliseconds(1));
+    event(1);
+    for (int i = 0; i < 5000 && dispatchCount.load() == 0; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    CRU_CHECK(dispatchCount.load() == 1);
+    //the timer has stopped, so nothing flushes this one.
+    event(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CRU_CHECK(dispatchCount.load() == 1);
+
+    //it's joined here, and can start again.
+    event.StopTimer();
+    event.ClearHandlers();
+    std::atomic<int> last{ 0 };
+    event += [&last](int value) { last = value; };
+    event.StartTimer(std::chrono::milliseconds(1));
+    event(3);
+    for (int i = 0; i < 5000 && last.load() != 3; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    event.StopTimer();
+    CRU_CHECK(last.load() == 3);
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <utility>
+
+namespace cru
+{
+    //combiners fold the results of the handlers of an event with Event::Invoke.
+    //a combiner is a class with two members:
+    //  bool Combine(T value) : take the result of one handler,
+    //                          return false to stop invoking the remaining handlers.
+    //  GetResult()           : the final result, returned by Invoke.
+
+    //result of the last handler, or T() if there is none.
+    template<typename T>
+    class LastValue
+    {
+    public:
+        bool Combine(T value) { value_ = std::move(value); return true; }
+        T GetResult() { return std::move(value_); }
+    private:
+        T value_{};
+    };
+
+    //write every result to a caller supplied buffer.
+    //the result is the output iterator past the last written one.
+    template<typename OutputIterator>
+    class CollectInto
+    {
+    public:
+        explicit CollectInto(OutputIterator output) : output_(output) { }
+
+        template<typename T>
+        bool Combine(T&& value) { *output_++ = std::forward<T>(value); return true; }
+        OutputIterator GetResult() { return output_; }
+    private:
+        OutputIterator output_;
+    };
+
+    template<typename OutputIterator>
+    CollectInto<OutputIterator> Collect(OutputIterator output) { return CollectInto<OutputIterator>(output); }
+
+    //sum of the results, starting from "initial".
+    template<typename T>
+    class Sum
+    {
+    public:
+        explicit Sum(T initial = T()) : value_(std::move(initial)) { }
+
+        bool Combine(T value) { value_ += value; return true; }
+        T GetResult() { return std::move(value_); }
+    private:
+        T value_;
+    };
+
+    //the smallest result, or T() if there is none.
+    template<typename T>
+    class Min
+    {
+    public:
+        bool Combine(T value)
+        {
+            if (!hasValue_ || value < value_)
+                value_ = std::move(value);
+            hasValue_ = true;
+            return true;
+        }
+        T GetResult() { return std::move(value_); }
+        bool HasValue() const { return hasValue_; }
+    private:
+        T value_{};
+        bool hasValue_ = false;
+    };
+
+    //the biggest result, or T() if there is none.
+    template<typename T>
+    class Max
+    {
+    public:
+        bool Combine(T value)
+        {
+            if (!hasValue_ || value_ < value)
+                value_ = std::move(value);
+            hasValue_ = true;
+            return true;
+        }
+        T GetResult() { return std::move(value_); }
+        bool HasValue() const { return hasValue_; }
+    private:
+        T value_{};
+        bool hasValue_ = false;
+    };
+
+    //the first result that converts to true, such as a non-empty std::optional or a non-null pointer.
+    //handlers after it are not invoked, so "the first one who handles it wins" costs only what it takes to find that one.
+    template<typename T>
+    class FirstNonEmpty
+    {
+    public:
+        bool Combine(T value)
+        {
+            if (!value)
+                return true;
+            value_ = std::move(value);
+            return false;
+        }
+        T GetResult() { return std::move(value_); }
+    private:
+        T value_{};
+    };
+}
@@ -0,0 +1,89 @@
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Combiner.h"
+#include "Event.h"
+#include "Test.h"
+
+using namespace cru;
+
+namespace
+{
+    //stop after "limit" results, to check Invoke honours a false from Combine.
+    class TakeFirst
+    {
+    public:
+        explicit TakeFirst(int limit) : limit_(limit) { }
+
+        bool Combine(int value) { results_.push_back(value); return static_cast<int>(results_.size()) < limit_; }
+        std::vector<int> GetResult() { return std::move(results_); }
+    private:
+        int limit_;
+        std::vector<int> results_;
+    };
+}
+
+CRU_TEST(CombinersFoldEveryResult)
+{
+    Event<int(int)> event;
+    for (int i = 1; i <= 5; i++)
+        event.AddHandler([i](int value) { return value * i; });
+    CRU_CHECK(event(2) == 10);
+    CRU_CHECK(event.Invoke(LastValue<int>(), 2) == 10);
+    CRU_CHECK(event.Invoke(Sum<int>(), 1) == 15);
+    CRU_CHECK(event.Invoke(Sum<int>(100), 1) == 115);
+    CRU_CHECK(event.Invoke(Min<int>(), 3) == 3);
+    CRU_CHECK(event.Invoke(Max<int>(), 3) == 15);
+
+    int buffer[5] = {};
+    CRU_CHECK(event.Invoke(Collect(buffer), 1) == buffer + 5);
+    CRU_CHECK(buffer[0] == 1 && buffer[4] == 5);
+    std::vector<int> results;
+    event.Invoke(Collect(std::back_inserter(results)), 2);
+    CRU_CHECK(results == std::vector<int>{ 2, 4, 6, 8, 10 });
+}
+
+CRU_TEST(CombinersOfNoHandler)
+{
+    Event<int(int)> event;
+    CRU_CHECK(event(1) == 0);
+    CRU_CHECK(event.Invoke(Sum<int>(7), 1) == 7);
+    Min<int> min;
+    CRU_CHECK(!min.HasValue() && min.GetResult() == 0);
+    Event<const char*(int)> route;
+    CRU_CHECK(route.Invoke(FirstNonEmpty<const char*>(), 1) == nullptr);
+}
+
+CRU_TEST(FirstNonEmptyStopsAtTheFirstResult)
+{
+    Event<const char*(int)> event;
+    int calls = 0;
+    event.AddHandler([&calls](int value) -> const char* { calls++; return value == 1 ? "one" : nullptr; });
+    event.AddHandler([&calls](int value) -> const char* { calls++; return value <= 2 ? "two" : nullptr; });
+    event.AddHandler([&calls](int) -> const char* { calls++; return "any"; });
+
+    CRU_CHECK(std::string(event.Invoke(FirstNonEmpty<const char*>(), 1)) == "one");
+    CRU_CHECK(calls == 1);
+    calls = 0;
+    CRU_CHECK(std::string(event.Invoke(FirstNonEmpty<const char*>(), 2)) == "two");
+    CRU_CHECK(calls == 2);
+    calls = 0;
+    CRU_CHECK(std::string(event.Invoke(FirstNonEmpty<const char*>(), 3)) == "any");
+    CRU_CHECK(calls == 3);
+}
+
+CRU_TEST(CustomCombinerStopsEarly)
+{
+    Event<int()> event;
+    int calls = 0;
+    for (int i = 0; i < 5; i++)
+        event.AddHandler([&calls, i]() { calls++; return i; });
+    CRU_CHECK(event.Invoke(TakeFirst(2)) == std::vector<int>{ 0, 1 });
+    CRU_CHECK(calls == 2);
+
+    //an early exit leaves the event usable for the next emit.
+    calls = 0;
+    CRU_CHECK(event.Invoke(TakeFirst(10)).size() == 5);
+    CRU_CHECK(calls == 5);
+}
@@ -0,0 +1,394 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Event.h"
+
+namespace cru
+{
+    namespace internal
+    {
+        //epoch based reclamation.
+        //a reader announces the global epoch in its own record before touching shared data,
+        //and garbage retired at epoch E is freed once the global epoch reaches E + 2,
+        //because by then no reader can still hold it.
+        //readers only write their own cache line, so there is no shared counter to fight over.
+        class EpochDomain
+        {
+            struct Record;
+
+        public:
+            static EpochDomain& Global();
+
+            EpochDomain() = default;
+            EpochDomain(const EpochDomain&) = delete;
+            EpochDomain& operator = (const EpochDomain&) = delete;
+            ~EpochDomain();
+
+            class Guard
+            {
+            public:
+                explicit Guard(EpochDomain& domain);
+                Guard(const Guard&) = delete;
+                Guard& operator = (const Guard&) = delete;
+                ~Guard();
+            private:
+                Record* record_;
+            };
+
+            //free "deleter" once no reader can see what it deletes.
+            //deleters run with no lock held, so a deleter may retire more garbage itself.
+            void Retire(std::function<void()> deleter);
+
+            //free everything retired so far that is safe to free.
+            void Collect();
+
+        private:
+            static constexpr std::uint64_t idle = 0;
+
+            //the padding keeps the epochs of two records off the same cache line.
+            struct Record
+            {
+                std::atomic<std::uint64_t> epoch{ idle };
+                char padding[64];
+                std::atomic<bool> inUse{ false };
+                std::size_t depth = 0;
+                Record* next = nullptr;
+            };
+
+            struct Retired
+            {
+                std::uint64_t epoch;
+                std::function<void()> deleter;
+            };
+
+            Record* AcquireRecord();
+            Record* LocalRecord();
+            bool TryAdvance(std::uint64_t epoch);
+            //must hold retiredMutex_. move out what is safe to free, for the caller to free after unlocking.
+            std::vector<Retired> CollectLocked();
+            static void Free(std::vector<Retired>& retired);
+
+            std::atomic<std::uint64_t> globalEpoch_{ 1 };
+            std::atomic<Record*> records_{ nullptr };
+
+            std::mutex retiredMutex_;
+            std::vector<Retired> retired_;
+
+            friend class Guard;
+        };
+
+        inline EpochDomain& EpochDomain::Global()
+        {
+            static EpochDomain domain;
+            return domain;
+        }
+
+        inline EpochDomain::~EpochDomain()
+        {
+            //a deleter may retire more while this runs.
+            while (!retired_.empty())
+            {
+                std::vector<Retired> retired;
+                retired.swap(retired_);
+                Free(retired);
+            }
+            auto record = records_.load();
+            while (record)
+            {
+                auto next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+
+        inline EpochDomain::Record* EpochDomain::AcquireRecord()
+        {
+            for (auto record = records_.load(std::memory_order_acquire); record; record = record->next)
+            {
+                bool expected = false;
+                if (!record->inUse.load(std::memory_order_relaxed) && record->inUse.compare_exchange_strong(expected, true))
+                    return record;
+            }
+            //records are never freed before the domain, so a thread can push without ABA worries.
+            auto record = new Record;
+            record->inUse.store(true, std::memory_order_relaxed);
+            auto head = records_.load(std::memory_order_relaxed);
+            do
+                record->next = head;
+            while (!records_.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+            return record;
+        }
+
+        inline EpochDomain::Record* EpochDomain::LocalRecord()
+        {
+            //hand the record back for reuse when the thread exits.
+            struct LocalRecords
+            {
+                std::vector<std::pair<EpochDomain*, Record*>> records;
+                ~LocalRecords()
+                {
+                    for (auto& i : records)
+                        i.second->inUse.store(false, std::memory_order_release);
+                }
+            };
+            thread_local LocalRecords local;
+
+            for (auto& i : local.records)
+                if (i.first == this)
+                    return i.second;
+            auto record = AcquireRecord();
+            local.records.emplace_back(this, record);
+            return record;
+        }
+
+        inline EpochDomain::Guard::Guard(EpochDomain& domain) : record_(domain.LocalRecord())
+        {
+            //only the outermost guard of a thread announces, so nested emits are fine.
+            if (record_->depth++ == 0)
+            {
+                record_->epoch.store(domain.globalEpoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+        inline EpochDomain::Guard::~Guard()
+        {
+            if (--record_->depth == 0)
+                record_->epoch.store(idle, std::memory_order_release);
+        }
+
+        inline void EpochDomain::Retire(std::function<void()> deleter)
+        {
+            std::vector<Retired> expired;
+            {
+                std::lock_guard<std::mutex> lock(retiredMutex_);
+                retired_.push_back(Retired{ globalEpoch_.load(std::memory_order_seq_cst), std::move(deleter) });
+                expired = CollectLocked();
+            }
+            Free(expired);
+        }
+
+        inline void EpochDomain::Collect()
+        {
+            std::vector<Retired> expired;
+            {
+                std::lock_guard<std::mutex> lock(retiredMutex_);
+                expired = CollectLocked();
+            }
+            Free(expired);
+        }
+
+        inline void EpochDomain::Free(std::vector<Retired>& retired)
+        {
+            for (auto& i : retired)
+                i.deleter();
+        }
+
+        inline bool EpochDomain::TryAdvance(std::uint64_t epoch)
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (auto record = records_.load(std::memory_order_acquire); record; record = record->next)
+            {
+                const auto recordEpoch = record->epoch.load(std::memory_order_acquire);
+                if (recordEpoch != idle && recordEpoch != epoch)
+                    return false;
+            }
+            return globalEpoch_.compare_exchange_strong(epoch, epoch + 1);
+        }
+
+        inline auto EpochDomain::CollectLocked() -> std::vector<Retired>
+        {
+            auto epoch = globalEpoch_.load(std::memory_order_seq_cst);
+            if (TryAdvance(epoch))
+                ++epoch;
+
+            std::vector<Retired> expired;
+            std::vector<Retired> alive;
+            for (auto& i : retired_)
+                if (i.epoch + 2 <= epoch)
+                    expired.push_back(std::move(i));
+                else
+                    alive.push_back(std::move(i));
+            retired_.swap(alive);
+            return expired;
+        }
+    }
+
+
+    template<typename >
+    class ConcurrentEvent;
+
+    //an event that can be emitted from many threads at once.
+    //
+    //emitters read an immutable snapshot of the handler array through one atomic pointer,
+    //without any lock or reference counting.
+    //adding or removing a handler copies the array, publishes the copy,
+    //and retires the old one to the epoch domain which frees it once no emitter can see it.
+    //writers are serialized by a mutex, which is fine as they are rare compared with emits.
+    //old arrays are retired after the mutex is released,
+    //so destroying a handler may add or disconnect handlers of any concurrent event, this one included.
+    template<typename R, typename... Args>
+    class ConcurrentEvent<R(Args...)> : private internal::ConnectionSource
+    {
+    public:
+        using EventHandler = InlineFunction<R(Args...)>;
+
+        ConcurrentEvent() = default;
+        ConcurrentEvent(const ConcurrentEvent&) = delete;
+        ConcurrentEvent(ConcurrentEvent&&) = delete;
+        ConcurrentEvent& operator = (const ConcurrentEvent&) = delete;
+        ConcurrentEvent& operator = (ConcurrentEvent&&) = delete;
+        ~ConcurrentEvent() { delete snapshot_.load(std::memory_order_relaxed); }
+
+        template<typename Handler>
+        Connection AddHandler(Handler&& handler);
+        void ClearHandlers();
+
+        std::size_t GetHandlerCount() const;
+
+        void operator()(Args... args) const;
+
+        template<typename Handler>
+        Connection operator+=(Handler&& handler) { return AddHandler(std::forward<Handler>(handler)); }
+
+    private:
+        struct Entry
+        {
+            std::shared_ptr<EventHandler> handler;
+            std::uint64_t id;
+        };
+
+        struct Snapshot
+        {
+            std::vector<Entry> entries;
+        };
+
+        void Disconnect(std::uint32_t slot, std::uint32_t generation) override;
+        bool IsConnected(std::uint32_t slot, std::uint32_t generation) const override;
+
+        //must hold writeMutex_. return the old snapshot, to be retired after unlocking.
+        Snapshot* Publish(Snapshot* snapshot);
+        static void Retire(Snapshot* snapshot);
+
+        static std::uint64_t MakeId(std::uint32_t slot, std::uint32_t generation) { return static_cast<std::uint64_t>(generation) << 32 | slot; }
+
+        std::atomic<Snapshot*> snapshot_{ nullptr };
+        mutable std::mutex writeMutex_;
+        std::uint64_t nextId_ = 0;
+    };
+
+    template<typename R, typename ...Args>
+    template<typename Handler>
+    inline Connection ConcurrentEvent<R(Args...)>::AddHandler(Handler&& handler)
+    {
+        auto function = std::make_shared<EventHandler>(std::forward<Handler>(handler));
+        if (!*function)
+            return Connection();
+
+        std::uint64_t id;
+        Snapshot* old;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            id = nextId_++;
+            old = snapshot_.load(std::memory_order_relaxed);
+            auto snapshot = old ? new Snapshot(*old) : new Snapshot;
+            snapshot->entries.push_back(Entry{ std::move(function), id });
+            old = Publish(snapshot);
+        }
+        Retire(old);
+        return Connection(this, static_cast<std::uint32_t>(id), static_cast<std::uint32_t>(id >> 32));
+    }
+
+    template<typename R, typename ...Args>
+    inline void ConcurrentEvent<R(Args...)>::ClearHandlers()
+    {
+        Snapshot* old;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            old = Publish(nullptr);
+        }
+        Retire(old);
+    }
+
+    template<typename R, typename ...Args>
+    inline std::size_t ConcurrentEvent<R(Args...)>::GetHandlerCount() const
+    {
+        internal::EpochDomain::Guard guard(internal::EpochDomain::Global());
+        const auto snapshot = snapshot_.load(std::memory_order_acquire);
+        return snapshot ? snapshot->entries.size() : 0;
+    }
+
+    template<typename R, typename ...Args>
+    inline void ConcurrentEvent<R(Args...)>::operator()(Args... args) const
+    {
+        internal::EpochDomain::Guard guard(internal::EpochDomain::Global());
+        const auto snapshot = snapshot_.load(std::memory_order_acquire);
+        if (snapshot)
+            for (auto& i : snapshot->entries)
+                (*i.handler)(args...);
+    }
+
+    template<typename R, typename ...Args>
+    inline void ConcurrentEvent<R(Args...)>::Disconnect(std::uint32_t slot, std::uint32_t generation)
+    {
+        const auto id = MakeId(slot, generation);
+        Snapshot* old;
+        {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            auto current = snapshot_.load(std::memory_order_relaxed);
+            if (!current)
+                return;
+
+            auto snapshot = new Snapshot;
+            snapshot->entries.reserve(current->entries.size());
+            for (auto& i : current->entries)
+                if (i.id != id)
+                    snapshot->entries.push_back(i);
+            if (snapshot->entries.size() == current->entries.size())
+            {
+                delete snapshot;
+                return;
+            }
+            if (snapshot->entries.empty())
+            {
+                delete snapshot;
+                snapshot = nullptr;
+            }
+            old = Publish(snapshot);
+        }
+        Retire(old);
+    }
+
+    template<typename R, typename ...Args>
+    inline bool ConcurrentEvent<R(Args...)>::IsConnected(std::uint32_t slot, std::uint32_t generation) const
+    {
+        const auto id = MakeId(slot, generation);
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto snapshot = snapshot_.load(std::memory_order_relaxed);
+        if (snapshot)
+            for (auto& i : snapshot->entries)
+                if (i.id == id)
+                    return true;
+        return false;
+    }
+
+    template<typename R, typename ...Args>
+    inline auto ConcurrentEvent<R(Args...)>::Publish(Snapshot* snapshot) -> Snapshot*
+    {
+        return snapshot_.exchange(snapshot, std::memory_order_seq_cst);
+    }
+
+    template<typename R, typename ...Args>
+    inline void ConcurrentEvent<R(Args...)>::Retire(Snapshot* snapshot)
+    {
+        if (snapshot)
+            internal::EpochDomain::Global().Retire([snapshot]() { delete snapshot; });
+    }
+}
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ConcurrentEvent.h"
+#include "Test.h"
+
+using namespace cru;
+
+namespace
+{
+    //a handler that notices being called after it was destroyed.
+    struct CheckedHandler
+    {
+        static const std::uint32_t aliveMagic = 0x600DF00D;
+
+        CheckedHandler(std::atomic<long>& calls, std::atomic<long>& badCalls) : calls(&calls), badCalls(&badCalls) { }
+        CheckedHandler(const CheckedHandler& other) : magic(other.magic), calls(other.calls), badCalls(other.badCalls) { }
+        ~CheckedHandler() { magic = 0; }
+
+        void operator()(int) const
+        {
+            if (magic != aliveMagic)
+                badCalls->fetch_add(1, std::memory_order_relaxed);
+            calls->fetch_add(1, std::memory_order_relaxed);
+        }
+
+        volatile std::uint32_t magic = aliveMagic;
+        std::atomic<long>* calls;
+        std::atomic<long>* badCalls;
+    };
+
+    //retire twice, so everything retired before is freed when nobody is emitting.
+    void CollectAll()
+    {
+        internal::EpochDomain::Global().Collect();
+        internal::EpochDomain::Global().Collect();
+    }
+}
+
+CRU_TEST(ConcurrentEventAddsAndDisconnects)
+{
+    ConcurrentEvent<void(int)> event;
+    int sum = 0;
+    auto first = event.AddHandler([&sum](int value) { sum += value; });
+    auto second = event += [&sum](int value) { sum += value * 10; };
+    event(1);
+    CRU_CHECK(sum == 11);
+    CRU_CHECK(event.GetHandlerCount() == 2);
+    first.Disconnect();
+    CRU_CHECK(!first.IsConnected() && second.IsConnected());
+    event(1);
+    CRU_CHECK(sum == 21);
+    second.Disconnect();
+    CRU_CHECK(event.GetHandlerCount() == 0);
+    event.AddHandler([&sum](int value) { sum += value; });
+    event.ClearHandlers();
+    event(1);
+    CRU_CHECK(sum == 21);
+}
+
+CRU_TEST(ConcurrentEventHandlerDestructorMayDisconnect)
+{
+    ConcurrentEvent<void(int)> event;
+    ConcurrentEvent<void(int)> other;
+    int calls = 0;
+    auto owned = std::make_shared<ScopedConnection>(other.AddHandler([&calls](int) { calls++; }));
+    //destroying this handler disconnects from "other" and also from "event" itself, both retiring arrays.
+    auto self = std::make_shared<ScopedConnection>();
+    auto connection = event.AddHandler([owned, self](int) { });
+    *self = event.AddHandler([](int) { });
+    owned.reset();
+    self.reset();
+
+    connection.Disconnect();
+    CollectAll();
+    CollectAll();
+    CRU_CHECK(other.GetHandlerCount() == 0);
+    CRU_CHECK(event.GetHandlerCount() == 0);
+
+    //both events still take new handlers, which hung when the deleters ran under the locks.
+    event.AddHandler([&calls](int) { calls++; });
+    other.AddHandler([&calls](int) { calls++; });
+    event(0);
+    other(0);
+    CRU_CHECK(calls == 2);
+}
+
+CRU_TEST(ConcurrentEventStress)
+{
+    const int emitterCount = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+    const int changeCount = 5000;
+
+    ConcurrentEvent<void(int)> event;
+    std::atomic<long> calls{ 0 };
+    std::atomic<long> badCalls{ 0 };
+    std::atomic<bool> stop{ false };
+
+    std::vector<std::thread> emitters;
+    for (int i = 0; i < emitterCount; i++)
+        emitters.emplace_back([&event, &stop]() {
+            while (!stop.load(std::memory_order_relaxed))
+                event(1);
+        });
+
+    //keep a window of handlers, some of them owning connections to the event itself.
+    std::vector<Connection> connections;
+    for (int i = 0; i < changeCount; i++)
+    {
+        if (i % 3 == 0)
+        {
+            auto owned = std::make_shared<ScopedConnection>(event.AddHandler(CheckedHandler(calls, badCalls)));
+            connections.push_back(event.AddHandler([owned](int) { }));
+        }
+        else
+            connections.push_back(event.AddHandler(CheckedHandler(calls, badCalls)));
+        if (connections.size() > 8)
+        {
+            connections.front().Disconnect();
+            connections.erase(connections.begin());
+        }
+        if (i % 1000 == 999)
+        {
+            event.ClearHandlers();
+            connections.clear();
+        }
+    }
+    stop = true;
+    for (auto& i : emitters)
+        i.join();
+
+    CRU_CHECK(event.GetHandlerCount() == connections.size());
+    for (auto& i : connections)
+        CRU_CHECK(i.IsConnected());
+    CRU_CHECK(badCalls.load() == 0);
+    CRU_CHECK(calls.load() > 0);
+    CollectAll();
+}
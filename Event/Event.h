@@ -1,53 +1,602 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
 #include <utility>
-#include <list>
-#include <functional>
+#include <vector>
+
+#include "Combiner.h"
+#include "InlineFunction.h"
 
 namespace cru
 {
-    template<typename >
+    namespace internal
+    {
+        //the side of an event that a Connection talks to.
+        class ConnectionSource
+        {
+        public:
+            virtual void Disconnect(std::uint32_t slot, std::uint32_t generation) = 0;
+            virtual bool IsConnected(std::uint32_t slot, std::uint32_t generation) const = 0;
+        protected:
+            ~ConnectionSource() = default;
+        };
+
+        //a coroutine waiting for the next emit of an event, see AwaitableEvent.h.
+        //the nodes live in the coroutine frames and the event holds the head of their list,
+        //so waiting allocates nothing and an emit nobody waits for costs one test.
+        //"link" points at the pointer to the node, so a node unlinks itself from whatever list it's in.
+        template<typename... Args>
+        struct EmitWaiter
+        {
+            EmitWaiter* next = nullptr;
+            EmitWaiter** link = nullptr;
+            void (*resume)(EmitWaiter& waiter, Args&... args) = nullptr;
+
+            bool IsWaiting() const { return link != nullptr; }
+
+            void Push(EmitWaiter*& head)
+            {
+                next = head;
+                if (next)
+                    next->link = &next;
+                link = &head;
+                head = this;
+            }
+
+            void Unlink()
+            {
+                if (!link)
+                    return;
+                *link = next;
+                if (next)
+                    next->link = link;
+                next = nullptr;
+                link = nullptr;
+            }
+        };
+
+        //lets the dispatchers living in other headers reach the handler array of an event.
+        //every entry has a "handler" member, a "slot" and an IsAlive() telling whether it's a hole.
+        class EventAccess
+        {
+        public:
+            template<typename EventType>
+            static auto& GetEntries(EventType& event) { return event.handlers_; }
+            template<typename EventType>
+            static auto& GetWaiters(EventType& event) { return event.waiters_; }
+
+            //while one lives, changes to the event are deferred as during an emit.
+            template<typename EventType>
+            class EmitScope
+            {
+            public:
+                explicit EmitScope(const EventType& event) : scope_(event) { }
+
+            private:
+                typename EventType::EmitScope scope_;
+            };
+            //whether the event was changed under an EmitScope.
+            template<typename EventType>
+            static bool HasPendingOperations(const EventType& event) { return event.hasDeferredHoles_ || !event.pendingHandlers_.empty() || !event.releasedSlots_.empty(); }
+            //resume the coroutines waiting for the next emit, as an emit does after its handlers.
+            template<typename EventType, typename... Values>
+            static void ResumeWaiters(const EventType& event, Values&... values)
+            {
+                if (event.waiters_)
+                    event.ResumeWaiters(values...);
+            }
+        };
+    }
+
+    //a lightweight handle to one handler added to an event.
+    //it is a slot index plus the generation of that slot,
+    //so a handle whose handler is already gone is detected and ignored.
+    //a Connection must not be used after its event is destroyed.
+    class Connection
+    {
+    public:
+        Connection() = default;
+        Connection(internal::ConnectionSource* source, std::uint32_t slot, std::uint32_t generation)
+            : source_(source), slot_(slot), generation_(generation) { }
+
+        bool IsConnected() const { return source_ != nullptr && source_->IsConnected(slot_, generation_); }
+        void Disconnect();
+
+        //the slot of the handler in its event, which is what instrumentation reports.
+        std::uint32_t GetSlot() const { return slot_; }
+
+    private:
+        internal::ConnectionSource* source_ = nullptr;
+        std::uint32_t slot_ = 0;
+        std::uint32_t generation_ = 0;
+    };
+
+    //disconnect the handler when destroyed.
+    class ScopedConnection
+    {
+    public:
+        ScopedConnection() = default;
+        ScopedConnection(const Connection& connection) : connection_(connection) { }
+        ScopedConnection(const ScopedConnection&) = delete;
+        ScopedConnection(ScopedConnection&& other) : connection_(other.Release()) { }
+        ScopedConnection& operator = (const ScopedConnection&) = delete;
+        ScopedConnection& operator = (ScopedConnection&& other);
+        ~ScopedConnection() { connection_.Disconnect(); }
+
+        bool IsConnected() const { return connection_.IsConnected(); }
+        void Disconnect() { connection_.Disconnect(); }
+
+        //give up the ownership without disconnecting.
+        Connection Release();
+
+    private:
+        Connection connection_;
+    };
+
+    inline void Connection::Disconnect()
+    {
+        if (source_)
+            source_->Disconnect(slot_, generation_);
+        source_ = nullptr;
+    }
+
+    inline ScopedConnection& ScopedConnection::operator = (ScopedConnection&& other)
+    {
+        if (this != &other)
+        {
+            connection_.Disconnect();
+            connection_ = other.Release();
+        }
+        return *this;
+    }
+
+    inline Connection ScopedConnection::Release()
+    {
+        Connection connection = connection_;
+        connection_ = Connection();
+        return connection;
+    }
+
+
+    //the instrumentation policy of Event when none is asked for.
+    //every hook is empty, so an uninstrumented event costs exactly the same as it would without the hooks.
+    //an instrumentation policy is a class with these members:
+    //  void OnConnect(std::uint32_t slot) / void OnDisconnect(std::uint32_t slot)
+    //  Token BeginCall(std::uint32_t slot) const / void EndCall(std::uint32_t slot, Token token) const
+    //where BeginCall and EndCall wrap every call of a handler and get the same slot,
+    //even if the handler disconnected itself in between.
+    struct NoInstrumentation
+    {
+        struct Token { };
+
+        void OnConnect(std::uint32_t) { }
+        void OnDisconnect(std::uint32_t) { }
+        Token BeginCall(std::uint32_t) const { return Token(); }
+        void EndCall(std::uint32_t, Token) const { }
+    };
+
+    template<typename, typename = NoInstrumentation>
     class Event;
 
-    template<typename R, typename... Args>
-    class Event<R(Args...)>
+    //handlers are kept in one contiguous buffer of InlineFunction,
+    //so emitting is a linear walk over an array
+    //and adding a small handler doesn't allocate once capacity is reserved.
+    //
+    //each handler owns a slot in a generational slot map, which is what a Connection refers to.
+    //disconnecting leaves a hole in the buffer that emit skips;
+    //holes are squeezed out in place, keeping the order, once they make up half of the buffer.
+    //
+    //handlers may add, disconnect or clear handlers of the event that is invoking them, and emit it again.
+    //while an emit is running the buffer is never touched:
+    //a disconnected handler is only marked as a hole and destroyed later,
+    //and a new handler waits in a pending list, so it isn't invoked by the running emit.
+    //both are settled when the outermost emit finishes, and only then are the slots of disconnected handlers reused.
+    //handlers are never destroyed in place either, as their destructors may call back into the event.
+    //
+    //coroutines can wait for the next emit too, see AwaitableEvent.h. they are resumed after the handlers.
+    //
+    //EmitBatch emits many records at once, handler by handler rather than record by record,
+    //so each handler runs over the whole batch in a tight loop while its code is hot.
+    //every handler still gets the records in order, and the batch as a whole comes after the emits before it
+    //and before the emits after it; only the interleaving across handlers differs from emitting the records one by one.
+    //so a handler must not rely on another one having seen the same record,
+    //and a handler disconnected during the batch stops at the record being emitted, or gets none if its turn hasn't come.
+    //waiting coroutines are resumed once per record, after every handler got the whole batch.
+    //
+    //"Instrumentation" watches every handler call, see NoInstrumentation.
+    //it's a base class so the empty default takes no room.
+    template<typename R, typename... Args, typename Instrumentation>
+    class Event<R(Args...), Instrumentation> : private internal::ConnectionSource, private Instrumentation
     {
     public:
-        using EventHandler = std::function<R(Args...)>;
+        using EventHandler = InlineFunction<R(Args...)>;
+        using InstrumentationType = Instrumentation;
+        //one set of arguments in a batch, see EmitBatch.
+        using Record = std::tuple<typename std::decay<Args>::type...>;
 
         Event() = default;
         Event(const Event&) = delete;
         Event(Event&&) = delete;
         Event& operator = (const Event&) = delete;
         Event& operator = (Event&&) = delete;
-        ~Event() = default;
+        ~Event();
 
-        template<typename... Args>
-        void AddHandler(Args&& args) { handlers_.emplace_back(std::forward<Args>(args)...); }
-        void ClearHandlers() { handlers_.clear(); }
+        template<typename Handler>
+        Connection AddHandler(Handler&& handler);
+        void ClearHandlers();
+
+        //reserve room for handlers so that adding them later won't reallocate.
+        void ReserveHandlers(std::size_t count);
+        std::size_t GetHandlerCount() const { return handlerCount_; }
+
+        //invoke every handler. when R is not void, return the result of the last one (see LastValue).
+        R operator()(Args... args) const;
+
+        //invoke the handlers and fold their results with "combiner" (see Combiner.h),
+        //stopping as soon as the combiner asks to.
+        template<typename Combiner>
+        auto Invoke(Combiner combiner, Args... args) const;
+
+        //invoke every handler with "count" records in a row, see the comment of the class.
+        void EmitBatch(const Record* records, std::size_t count) const;
+        //the same for any contiguous container of records, like std::vector or std::array.
+        template<typename Records>
+        void EmitBatch(const Records& records) const { EmitBatch(records.data(), records.size()); }
+
+        template<typename Handler>
+        Connection operator+=(Handler&& handler) { return AddHandler(std::forward<Handler>(handler)); }
+
+        Instrumentation& GetInstrumentation() { return *this; }
+        const Instrumentation& GetInstrumentation() const { return *this; }
 
-        R operator()(Args&&... args) const;
-        void operator+=(const EventHandler& handler);
-        void operator+=(EventHandler&& handler);
     private:
-        std::list<EventHandler> handlers_;
+        friend class internal::EventAccess;
+
+        //slot of an entry that is a hole.
+        static const std::uint32_t noSlot = 0xFFFFFFFF;
+        //set in Slot::index when the handler is in pendingHandlers_.
+        static const std::uint32_t pendingFlag = 0x80000000;
+
+        struct Entry
+        {
+            Entry(EventHandler&& handler, std::uint32_t slot) : handler(std::move(handler)), slot(slot) { }
+
+            bool IsAlive() const { return slot != noSlot; }
+
+            EventHandler handler;
+            std::uint32_t slot;
+        };
+
+        struct Slot
+        {
+            std::uint32_t index;
+            std::uint32_t generation;
+        };
+
+        //count the depth of running emits, and settle the pending operations when the outermost one ends.
+        class EmitScope
+        {
+        public:
+            explicit EmitScope(const Event& event) : event_(event) { ++event_.emitDepth_; }
+            EmitScope(const EmitScope&) = delete;
+            EmitScope& operator = (const EmitScope&) = delete;
+            ~EmitScope();
+        private:
+            const Event& event_;
+        };
+
+        void Disconnect(std::uint32_t slot, std::uint32_t generation) override;
+        bool IsConnected(std::uint32_t slot, std::uint32_t generation) const override;
+
+        void Emit(std::true_type, Args&... args) const;
+        R Emit(std::false_type, Args&... args) const { return Invoke(LastValue<R>(), args...); }
+
+        void ApplyPendingOperations();
+        void ResumeWaiters(Args&... args) const;
+
+        template<std::size_t... Indexes>
+        static void Call(const EventHandler& handler, const Record& record, std::index_sequence<Indexes...>) { handler(std::get<Indexes>(record)...); }
+        template<std::size_t... Indexes>
+        void ResumeWaiters(Record& record, std::index_sequence<Indexes...>) const { ResumeWaiters(std::get<Indexes>(record)...); }
+
+        //move the handler out and destroy it, so the entry is empty before any destructor runs.
+        static void DestroyHandler(EventHandler& handler) { EventHandler dying(std::move(handler)); }
+
+        std::uint32_t AcquireSlot();
+        void ReleaseSlot(std::uint32_t slot);
+        void Compact();
+
+        std::vector<Entry> handlers_;
+        std::vector<Slot> slots_;
+        std::vector<std::uint32_t> freeSlots_;
+        std::size_t holeCount_ = 0;
+        std::size_t handlerCount_ = 0;
+
+        //handlers added during an emit.
+        std::vector<Entry> pendingHandlers_;
+        //whether some handler was disconnected during an emit and is still to be destroyed.
+        bool hasDeferredHoles_ = false;
+        //slots released during an emit, reused only after it.
+        std::vector<std::uint32_t> releasedSlots_;
+        mutable std::size_t emitDepth_ = 0;
+
+        //coroutines waiting for the next emit.
+        mutable internal::EmitWaiter<Args...>* waiters_ = nullptr;
     };
 
-    template<typename R, typename ...Args>
-    R Event<R(Args)>::operator()(Args && ...args) const
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline Event<R(Args...), Instrumentation>::~Event()
+    {
+        //their coroutines are never resumed, but may still be destroyed without touching the event.
+        while (waiters_)
+            waiters_->Unlink();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline Event<R(Args...), Instrumentation>::EmitScope::~EmitScope()
+    {
+        //the event isn't really const if someone could change it during the emit.
+        if (--event_.emitDepth_ == 0 && (event_.hasDeferredHoles_ || !event_.pendingHandlers_.empty() || !event_.releasedSlots_.empty()))
+            const_cast<Event&>(event_).ApplyPendingOperations();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    template<typename Handler>
+    inline Connection Event<R(Args...), Instrumentation>::AddHandler(Handler&& handler)
+    {
+        EventHandler function(std::forward<Handler>(handler));
+        if (!function)
+            return Connection();
+        const auto slot = AcquireSlot();
+        if (emitDepth_ == 0)
+        {
+            slots_[slot].index = static_cast<std::uint32_t>(handlers_.size());
+            handlers_.emplace_back(std::move(function), slot);
+        }
+        else
+        {
+            slots_[slot].index = static_cast<std::uint32_t>(pendingHandlers_.size()) | pendingFlag;
+            pendingHandlers_.emplace_back(std::move(function), slot);
+        }
+        handlerCount_++;
+        this->OnConnect(slot);
+        return Connection(this, slot, slots_[slot].generation);
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::ClearHandlers()
     {
         for (auto& i : handlers_)
-            i(std::forward<Args>(args)...);
+            if (i.IsAlive())
+            {
+                this->OnDisconnect(i.slot);
+                ReleaseSlot(i.slot);
+                i.slot = noSlot;
+            }
+        holeCount_ = handlers_.size();
+        hasDeferredHoles_ = !handlers_.empty();
+
+        //pending handlers were never invoked; they are destroyed on return.
+        std::vector<Entry> pending;
+        pending.swap(pendingHandlers_);
+        for (auto& i : pending)
+            if (i.IsAlive())
+            {
+                this->OnDisconnect(i.slot);
+                ReleaseSlot(i.slot);
+            }
+        handlerCount_ = 0;
+
+        if (emitDepth_ == 0)
+            ApplyPendingOperations();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::ReserveHandlers(std::size_t count)
+    {
+        handlers_.reserve(count);
+        slots_.reserve(count);
+        freeSlots_.reserve(count);
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline R Event<R(Args...), Instrumentation>::operator()(Args... args) const
+    {
+        return Emit(std::is_void<R>(), args...);
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    template<typename Combiner>
+    inline auto Event<R(Args...), Instrumentation>::Invoke(Combiner combiner, Args... args) const
+    {
+        static_assert(!std::is_void<R>::value, "Handlers of the event return nothing to combine.");
+        EmitScope scope(*this);
+        //walk by index and stop at the current end, the buffer is stable during the emit.
+        for (std::size_t i = 0, count = handlers_.size(); i < count; i++)
+        {
+            auto& entry = handlers_[i];
+            if (!entry.IsAlive())
+                continue;
+            //the handler may disconnect itself, which resets entry.slot.
+            const auto slot = entry.slot;
+            const auto token = this->BeginCall(slot);
+            R result = entry.handler(args...);
+            this->EndCall(slot, token);
+            if (!combiner.Combine(std::forward<R>(result)))
+                break;
+        }
+        if (waiters_)
+            ResumeWaiters(args...);
+        return combiner.GetResult();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::Emit(std::true_type, Args&... args) const
+    {
+        EmitScope scope(*this);
+        for (std::size_t i = 0, count = handlers_.size(); i < count; i++)
+        {
+            auto& entry = handlers_[i];
+            if (!entry.IsAlive())
+                continue;
+            //the handler may disconnect itself, which resets entry.slot.
+            const auto slot = entry.slot;
+            const auto token = this->BeginCall(slot);
+            entry.handler(args...);
+            this->EndCall(slot, token);
+        }
+        if (waiters_)
+            ResumeWaiters(args...);
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::EmitBatch(const Record* records, std::size_t count) const
+    {
+        static_assert(std::is_void<R>::value, "Handlers of a batch must return nothing, as there is nothing to give their results to.");
+        EmitScope scope(*this);
+        for (std::size_t i = 0, handlerCount = handlers_.size(); i < handlerCount; i++)
+        {
+            auto& entry = handlers_[i];
+            //a handler may disconnect itself in the middle of the batch, which resets entry.slot,
+            //so the slot is kept and whether it's alive is checked per record.
+            const auto slot = entry.slot;
+            for (std::size_t j = 0; j < count && entry.IsAlive(); j++)
+            {
+                const auto token = this->BeginCall(slot);
+                Call(entry.handler, records[j], std::index_sequence_for<Args...>());
+                this->EndCall(slot, token);
+            }
+        }
+        for (std::size_t j = 0; j < count && waiters_; j++)
+        {
+            //waiters take the arguments as non-const lvalues, like the handlers do in an emit, so give them a copy.
+            Record record(records[j]);
+            ResumeWaiters(record, std::index_sequence_for<Args...>());
+        }
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::ResumeWaiters(Args&... args) const
+    {
+        //take the whole list, so a coroutine waiting again waits for the next emit.
+        //the rest of it stays a list, so a resumed coroutine may still destroy another waiting one.
+        internal::EmitWaiter<Args...>* waiters = nullptr;
+        std::swap(waiters, waiters_);
+        waiters->link = &waiters;
+        while (waiters)
+        {
+            auto& waiter = *waiters;
+            waiter.Unlink();
+            waiter.resume(waiter, args...);
+        }
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::Disconnect(std::uint32_t slot, std::uint32_t generation)
+    {
+        if (!IsConnected(slot, generation))
+            return;
+        const auto index = slots_[slot].index;
+        this->OnDisconnect(slot);
+        ReleaseSlot(slot);
+        handlerCount_--;
+
+        //destroyed on return, after the event is consistent again.
+        EventHandler dying;
+
+        if (index & pendingFlag)
+        {
+            //never invoked, so it can go at once. the entry is dropped when pending ones are settled.
+            auto& entry = pendingHandlers_[index & ~pendingFlag];
+            dying = std::move(entry.handler);
+            entry.slot = noSlot;
+            return;
+        }
+
+        auto& entry = handlers_[index];
+        entry.slot = noSlot;
+        holeCount_++;
+        if (emitDepth_ != 0)
+        {
+            //it may be the very handler running now, so destroy it after the emit.
+            hasDeferredHoles_ = true;
+            return;
+        }
+        dying = std::move(entry.handler);
+        if (holeCount_ * 2 > handlers_.size())
+            Compact();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline bool Event<R(Args...), Instrumentation>::IsConnected(std::uint32_t slot, std::uint32_t generation) const
+    {
+        return slot < slots_.size() && slots_[slot].generation == generation;
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::ApplyPendingOperations()
+    {
+        //destructors of handlers may change the event again, so destroy them as if an emit were running.
+        ++emitDepth_;
+        while (hasDeferredHoles_)
+        {
+            hasDeferredHoles_ = false;
+            for (std::size_t i = 0; i < handlers_.size(); i++)
+                if (!handlers_[i].IsAlive())
+                    DestroyHandler(handlers_[i].handler);
+        }
+        --emitDepth_;
+        freeSlots_.insert(freeSlots_.end(), releasedSlots_.begin(), releasedSlots_.end());
+        releasedSlots_.clear();
+
+        if (holeCount_ * 2 > handlers_.size())
+            Compact();
+
+        for (auto& i : pendingHandlers_)
+            if (i.IsAlive())
+            {
+                slots_[i.slot].index = static_cast<std::uint32_t>(handlers_.size());
+                handlers_.push_back(std::move(i));
+            }
+        pendingHandlers_.clear();
+    }
+
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline std::uint32_t Event<R(Args...), Instrumentation>::AcquireSlot()
+    {
+        if (freeSlots_.empty())
+        {
+            slots_.push_back(Slot{ 0, 0 });
+            return static_cast<std::uint32_t>(slots_.size() - 1);
+        }
+        const auto slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
     }
 
-    template<typename R, typename ...Args>
-    inline void Event<R(Args...)>::operator+=(const EventHandler & handler)
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::ReleaseSlot(std::uint32_t slot)
     {
-        handlers_.push_back(handler);
+        //a new generation makes every existing handle of this slot stale.
+        ++slots_[slot].generation;
+        //the handler of the slot may be running, and the instrumentation is told when it returns,
+        //so a handler connected during the emit must not get the slot and be charged for that call.
+        if (emitDepth_ != 0)
+            releasedSlots_.push_back(slot);
+        else
+            freeSlots_.push_back(slot);
     }
 
-    template<typename R, typename ...Args>
-    inline void Event<R(Args...)>::operator+=(EventHandler && handler)
+    template<typename R, typename ...Args, typename Instrumentation>
+    inline void Event<R(Args...), Instrumentation>::Compact()
     {
-        handlers_.push_back(std::move(handler));
+        auto end = std::remove_if(handlers_.begin(), handlers_.end(), [](const Entry& entry) { return !entry.IsAlive(); });
+        handlers_.erase(end, handlers_.end());
+        for (std::size_t i = 0; i < handlers_.size(); i++)
+            slots_[handlers_[i].slot].index = static_cast<std::uint32_t>(i);
+        holeCount_ = 0;
     }
 }
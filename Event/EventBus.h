@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+
+namespace cru
+{
+    namespace internal
+    {
+        //index of "T" in "Types", or sizeof...(Types) if it's not there.
+        template<typename T, typename... Types>
+        struct TypeIndex;
+
+        template<typename T>
+        struct TypeIndex<T>
+        {
+            static const std::size_t resultValue = 0;
+        };
+
+        template<typename T, typename... Rest>
+        struct TypeIndex<T, T, Rest...>
+        {
+            static const std::size_t resultValue = 0;
+        };
+
+        template<typename T, typename First, typename... Rest>
+        struct TypeIndex<T, First, Rest...>
+        {
+            static const std::size_t resultValue = 1 + TypeIndex<T, Rest...>::resultValue;
+        };
+    }
+
+    //an application wide bus of events, one for each payload type.
+    //every payload type gets a dense id at compile time, its index in "Payloads",
+    //and the events are laid out in a tuple indexed by it,
+    //so publishing goes straight to the handlers with no hashing and no RTTI.
+    //publishing or subscribing a type that is not in "Payloads" doesn't compile.
+    //
+    //  EventBus<KeyDown, MouseMove> bus;
+    //  bus.Subscribe<KeyDown>([](const KeyDown& e) { ... });
+    //  bus.Publish(KeyDown{ 'a' });
+    template<typename... Payloads>
+    class EventBus
+    {
+    public:
+        template<typename Payload>
+        using EventType = Event<void(const Payload&)>;
+
+        EventBus() = default;
+        EventBus(const EventBus&) = delete;
+        EventBus(EventBus&&) = delete;
+        EventBus& operator = (const EventBus&) = delete;
+        EventBus& operator = (EventBus&&) = delete;
+        ~EventBus() = default;
+
+        static constexpr std::size_t GetPayloadTypeCount() { return sizeof...(Payloads); }
+
+        template<typename Payload>
+        static constexpr std::size_t GetPayloadTypeId()
+        {
+            static_assert(internal::TypeIndex<Payload, Payloads...>::resultValue < sizeof...(Payloads), "The payload type is not carried by this bus.");
+            return internal::TypeIndex<Payload, Payloads...>::resultValue;
+        }
+
+        template<typename Payload>
+        EventType<Payload>& GetEvent() { return std::get<GetPayloadTypeId<Payload>()>(events_); }
+        template<typename Payload>
+        const EventType<Payload>& GetEvent() const { return std::get<GetPayloadTypeId<Payload>()>(events_); }
+
+        template<typename Payload, typename Handler>
+        Connection Subscribe(Handler&& handler) { return GetEvent<Payload>().AddHandler(std::forward<Handler>(handler)); }
+
+        template<typename Payload>
+        void Publish(const Payload& payload) const { GetEvent<Payload>()(payload); }
+
+        void ClearSubscribers();
+
+    private:
+        std::tuple<EventType<Payloads>...> events_;
+    };
+
+    template<typename ...Payloads>
+    inline void EventBus<Payloads...>::ClearSubscribers()
+    {
+        using Expand = int[];
+        (void)Expand{ 0, (GetEvent<Payloads>().ClearHandlers(), 0)... };
+    }
+}
@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Event.h"
+
+namespace cru
+{
+    namespace internal
+    {
+        //log-linear buckets: below 4ns one bucket per nanosecond,
+        //then every power of two is split into 4 linear sub buckets,
+        //which keeps the relative error under 25% from nanoseconds up to about 18 minutes.
+        constexpr std::size_t latencySubBucketBits = 2;
+        constexpr std::size_t latencySubBucketCount = 1 << latencySubBucketBits;
+        constexpr std::size_t latencyMaxExponent = 40;
+        constexpr std::size_t latencyBucketCount = (latencyMaxExponent - latencySubBucketBits + 2) * latencySubBucketCount;
+
+        inline std::size_t GetHighestBit(std::uint64_t value)
+        {
+            std::size_t bit = 0;
+            while (value >>= 1)
+                bit++;
+            return bit;
+        }
+
+        inline std::size_t GetLatencyBucket(std::uint64_t nanoseconds)
+        {
+            if (nanoseconds < latencySubBucketCount)
+                return static_cast<std::size_t>(nanoseconds);
+            auto exponent = GetHighestBit(nanoseconds);
+            if (exponent > latencyMaxExponent)
+                return latencyBucketCount - 1;
+            const auto subBucket = static_cast<std::size_t>(nanoseconds >> (exponent - latencySubBucketBits)) & (latencySubBucketCount - 1);
+            return (exponent - latencySubBucketBits + 1) * latencySubBucketCount + subBucket;
+        }
+
+        //the smallest latency in nanoseconds that falls into "bucket".
+        inline std::uint64_t GetLatencyBucketLowerBound(std::size_t bucket)
+        {
+            if (bucket < latencySubBucketCount)
+                return bucket;
+            const auto exponent = bucket / latencySubBucketCount + latencySubBucketBits - 1;
+            const auto subBucket = bucket % latencySubBucketCount;
+            return (std::uint64_t(1) << exponent) + (std::uint64_t(subBucket) << (exponent - latencySubBucketBits));
+        }
+
+        //counters are split into shards, a thread always writes the same shard,
+        //so concurrent emits on different threads rarely share a cache line.
+        //the shards are summed when read.
+        //they stand in for counters per thread: threads are given the shards in turn,
+        //so up to this many emitting threads never share one, and more share them with atomic adds, still counting right.
+        //counters per thread would need every handler to find, and free, the counters of any thread that calls it,
+        //where a fixed array is found with an index.
+        constexpr std::size_t latencyShardCount = 4;
+
+        inline std::size_t GetLatencyShard()
+        {
+            static std::atomic<std::size_t> nextShard{ 0 };
+            thread_local const std::size_t shard = nextShard.fetch_add(1, std::memory_order_relaxed) % latencyShardCount;
+            return shard;
+        }
+
+        struct LatencyShard
+        {
+            std::atomic<std::uint64_t> callCount{ 0 };
+            std::atomic<std::uint64_t> slowCount{ 0 };
+            std::atomic<std::uint64_t> totalNanoseconds{ 0 };
+            std::atomic<std::uint64_t> maxNanoseconds{ 0 };
+            std::atomic<std::uint64_t> buckets[latencyBucketCount];
+            char padding[64];
+
+            LatencyShard()
+            {
+                for (auto& i : buckets)
+                    i.store(0, std::memory_order_relaxed);
+            }
+        };
+
+        struct HandlerLatency
+        {
+            bool connected = false;
+            std::string name;
+            LatencyShard shards[latencyShardCount];
+        };
+    }
+
+    //what LatencyInstrumentation knows about one handler.
+    struct HandlerLatencySnapshot
+    {
+        std::uint32_t slot;
+        std::string name;
+        std::uint64_t callCount;
+        std::uint64_t slowCount;
+        std::uint64_t totalNanoseconds;
+        std::uint64_t maxNanoseconds;
+        //pairs of bucket lower bound in nanoseconds and count, empty buckets left out.
+        std::vector<std::pair<std::uint64_t, std::uint64_t>> histogram;
+    };
+
+    //instrumentation policy of Event that measures every handler call:
+    //call count, total and max latency, and a log-linear latency histogram per handler.
+    //a call that goes over the budget is counted as slow and reported to the slow handler callback.
+    //
+    //  Event<void(int), LatencyInstrumentation> event;
+    //  auto connection = event += handler;
+    //  event.GetInstrumentation().SetHandlerName(connection.GetSlot(), "handler");
+    //  event.GetInstrumentation().SetSlowHandlerCallback(std::chrono::milliseconds(1), callback);
+    //  event.GetInstrumentation().WriteJson(std::cout);
+    class LatencyInstrumentation
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Token = Clock::time_point;
+        using SlowHandlerCallback = std::function<void(std::uint32_t slot, std::chrono::nanoseconds elapsed)>;
+
+        //the callback runs on the emitting thread right after the slow call.
+        //set it before emitting, it is not synchronized with running emits.
+        void SetSlowHandlerCallback(std::chrono::nanoseconds budget, SlowHandlerCallback callback);
+        void SetHandlerName(std::uint32_t slot, std::string name);
+
+        //can be called from any thread while the event is being emitted.
+        std::vector<HandlerLatencySnapshot> GetSnapshot() const;
+        void WriteText(std::ostream& stream) const;
+        void WriteJson(std::ostream& stream) const;
+
+        void OnConnect(std::uint32_t slot);
+        void OnDisconnect(std::uint32_t slot);
+        Token BeginCall(std::uint32_t) const { return Clock::now(); }
+        void EndCall(std::uint32_t slot, Token begin) const;
+
+    private:
+        static void WriteJsonString(std::ostream& stream, const std::string& value);
+
+        //guards the layout of handlers_ against GetSnapshot, not the counters.
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<internal::HandlerLatency>> handlers_;
+
+        std::uint64_t budgetNanoseconds_ = UINT64_MAX;
+        SlowHandlerCallback slowHandlerCallback_;
+    };
+
+    inline void LatencyInstrumentation::SetSlowHandlerCallback(std::chrono::nanoseconds budget, SlowHandlerCallback callback)
+    {
+        budgetNanoseconds_ = static_cast<std::uint64_t>(budget.count());
+        slowHandlerCallback_ = std::move(callback);
+    }
+
+    inline void LatencyInstrumentation::SetHandlerName(std::uint32_t slot, std::string name)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slot < handlers_.size() && handlers_[slot])
+            handlers_[slot]->name = std::move(name);
+    }
+
+    inline void LatencyInstrumentation::OnConnect(std::uint32_t slot)
+    {
+        //a reused slot starts over with fresh counters.
+        auto handler = std::make_unique<internal::HandlerLatency>();
+        handler->connected = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (slot >= handlers_.size())
+            handlers_.resize(slot + 1);
+        handlers_[slot] = std::move(handler);
+    }
+
+    inline void LatencyInstrumentation::OnDisconnect(std::uint32_t slot)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        handlers_[slot]->connected = false;
+    }
+
+    inline void LatencyInstrumentation::EndCall(std::uint32_t slot, Token begin) const
+    {
+        const auto elapsed = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+        //a slot never connected has nothing to count into.
+        if (slot >= handlers_.size() || !handlers_[slot])
+            return;
+        auto& shard = handlers_[slot]->shards[internal::GetLatencyShard()];
+        shard.callCount.fetch_add(1, std::memory_order_relaxed);
+        shard.totalNanoseconds.fetch_add(elapsed, std::memory_order_relaxed);
+        shard.buckets[internal::GetLatencyBucket(elapsed)].fetch_add(1, std::memory_order_relaxed);
+        auto max = shard.maxNanoseconds.load(std::memory_order_relaxed);
+        while (elapsed > max && !shard.maxNanoseconds.compare_exchange_weak(max, elapsed, std::memory_order_relaxed))
+            ;
+
+        if (elapsed > budgetNanoseconds_)
+        {
+            shard.slowCount.fetch_add(1, std::memory_order_relaxed);
+            if (slowHandlerCallback_)
+                slowHandlerCallback_(slot, std::chrono::nanoseconds(elapsed));
+        }
+    }
+
+    inline std::vector<HandlerLatencySnapshot> LatencyInstrumentation::GetSnapshot() const
+    {
+        std::vector<HandlerLatencySnapshot> result;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t slot = 0; slot < handlers_.size(); slot++)
+        {
+            const auto& handler = handlers_[slot];
+            if (!handler || !handler->connected)
+                continue;
+
+            HandlerLatencySnapshot snapshot{ static_cast<std::uint32_t>(slot), handler->name, 0, 0, 0, 0, {} };
+            std::uint64_t buckets[internal::latencyBucketCount] = {};
+            for (auto& shard : handler->shards)
+            {
+                snapshot.callCount += shard.callCount.load(std::memory_order_relaxed);
+                snapshot.slowCount += shard.slowCount.load(std::memory_order_relaxed);
+                snapshot.totalNanoseconds += shard.totalNanoseconds.load(std::memory_order_relaxed);
+                const auto max = shard.maxNanoseconds.load(std::memory_order_relaxed);
+                if (max > snapshot.maxNanoseconds)
+                    snapshot.maxNanoseconds = max;
+                for (std::size_t i = 0; i < internal::latencyBucketCount; i++)
+                    buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+            }
+            for (std::size_t i = 0; i < internal::latencyBucketCount; i++)
+                if (buckets[i] != 0)
+                    snapshot.histogram.emplace_back(internal::GetLatencyBucketLowerBound(i), buckets[i]);
+            result.push_back(std::move(snapshot));
+        }
+        return result;
+    }
+
+    inline void LatencyInstrumentation::WriteText(std::ostream& stream) const
+    {
+        for (auto& i : GetSnapshot())
+        {
+            stream << "handler " << i.slot;
+            if (!i.name.empty())
+                stream << " (" << i.name << ")";
+            stream << ": calls " << i.callCount << ", slow " << i.slowCount
+                << ", total " << i.totalNanoseconds << "ns, max " << i.maxNanoseconds << "ns, mean "
+                << (i.callCount ? i.totalNanoseconds / i.callCount : 0) << "ns\n";
+            for (auto& bucket : i.histogram)
+                stream << "    >= " << bucket.first << "ns: " << bucket.second << "\n";
+        }
+    }
+
+    inline void LatencyInstrumentation::WriteJson(std::ostream& stream) const
+    {
+        stream << "[";
+        bool first = true;
+        for (auto& i : GetSnapshot())
+        {
+            stream << (first ? "" : ",") << "{\"slot\":" << i.slot << ",\"name\":";
+            WriteJsonString(stream, i.name);
+            stream << ",\"calls\":" << i.callCount << ",\"slow\":" << i.slowCount
+                << ",\"totalNs\":" << i.totalNanoseconds << ",\"maxNs\":" << i.maxNanoseconds << ",\"histogram\":[";
+            for (std::size_t bucket = 0; bucket < i.histogram.size(); bucket++)
+                stream << (bucket ? "," : "") << "[" << i.histogram[bucket].first << "," << i.histogram[bucket].second << "]";
+            stream << "]}";
+            first = false;
+        }
+        stream << "]";
+    }
+
+    inline void LatencyInstrumentation::WriteJsonString(std::ostream& stream, const std::string& value)
+    {
+        static const char hex[] = "0123456789abcdef";
+        stream << '"';
+        for (auto c : value)
+        {
+            if (c == '"' || c == '\\')
+                stream << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20)
+                stream << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+            else
+                stream << c;
+        }
+        stream << '"';
+    }
+}
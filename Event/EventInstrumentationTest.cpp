@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Combiner.h"
+#include "EventInstrumentation.h"
+#include "Test.h"
+
+using namespace cru;
+
+namespace
+{
+    //the slots given to BeginCall and EndCall, per call.
+    struct CallRecorder : NoInstrumentation
+    {
+        using Token = std::uint32_t;
+
+        Token BeginCall(std::uint32_t slot) const { return slot; }
+        void EndCall(std::uint32_t slot, Token token) const { calls.emplace_back(token, slot); }
+
+        mutable std::vector<std::pair<std::uint32_t, std::uint32_t>> calls;
+    };
+}
+
+CRU_TEST(LatencyBucketsCoverEveryValue)
+{
+    bool covered = true;
+    for (std::uint64_t value : { 0ull, 1ull, 3ull, 4ull, 5ull, 7ull, 8ull, 100ull, 1000000ull, (1ull << 40) + 5, ~0ull })
+    {
+        const auto bucket = internal::GetLatencyBucket(value);
+        covered = covered && bucket < internal::latencyBucketCount && internal::GetLatencyBucketLowerBound(bucket) <= value;
+        if (bucket + 1 < internal::latencyBucketCount)
+            covered = covered && internal::GetLatencyBucketLowerBound(bucket + 1) > value;
+    }
+    CRU_CHECK(covered);
+}
+
+CRU_TEST(LatencyInstrumentationCountsCalls)
+{
+    Event<void(int), LatencyInstrumentation> event;
+    int slowCount = 0;
+    std::uint32_t slowSlot = 0;
+    event.GetInstrumentation().SetSlowHandlerCallback(std::chrono::milliseconds(1), [&](std::uint32_t slot, std::chrono::nanoseconds) {
+        slowCount++;
+        slowSlot = slot;
+    });
+    auto fast = event.AddHandler([](int) { });
+    auto sleepy = event.AddHandler([](int value) {
+        if (value)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    event.GetInstrumentation().SetHandlerName(sleepy.GetSlot(), "sle\"epy");
+    for (int i = 0; i < 10; i++)
+        event(0);
+    event(1);
+    CRU_CHECK(slowCount == 1 && slowSlot == sleepy.GetSlot());
+
+    auto snapshot = event.GetInstrumentation().GetSnapshot();
+    CRU_CHECK(snapshot.size() == 2);
+    CRU_CHECK(snapshot[0].callCount == 11 && snapshot[1].callCount == 11);
+    CRU_CHECK(snapshot[1].slowCount == 1 && snapshot[1].name == "sle\"epy");
+
+    std::ostringstream json;
+    event.GetInstrumentation().WriteJson(json);
+    CRU_CHECK(json.str().find("sle\\\"epy") != std::string::npos);
+
+    fast.Disconnect();
+    CRU_CHECK(event.GetInstrumentation().GetSnapshot().size() == 1);
+}
+
+//EndCall used to read the slot of the entry after the call,
+//which the handler had set to "no slot" by disconnecting itself.
+CRU_TEST(LatencyInstrumentationHandlerDisconnectsItself)
+{
+    Event<void(), LatencyInstrumentation> event;
+    Connection self;
+    self = event.AddHandler([&self]() { self.Disconnect(); });
+    auto other = event.AddHandler([]() { });
+    event();
+    CRU_CHECK(!self.IsConnected() && event.GetHandlerCount() == 1);
+    event();
+    auto snapshot = event.GetInstrumentation().GetSnapshot();
+    CRU_CHECK(snapshot.size() == 1 && snapshot[0].slot == other.GetSlot() && snapshot[0].callCount == 2);
+
+    Event<int(), LatencyInstrumentation> invoked;
+    Connection invokedSelf;
+    invokedSelf = invoked.AddHandler([&invokedSelf]() { invokedSelf.Disconnect(); return 1; });
+    CRU_CHECK(invoked.Invoke(Sum<int>()) == 1);
+    CRU_CHECK(invoked.GetHandlerCount() == 0);
+}
+
+//the same in EmitBatch, where the slot was read again for every record.
+CRU_TEST(EmitBatchHandlerDisconnectsItself)
+{
+    Event<void(int), CallRecorder> batched;
+    Connection batchedSelf;
+    batchedSelf = batched.AddHandler([&batchedSelf](int value) {
+        if (value == 2)
+            batchedSelf.Disconnect();
+    });
+    const auto selfSlot = batchedSelf.GetSlot();
+    const std::vector<Event<void(int)>::Record> records{ std::make_tuple(1), std::make_tuple(2), std::make_tuple(3) };
+    batched.EmitBatch(records);
+    const auto& calls = batched.GetInstrumentation().calls;
+    CRU_CHECK((calls == std::vector<std::pair<std::uint32_t, std::uint32_t>>{ { selfSlot, selfSlot }, { selfSlot, selfSlot } }));
+}
+
+//the slot of a handler that disconnected itself went to the handler it connected in its place,
+//which was then charged for the call still running.
+CRU_TEST(LatencyInstrumentationReplacedHandler)
+{
+    Event<void(), LatencyInstrumentation> event;
+    std::vector<std::uint32_t> slowSlots;
+    event.GetInstrumentation().SetSlowHandlerCallback(std::chrono::nanoseconds(0), [&slowSlots](std::uint32_t slot, std::chrono::nanoseconds) {
+        slowSlots.push_back(slot);
+    });
+    Connection self, replacement;
+    self = event.AddHandler([&]() {
+        self.Disconnect();
+        replacement = event.AddHandler([]() { std::this_thread::sleep_for(std::chrono::microseconds(1)); });
+        std::this_thread::sleep_for(std::chrono::microseconds(1));
+    });
+    const auto selfSlot = self.GetSlot();
+    event();
+    CRU_CHECK(replacement.IsConnected() && replacement.GetSlot() != selfSlot);
+    CRU_CHECK((slowSlots == std::vector<std::uint32_t>{ selfSlot }));
+    auto snapshot = event.GetInstrumentation().GetSnapshot();
+    CRU_CHECK(snapshot.size() == 1 && snapshot[0].slot == replacement.GetSlot() && snapshot[0].callCount == 0 && snapshot[0].slowCount == 0);
+
+    //the slot is free again after the emit.
+    const auto replacementSlot = replacement.GetSlot();
+    replacement.Disconnect();
+    auto next = event.AddHandler([]() { });
+    auto last = event.AddHandler([]() { });
+    CRU_CHECK((next.GetSlot() == selfSlot && last.GetSlot() == replacementSlot) || (next.GetSlot() == replacementSlot && last.GetSlot() == selfSlot));
+    event();
+    snapshot = event.GetInstrumentation().GetSnapshot();
+    CRU_CHECK(snapshot.size() == 2 && snapshot[0].callCount == 1 && snapshot[1].callCount == 1);
+}
+
+CRU_TEST(LatencyInstrumentationIgnoresUnknownSlot)
+{
+    LatencyInstrumentation instrumentation;
+    instrumentation.EndCall(0, instrumentation.BeginCall(0));
+    instrumentation.EndCall(0xFFFFFFFF, instrumentation.BeginCall(0xFFFFFFFF));
+    CRU_CHECK(instrumentation.GetSnapshot().empty());
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+
+namespace cru
+{
+    //what EventQueue::Enqueue does when the queue is full.
+    enum class BackpressurePolicy
+    {
+        Block,      //wait until the consumer makes room.
+        DropOldest, //throw away the oldest queued item to make room.
+        DropNewest  //throw away the item being enqueued.
+    };
+
+    struct EventQueueStatistics
+    {
+        std::uint64_t enqueued;
+        std::uint64_t dropped;
+        std::uint64_t dispatched;
+    };
+
+    template<typename >
+    class EventQueue;
+
+    //defers the emit of an Event.
+    //any number of threads enqueue arguments into a bounded lock-free ring buffer,
+    //and one consumer thread drains it and emits the event with them.
+    //arguments are moved into the ring and moved out of it, never copied.
+    //
+    //the ring is the bounded queue of Dmitry Vyukov: every cell carries a sequence number
+    //telling whether it is ready to be written or read in the current lap.
+    //it permits several readers, which DropOldest relies on
+    //since a producer may pop the oldest item itself.
+    template<typename R, typename... Args>
+    class EventQueue<R(Args...)>
+    {
+    public:
+        using ValueType = std::tuple<typename std::decay<Args>::type...>;
+
+        //capacity is rounded up to a power of two, and to 2 at least.
+        EventQueue(Event<R(Args...)>& event, std::size_t capacity, BackpressurePolicy policy = BackpressurePolicy::Block);
+        EventQueue(const EventQueue&) = delete;
+        EventQueue(EventQueue&&) = delete;
+        EventQueue& operator = (const EventQueue&) = delete;
+        EventQueue& operator = (EventQueue&&) = delete;
+        ~EventQueue();
+
+        //can be called from any thread.
+        //return false if the item is dropped because of DropNewest.
+        template<typename... T>
+        bool Enqueue(T&&... args);
+
+        //must be called from the single consumer thread.
+        //emit the event for at most "maxCount" queued items and return how many were emitted.
+        std::size_t Dispatch(std::size_t maxCount = std::numeric_limits<std::size_t>::max());
+
+        std::size_t GetCapacity() const { return mask_ + 1; }
+        BackpressurePolicy GetPolicy() const { return policy_; }
+        EventQueueStatistics GetStatistics() const;
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;
+            typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type storage;
+
+            ValueType* Get() { return reinterpret_cast<ValueType*>(&storage); }
+        };
+
+        template<typename... T>
+        bool TryEnqueue(T&&... args);
+        //move the oldest item out and hand it to "consume".
+        template<typename Consumer>
+        bool TryDequeue(Consumer&& consume);
+
+        template<std::size_t... Indexes>
+        void Emit(ValueType& value, std::index_sequence<Indexes...>) { event_(std::move(std::get<Indexes>(value))...); }
+
+        static std::size_t GetCellCount(std::size_t capacity);
+
+        Event<R(Args...)>& event_;
+        const BackpressurePolicy policy_;
+        const std::size_t mask_;
+        Cell* const cells_;
+
+        //producers and consumer hammer on different positions, keep them on different cache lines.
+        char padding0_[64];
+        std::atomic<std::size_t> enqueuePosition_{ 0 };
+        std::atomic<std::uint64_t> enqueued_{ 0 };
+        std::atomic<std::uint64_t> dropped_{ 0 };
+        char padding1_[64];
+        std::atomic<std::size_t> dequeuePosition_{ 0 };
+        std::atomic<std::uint64_t> dispatched_{ 0 };
+        char padding2_[64];
+    };
+
+    template<typename R, typename ...Args>
+    inline EventQueue<R(Args...)>::EventQueue(Event<R(Args...)>& event, std::size_t capacity, BackpressurePolicy policy)
+        : event_(event), policy_(policy), mask_(GetCellCount(capacity) - 1), cells_(new Cell[mask_ + 1])
+    {
+        for (std::size_t i = 0; i <= mask_; i++)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    template<typename R, typename ...Args>
+    inline EventQueue<R(Args...)>::~EventQueue()
+    {
+        while (TryDequeue([](ValueType&) { }))
+            ;
+        delete[] cells_;
+    }
+
+    template<typename R, typename ...Args>
+    template<typename ...T>
+    inline bool EventQueue<R(Args...)>::Enqueue(T&&... args)
+    {
+        while (!TryEnqueue(std::forward<T>(args)...))
+        {
+            switch (policy_)
+            {
+            case BackpressurePolicy::Block:
+                std::this_thread::yield();
+                break;
+            case BackpressurePolicy::DropOldest:
+                if (TryDequeue([](ValueType&) { }))
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case BackpressurePolicy::DropNewest:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        enqueued_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    template<typename R, typename ...Args>
+    inline std::size_t EventQueue<R(Args...)>::Dispatch(std::size_t maxCount)
+    {
+        std::size_t count = 0;
+        while (count < maxCount && TryDequeue([this](ValueType& value) { Emit(value, std::index_sequence_for<Args...>()); }))
+            count++;
+        dispatched_.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
+    template<typename R, typename ...Args>
+    inline EventQueueStatistics EventQueue<R(Args...)>::GetStatistics() const
+    {
+        return EventQueueStatistics{
+            enqueued_.load(std::memory_order_relaxed),
+            dropped_.load(std::memory_order_relaxed),
+            dispatched_.load(std::memory_order_relaxed)
+        };
+    }
+
+    template<typename R, typename ...Args>
+    template<typename ...T>
+    inline bool EventQueue<R(Args...)>::TryEnqueue(T&&... args)
+    {
+        auto position = enqueuePosition_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = cells_[position & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    ::new (static_cast<void*>(&cell.storage)) ValueType(std::forward<T>(args)...);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; //full
+            else
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+    }
+
+    template<typename R, typename ...Args>
+    template<typename Consumer>
+    inline bool EventQueue<R(Args...)>::TryDequeue(Consumer&& consume)
+    {
+        auto position = dequeuePosition_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            auto& cell = cells_[position & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    //release the cell before consuming so producers don't wait for the handlers.
+                    ValueType value(std::move(*cell.Get()));
+                    cell.Get()->~ValueType();
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    consume(value);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; //empty
+            else
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+        }
+    }
+
+    template<typename R, typename ...Args>
+    inline std::size_t EventQueue<R(Args...)>::GetCellCount(std::size_t capacity)
+    {
+        //with a single cell, a cell full in this lap has the same sequence as one free in the next,
+        //so a producer would write over an unread item.
+        std::size_t result = 2;
+        while (result < capacity)
+            result <<= 1;
+        return result;
+    }
+}
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EventQueue.h"
+#include "Test.h"
+
+using namespace cru;
+
+CRU_TEST(EventQueueDispatchesInOrder)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    event.AddHandler([&log](int value) { log.push_back(value); });
+    EventQueue<void(int)> queue(event, 8);
+    for (int i = 0; i < 5; i++)
+        CRU_CHECK(queue.Enqueue(i));
+    CRU_CHECK(log.empty());
+    CRU_CHECK(queue.Dispatch(2) == 2);
+    CRU_CHECK(queue.Dispatch() == 3);
+    CRU_CHECK(queue.Dispatch() == 0);
+    CRU_CHECK(log == std::vector<int>{ 0, 1, 2, 3, 4 });
+    const auto statistics = queue.GetStatistics();
+    CRU_CHECK(statistics.enqueued == 5 && statistics.dispatched == 5 && statistics.dropped == 0);
+}
+
+CRU_TEST(EventQueueKeepsNoCopies)
+{
+    auto shared = std::make_shared<int>(3);
+    {
+        Event<void(std::shared_ptr<int>)> event;
+        long useCount = 0;
+        event.AddHandler([&useCount](std::shared_ptr<int> value) { useCount = value.use_count(); });
+        EventQueue<void(std::shared_ptr<int>)> queue(event, 4);
+        queue.Enqueue(shared);
+        CRU_CHECK(shared.use_count() == 2);
+        queue.Dispatch();
+        CRU_CHECK(shared.use_count() == 1);
+        CRU_CHECK(useCount > 1);
+
+        //items left in the queue are destroyed with it.
+        queue.Enqueue(shared);
+    }
+    CRU_CHECK(shared.use_count() == 1);
+}
+
+CRU_TEST(EventQueueCapacityIsPowerOfTwoAtLeastTwo)
+{
+    Event<void(int)> event;
+    CRU_CHECK(EventQueue<void(int)>(event, 0).GetCapacity() == 2);
+    CRU_CHECK(EventQueue<void(int)>(event, 1).GetCapacity() == 2);
+    CRU_CHECK(EventQueue<void(int)>(event, 2).GetCapacity() == 2);
+    CRU_CHECK(EventQueue<void(int)>(event, 3).GetCapacity() == 4);
+    CRU_CHECK(EventQueue<void(int)>(event, 1000).GetCapacity() == 1024);
+}
+
+CRU_TEST(EventQueueDropNewest)
+{
+    Event<void(std::string)> event;
+    std::vector<std::string> log;
+    event.AddHandler([&log](std::string value) { log.push_back(value); });
+    //asking for a single cell used to overwrite the unread item and hang the dispatch.
+    EventQueue<void(std::string)> queue(event, 1, BackpressurePolicy::DropNewest);
+    CRU_CHECK(queue.Enqueue("a"));
+    CRU_CHECK(queue.Enqueue("b"));
+    CRU_CHECK(!queue.Enqueue("c"));
+    CRU_CHECK(queue.Dispatch() == 2);
+    CRU_CHECK(log == std::vector<std::string>{ "a", "b" });
+    CRU_CHECK(queue.GetStatistics().dropped == 1);
+    CRU_CHECK(queue.Enqueue("d"));
+    queue.Dispatch();
+    CRU_CHECK(log.back() == "d");
+}
+
+CRU_TEST(EventQueueDropOldest)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    event.AddHandler([&log](int value) { log.push_back(value); });
+    EventQueue<void(int)> queue(event, 4, BackpressurePolicy::DropOldest);
+    for (int i = 0; i < 10; i++)
+        CRU_CHECK(queue.Enqueue(i));
+    queue.Dispatch();
+    CRU_CHECK(log == std::vector<int>{ 6, 7, 8, 9 });
+    const auto statistics = queue.GetStatistics();
+    CRU_CHECK(statistics.enqueued == 10 && statistics.dropped == 6 && statistics.dispatched == 4);
+}
+
+CRU_TEST(EventQueueBlockWaitsForConsumer)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    event.AddHandler([&log](int value) { log.push_back(value); });
+    EventQueue<void(int)> queue(event, 2, BackpressurePolicy::Block);
+    std::atomic<int> enqueuedCount{ 0 };
+    std::thread producer([&queue, &enqueuedCount]() {
+        for (int i = 0; i < 100; i++)
+        {
+            queue.Enqueue(i);
+            enqueuedCount++;
+        }
+    });
+    //the producer can't get more than the capacity ahead of the consumer.
+    while (enqueuedCount.load() < 2)
+        std::this_thread::yield();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CRU_CHECK(enqueuedCount.load() == 2);
+    while (log.size() < 100)
+        queue.Dispatch();
+    producer.join();
+    bool ordered = true;
+    for (int i = 0; i < 100; i++)
+        ordered = ordered && log[i] == i;
+    CRU_CHECK(ordered);
+    CRU_CHECK(queue.GetStatistics().dropped == 0);
+}
+
+CRU_TEST(EventQueueManyProducers)
+{
+    const int producerCount = 4;
+    const int itemCount = 20000;
+    Event<void(int, int)> event;
+    std::vector<int> lastOfProducer(producerCount, -1);
+    bool ordered = true;
+    event.AddHandler([&lastOfProducer, &ordered](int producer, int value) {
+        //items of one producer keep their order.
+        ordered = ordered && value == lastOfProducer[producer] + 1;
+        lastOfProducer[producer] = value;
+    });
+    EventQueue<void(int, int)> queue(event, 64);
+    std::vector<std::thread> producers;
+    for (int i = 0; i < producerCount; i++)
+        producers.emplace_back([&queue, i, itemCount]() {
+            for (int j = 0; j < itemCount; j++)
+                queue.Enqueue(i, j);
+        });
+    std::size_t dispatched = 0;
+    while (dispatched < static_cast<std::size_t>(producerCount * itemCount))
+        dispatched += queue.Dispatch(16);
+    for (auto& i : producers)
+        i.join();
+    CRU_CHECK(ordered);
+    for (int i = 0; i < producerCount; i++)
+        CRU_CHECK(lastOfProducer[i] == itemCount - 1);
+}
@@ -0,0 +1,254 @@
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "Event.h"
+#include "Test.h"
+
+using namespace cru;
+
+CRU_TEST(EventInvokesHandlersInOrder)
+{
+    Event<void(int, const std::string&)> event;
+    std::vector<std::string> log;
+    event.AddHandler([&log](int value, const std::string& text) { log.push_back("a" + std::to_string(value) + text); });
+    event += [&log](int value, const std::string& text) { log.push_back("b" + std::to_string(value) + text); };
+    event(1, "x");
+    CRU_CHECK(log == std::vector<std::string>{ "a1x", "b1x" });
+}
+
+CRU_TEST(EventReturnsLastResult)
+{
+    Event<int(int)> event;
+    event.AddHandler([](int value) { return value + 1; });
+    event.AddHandler([](int value) { return value * 10; });
+    CRU_CHECK(event(2) == 20);
+}
+
+CRU_TEST(ConnectionDisconnects)
+{
+    Event<void()> event;
+    int count = 0;
+    auto connection = event.AddHandler([&count]() { count++; });
+    CRU_CHECK(connection.IsConnected());
+    CRU_CHECK(event.GetHandlerCount() == 1);
+    connection.Disconnect();
+    CRU_CHECK(!connection.IsConnected());
+    CRU_CHECK(event.GetHandlerCount() == 0);
+    event();
+    CRU_CHECK(count == 0);
+    //disconnecting again, or through a copy, does nothing.
+    connection.Disconnect();
+    CRU_CHECK(event.GetHandlerCount() == 0);
+}
+
+CRU_TEST(StaleConnectionIgnoresReusedSlot)
+{
+    Event<void()> event;
+    int first = 0, second = 0;
+    auto stale = event.AddHandler([&first]() { first++; });
+    auto copy = stale;
+    stale.Disconnect();
+
+    //the new handler takes the freed slot, with a new generation.
+    auto fresh = event.AddHandler([&second]() { second++; });
+    CRU_CHECK(fresh.GetSlot() == copy.GetSlot());
+    CRU_CHECK(!copy.IsConnected());
+    copy.Disconnect();
+    CRU_CHECK(fresh.IsConnected());
+    event();
+    CRU_CHECK(first == 0 && second == 1);
+}
+
+CRU_TEST(ScopedConnectionDisconnectsWhenDestroyed)
+{
+    Event<void()> event;
+    int count = 0;
+    {
+        ScopedConnection scoped = event.AddHandler([&count]() { count++; });
+        event();
+    }
+    event();
+    CRU_CHECK(count == 1);
+
+    Connection released;
+    {
+        ScopedConnection scoped = event.AddHandler([&count]() { count++; });
+        ScopedConnection moved(std::move(scoped));
+        CRU_CHECK(!scoped.IsConnected() && moved.IsConnected());
+        released = moved.Release();
+    }
+    CRU_CHECK(released.IsConnected());
+    event();
+    CRU_CHECK(count == 2);
+}
+
+CRU_TEST(EventCompactsKeepingOrder)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    std::vector<Connection> connections;
+    for (int i = 0; i < 8; i++)
+        connections.push_back(event.AddHandler([&log, i](int) { log.push_back(i); }));
+    for (int i = 0; i < 8; i += 2)
+        connections[i].Disconnect();
+    connections[1].Disconnect();
+    event(0);
+    CRU_CHECK(log == std::vector<int>{ 3, 5, 7 });
+    for (int i = 3; i < 8; i += 2)
+        CRU_CHECK(connections[i].IsConnected());
+    event.ClearHandlers();
+    CRU_CHECK(event.GetHandlerCount() == 0 && !connections[3].IsConnected());
+}
+
+CRU_TEST(DisconnectDuringEmit)
+{
+    Event<void()> event;
+    std::vector<int> log;
+    Connection self, other;
+    self = event.AddHandler([&]() {
+        log.push_back(1);
+        self.Disconnect();
+        other.Disconnect();
+    });
+    other = event.AddHandler([&log]() { log.push_back(2); });
+    event.AddHandler([&log]() { log.push_back(3); });
+    //a handler disconnected by an earlier one is not invoked by the running emit.
+    event();
+    CRU_CHECK(log == std::vector<int>{ 1, 3 });
+    CRU_CHECK(!self.IsConnected() && !other.IsConnected());
+    CRU_CHECK(event.GetHandlerCount() == 1);
+    log.clear();
+    event();
+    CRU_CHECK(log == std::vector<int>{ 3 });
+}
+
+CRU_TEST(AddDuringEmitWaitsForTheNextEmit)
+{
+    Event<void()> event;
+    std::vector<int> log;
+    Connection added;
+    event.AddHandler([&]() {
+        log.push_back(1);
+        if (!added.IsConnected())
+        {
+            added = event.AddHandler([&log]() { log.push_back(2); });
+            //the pending handler is already connected.
+            CRU_CHECK(added.IsConnected());
+        }
+    });
+    event();
+    CRU_CHECK(log == std::vector<int>{ 1 });
+    CRU_CHECK(event.GetHandlerCount() == 2);
+    log.clear();
+    event();
+    CRU_CHECK(log == std::vector<int>{ 1, 2 });
+}
+
+CRU_TEST(DisconnectPendingHandlerDuringEmit)
+{
+    Event<void()> event;
+    int count = 0;
+    event.AddHandler([&]() {
+        auto connection = event.AddHandler([&count]() { count++; });
+        connection.Disconnect();
+        CRU_CHECK(!connection.IsConnected());
+    });
+    event();
+    event();
+    CRU_CHECK(count == 0);
+    CRU_CHECK(event.GetHandlerCount() == 1);
+}
+
+CRU_TEST(ClearHandlersDuringEmit)
+{
+    Event<void()> event;
+    std::vector<int> log;
+    event.AddHandler([&]() {
+        log.push_back(1);
+        event.ClearHandlers();
+        event.AddHandler([&log]() { log.push_back(3); });
+    });
+    event.AddHandler([&log]() { log.push_back(2); });
+    event();
+    CRU_CHECK(log == std::vector<int>{ 1 });
+    CRU_CHECK(event.GetHandlerCount() == 1);
+    log.clear();
+    event();
+    CRU_CHECK(log == std::vector<int>{ 3 });
+}
+
+CRU_TEST(NestedEmit)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    Connection first;
+    first = event.AddHandler([&](int depth) {
+        log.push_back(depth * 10 + 1);
+        //disconnected in the nested emit, but the outer one has already run it.
+        if (depth == 1)
+            first.Disconnect();
+    });
+    event.AddHandler([&](int depth) {
+        log.push_back(depth * 10 + 2);
+        if (depth < 2)
+            event(depth + 1);
+    });
+    event(0);
+    CRU_CHECK(log == std::vector<int>{ 1, 2, 11, 12, 22 });
+    CRU_CHECK(event.GetHandlerCount() == 1);
+}
+
+CRU_TEST(HandlerDestructorMayChangeTheEvent)
+{
+    Event<void()> event;
+    auto connection = std::make_shared<ScopedConnection>();
+    *connection = event.AddHandler([]() { });
+    //destroying this handler disconnects the first one from within Disconnect.
+    auto owner = event.AddHandler([connection]() { });
+    connection.reset();
+    owner.Disconnect();
+    CRU_CHECK(event.GetHandlerCount() == 0);
+    event();
+}
+
+CRU_TEST(EmitBatchRunsEachHandlerOverTheWholeBatch)
+{
+    Event<void(int, const std::string&)> event;
+    std::vector<std::string> log;
+    event.AddHandler([&log](int value, const std::string& text) { log.push_back("a" + std::to_string(value) + text); });
+    event.AddHandler([&log](int value, const std::string& text) { log.push_back("b" + std::to_string(value) + text); });
+    const std::vector<Event<void(int, const std::string&)>::Record> records{ std::make_tuple(1, "x"), std::make_tuple(2, "y") };
+    event.EmitBatch(records);
+    CRU_CHECK((log == std::vector<std::string>{ "a1x", "a2y", "b1x", "b2y" }));
+    log.clear();
+    event.EmitBatch(records.data(), 0);
+    CRU_CHECK(log.empty());
+}
+
+CRU_TEST(ChangesDuringEmitBatch)
+{
+    Event<void(int)> event;
+    std::vector<int> log;
+    Connection self;
+    //stops at the record it disconnects itself in.
+    self = event.AddHandler([&](int value) {
+        log.push_back(value);
+        if (value == 2)
+            self.Disconnect();
+    });
+    //the handler added waits for the next emit.
+    event.AddHandler([&](int value) {
+        log.push_back(10 + value);
+        if (value == 1)
+            event.AddHandler([&log](int added) { log.push_back(100 + added); });
+    });
+    const std::vector<Event<void(int)>::Record> records{ std::make_tuple(1), std::make_tuple(2), std::make_tuple(3) };
+    event.EmitBatch(records);
+    CRU_CHECK((log == std::vector<int>{ 1, 2, 11, 12, 13 }));
+    CRU_CHECK(!self.IsConnected() && event.GetHandlerCount() == 2);
+    log.clear();
+    event.EmitBatch(records.data(), 1);
+    CRU_CHECK((log == std::vector<int>{ 11, 101 }));
+}
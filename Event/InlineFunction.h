@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cru
+{
+    //inline capacity (in bytes) of InlineFunction when not specified.
+    //callables not bigger than it are stored in place, bigger ones go to the heap.
+    constexpr std::size_t defaultInlineFunctionSize = 4 * sizeof(void*);
+
+    template<typename, std::size_t = defaultInlineFunctionSize>
+    class InlineFunction;
+
+    namespace internal
+    {
+        template<typename F, typename = void>
+        struct HasBoolOperator : std::false_type { };
+        template<typename F>
+        struct HasBoolOperator<F, decltype(void(&F::operator bool))> : std::true_type { };
+
+        //whether a callable is empty: a null function or member pointer, or an object testing false, like an empty std::function.
+        //a lambda converts to a function pointer and so to bool too, but has no operator bool and is never empty.
+        template<typename F>
+        bool IsEmptyCallable(const F& function, std::true_type) { return !function; }
+        template<typename F>
+        bool IsEmptyCallable(const F&, std::false_type) { return false; }
+
+        template<typename F>
+        bool IsEmptyCallable(const F& function)
+        {
+            using Testable = std::integral_constant<bool, std::is_pointer<F>::value || std::is_member_pointer<F>::value || HasBoolOperator<F>::value>;
+            return IsEmptyCallable(function, Testable());
+        }
+    }
+
+    //a move-only type-erased callable with small buffer optimization.
+    //unlike std::function, the inline capacity is fixed and known,
+    //so storing a small lambda never allocates.
+    //an empty callable, like a null function pointer or an empty std::function, leaves it empty.
+    template<typename R, typename... Args, std::size_t InlineSize>
+    class InlineFunction<R(Args...), InlineSize>
+    {
+    public:
+        InlineFunction() = default;
+
+        template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+        InlineFunction(F&& function) { Emplace(std::forward<F>(function)); }
+
+        InlineFunction(const InlineFunction&) = delete;
+        InlineFunction(InlineFunction&& other) noexcept { MoveFrom(other); }
+        InlineFunction& operator = (const InlineFunction&) = delete;
+        InlineFunction& operator = (InlineFunction&& other) noexcept;
+        ~InlineFunction() { Reset(); }
+
+        R operator()(Args... args) const { return invoke_(const_cast<Storage&>(storage_), std::forward<Args>(args)...); }
+
+        explicit operator bool() const { return invoke_ != nullptr; }
+
+        //whether the callable lives in the inline buffer.
+        bool IsInline() const { return manager_ != nullptr && manager_(Operation::IsInline, nullptr, nullptr); }
+
+        void Reset();
+
+    private:
+        union Storage
+        {
+            void* heap;
+            typename std::aligned_storage<InlineSize, alignof(std::max_align_t)>::type buffer;
+        };
+
+        enum class Operation { Move, Destroy, IsInline };
+
+        using Invoker = R(*)(Storage&, Args&&...);
+        using Manager = bool(*)(Operation, Storage*, Storage*);
+
+        template<typename F>
+        struct UseInline
+        {
+            static const bool value = sizeof(F) <= InlineSize && alignof(std::max_align_t) % alignof(F) == 0 && std::is_nothrow_move_constructible<F>::value;
+        };
+
+        template<typename F>
+        static F* Get(Storage& storage, std::true_type) { return reinterpret_cast<F*>(&storage.buffer); }
+        template<typename F>
+        static F* Get(Storage& storage, std::false_type) { return static_cast<F*>(storage.heap); }
+
+        template<typename F>
+        static R Call(F& function, std::false_type, Args&&... args) { return function(std::forward<Args>(args)...); }
+        template<typename F>
+        static R Call(F& function, std::true_type, Args&&... args) { return std::mem_fn(function)(std::forward<Args>(args)...); }
+
+        template<typename F>
+        static R Invoke(Storage& storage, Args&&... args)
+        {
+            return Call(*Get<F>(storage, std::integral_constant<bool, UseInline<F>::value>()), std::is_member_pointer<F>(), std::forward<Args>(args)...);
+        }
+
+        template<typename F>
+        static bool Manage(Operation operation, Storage* destination, Storage* source);
+
+        template<typename F>
+        void Emplace(F&& function);
+
+        void MoveFrom(InlineFunction& other) noexcept;
+
+        Invoker invoke_ = nullptr;
+        Manager manager_ = nullptr;
+        Storage storage_;
+    };
+
+    template<typename R, typename... Args, std::size_t InlineSize>
+    inline InlineFunction<R(Args...), InlineSize>& InlineFunction<R(Args...), InlineSize>::operator = (InlineFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    template<typename R, typename... Args, std::size_t InlineSize>
+    inline void InlineFunction<R(Args...), InlineSize>::Reset()
+    {
+        if (manager_)
+            manager_(Operation::Destroy, &storage_, nullptr);
+        invoke_ = nullptr;
+        manager_ = nullptr;
+    }
+
+    template<typename R, typename... Args, std::size_t InlineSize>
+    template<typename F>
+    inline bool InlineFunction<R(Args...), InlineSize>::Manage(Operation operation, Storage* destination, Storage* source)
+    {
+        const bool isInline = UseInline<F>::value;
+        switch (operation)
+        {
+        case Operation::Move:
+            if (isInline)
+            {
+                F* from = Get<F>(*source, std::true_type());
+                ::new (static_cast<void*>(&destination->buffer)) F(std::move(*from));
+                from->~F();
+            }
+            else
+                destination->heap = source->heap;
+            break;
+        case Operation::Destroy:
+            if (isInline)
+                Get<F>(*destination, std::true_type())->~F();
+            else
+                delete Get<F>(*destination, std::false_type());
+            break;
+        case Operation::IsInline:
+            break;
+        }
+        return isInline;
+    }
+
+    template<typename R, typename... Args, std::size_t InlineSize>
+    template<typename F>
+    inline void InlineFunction<R(Args...), InlineSize>::Emplace(F&& function)
+    {
+        using Function = typename std::decay<F>::type;
+        if (internal::IsEmptyCallable<Function>(function))
+            return;
+        if (UseInline<Function>::value)
+            ::new (static_cast<void*>(&storage_.buffer)) Function(std::forward<F>(function));
+        else
+            storage_.heap = new Function(std::forward<F>(function));
+        invoke_ = &Invoke<Function>;
+        manager_ = &Manage<Function>;
+    }
+
+    template<typename R, typename... Args, std::size_t InlineSize>
+    inline void InlineFunction<R(Args...), InlineSize>::MoveFrom(InlineFunction& other) noexcept
+    {
+        if (other.manager_)
+            other.manager_(Operation::Move, &storage_, &other.storage_);
+        invoke_ = other.invoke_;
+        manager_ = other.manager_;
+        other.invoke_ = nullptr;
+        other.manager_ = nullptr;
+    }
+}
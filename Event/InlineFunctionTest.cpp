@@ -0,0 +1,86 @@
+#include <functional>
+#include <memory>
+
+#include "Event.h"
+#include "InlineFunction.h"
+#include "Test.h"
+
+using namespace cru;
+
+namespace
+{
+    struct Counter
+    {
+        int Add(int value) { return count += value; }
+        int count = 0;
+    };
+
+    struct Tester
+    {
+        explicit operator bool() const { return valid; }
+        void operator()(int) const { }
+        bool valid;
+    };
+
+    void DoNothing(int) { }
+}
+
+CRU_TEST(InlineFunctionStoresSmallAndBigCallables)
+{
+    int sum = 0;
+    InlineFunction<void(int)> small([&sum](int value) { sum += value; });
+    CRU_CHECK(small.IsInline());
+    small(2);
+
+    char padding[64] = { };
+    InlineFunction<void(int)> big([&sum, padding](int value) { sum += value + padding[0]; });
+    CRU_CHECK(!big.IsInline());
+    big(3);
+
+    InlineFunction<void(int)> moved(std::move(big));
+    CRU_CHECK(!big && moved);
+    moved(4);
+    CRU_CHECK(sum == 9);
+}
+
+CRU_TEST(InlineFunctionMoveOnlyCallable)
+{
+    auto pointer = std::make_unique<int>(7);
+    InlineFunction<int()> function([pointer = std::move(pointer)]() { return *pointer; });
+    InlineFunction<int()> other;
+    other = std::move(function);
+    CRU_CHECK(!function);
+    CRU_CHECK(other() == 7);
+}
+
+CRU_TEST(InlineFunctionCallsMemberPointers)
+{
+    Counter counter;
+    InlineFunction<int(Counter&, int)> add(&Counter::Add);
+    InlineFunction<int&(Counter&)> count(&Counter::count);
+    CRU_CHECK(add(counter, 5) == 5);
+    CRU_CHECK(count(counter) == 5);
+}
+
+CRU_TEST(InlineFunctionStaysEmptyForEmptyCallables)
+{
+    CRU_CHECK(!InlineFunction<void(int)>(static_cast<void(*)(int)>(nullptr)));
+    CRU_CHECK(!InlineFunction<int(Counter&, int)>(static_cast<int (Counter::*)(int)>(nullptr)));
+    CRU_CHECK(!InlineFunction<void(int)>(std::function<void(int)>()));
+    CRU_CHECK(!InlineFunction<void(int)>(Tester{ false }));
+    CRU_CHECK(!InlineFunction<void(int)>(InlineFunction<void(int), 64>()));
+
+    CRU_CHECK(InlineFunction<void(int)>(&DoNothing));
+    CRU_CHECK(InlineFunction<void(int)>(std::function<void(int)>(&DoNothing)));
+    CRU_CHECK(InlineFunction<void(int)>(Tester{ true }));
+    CRU_CHECK(InlineFunction<void(int)>([](int) { }));
+}
+
+CRU_TEST(EventIgnoresEmptyHandlers)
+{
+    Event<void(int)> event;
+    CRU_CHECK(!event.AddHandler(static_cast<void(*)(int)>(nullptr)).IsConnected());
+    CRU_CHECK(!event.AddHandler(std::function<void(int)>()).IsConnected());
+    CRU_CHECK(event.GetHandlerCount() == 0);
+    event(1);
+}
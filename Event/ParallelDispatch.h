@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+#include "ThreadPool.h"
+
+namespace cru
+{
+    //events with no more handlers than this are emitted sequentially by the parallel dispatchers.
+    constexpr std::size_t defaultMinChunkSize = 16;
+
+    namespace internal
+    {
+        //keep a parameter out of template argument deduction.
+        template<typename T>
+        struct NonDeduced
+        {
+            using Type = T;
+        };
+
+        template<typename Tuple, typename F, std::size_t... Indexes>
+        void ApplyTuple(Tuple& tuple, F&& function, std::index_sequence<Indexes...>)
+        {
+            function(std::get<Indexes>(tuple)...);
+        }
+
+        //state shared by the chunks of one parallel emit.
+        //the first exception thrown by any handler is kept and the others are dropped.
+        struct ParallelDispatchState
+        {
+            std::atomic<std::size_t> remaining{ 0 };
+            std::mutex exceptionMutex;
+            std::exception_ptr exception;
+
+            void Fail()
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+        };
+
+        //what ParallelInvokeAsync shares with its chunks: the copied arguments, the promise,
+        //and the emit scope of the event, left before the promise is fulfilled.
+        //the last chunk resumes the coroutines waiting for the emit, unless a handler threw, as an emit does.
+        template<typename EventType, typename... Values>
+        struct ParallelDispatchAsyncState : ParallelDispatchState
+        {
+            template<typename... T>
+            ParallelDispatchAsyncState(const EventType& event, T&&... args)
+                : event(event), scope(new EventAccess::EmitScope<EventType>(event)), arguments(std::forward<T>(args)...) { }
+
+            const EventType& event;
+            std::unique_ptr<EventAccess::EmitScope<EventType>> scope;
+            std::tuple<Values...> arguments;
+            std::promise<void> promise;
+
+            //called by every chunk, the last one fulfills the promise.
+            void Finish()
+            {
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    return;
+                assert(!EventAccess::HasPendingOperations(event) && "handlers must not change an event emitted in parallel.");
+                if (!exception)
+                {
+                    try
+                    {
+                        ApplyTuple(arguments, [this](auto&... values) { EventAccess::ResumeWaiters(event, values...); }, std::index_sequence_for<Values...>());
+                    }
+                    catch (...)
+                    {
+                        Fail();
+                    }
+                }
+                scope.reset();
+                if (exception)
+                    promise.set_exception(exception);
+                else
+                    promise.set_value();
+            }
+        };
+
+        template<typename Entries, typename Instrumentation, typename... Args>
+        void InvokeChunk(const Entries& entries, const Instrumentation& instrumentation, std::size_t begin, std::size_t end, ParallelDispatchState& state, Args&... args)
+        {
+            try
+            {
+                for (auto i = begin; i < end; i++)
+                {
+                    auto& entry = entries[i];
+                    if (!entry.IsAlive())
+                        continue;
+                    const auto slot = entry.slot;
+                    const auto token = instrumentation.BeginCall(slot);
+                    entry.handler(args...);
+                    instrumentation.EndCall(slot, token);
+                }
+            }
+            catch (...)
+            {
+                state.Fail();
+            }
+        }
+
+        //split "count" handlers into chunks no smaller than "minChunkSize",
+        //a few per worker so that stealing can even out uneven handlers.
+        inline std::size_t GetChunkSize(std::size_t count, std::size_t threadCount, std::size_t minChunkSize)
+        {
+            const auto targetChunkCount = threadCount * 4;
+            return std::max(std::max<std::size_t>(minChunkSize, 1), (count + targetChunkCount - 1) / targetChunkCount);
+        }
+    }
+
+    //emit "event" with its handlers split into chunks that run on "pool".
+    //the calling thread runs a chunk too and helps with the pool's work while waiting,
+    //so it's fine to call it from inside the pool.
+    //return after every chunk finishes, and rethrow the first exception thrown by a handler.
+    //events with no more handlers than "minChunkSize" are emitted sequentially on the calling thread.
+    //handlers run concurrently, so they must not race with each other,
+    //and neither they nor anyone else may change the event until this returns, which debug builds assert.
+    //like any emit, it must not overlap with another emit of the same event on another thread.
+    //the instrumentation of the event sees every call, from the thread running it,
+    //so it must take concurrent calls, as LatencyInstrumentation does.
+    //coroutines waiting for the emit are resumed on the calling thread once every chunk has finished.
+    template<typename R, typename... Args, typename Instrumentation>
+    void ParallelInvoke(ThreadPool& pool, const Event<R(Args...), Instrumentation>& event, std::size_t minChunkSize, typename internal::NonDeduced<Args>::Type... args)
+    {
+        const auto& entries = internal::EventAccess::GetEntries(event);
+        const auto count = entries.size();
+        if (count <= minChunkSize || pool.GetThreadCount() == 0)
+        {
+            event(args...);
+            return;
+        }
+
+        const auto chunkSize = internal::GetChunkSize(count, pool.GetThreadCount(), minChunkSize);
+        const auto chunkCount = (count + chunkSize - 1) / chunkSize;
+        const auto& instrumentation = event.GetInstrumentation();
+
+        //keep the handler array where it is even if a handler breaks the rule above.
+        internal::EventAccess::EmitScope<Event<R(Args...), Instrumentation>> scope(event);
+        internal::ParallelDispatchState state;
+        state.remaining.store(chunkCount - 1);
+        for (std::size_t chunk = 1; chunk < chunkCount; chunk++)
+        {
+            const auto begin = chunk * chunkSize;
+            const auto end = std::min(begin + chunkSize, count);
+            pool.Submit([&entries, &instrumentation, begin, end, &state, &args...]()
+            {
+                internal::InvokeChunk(entries, instrumentation, begin, end, state, args...);
+                state.remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        internal::InvokeChunk(entries, instrumentation, 0, chunkSize, state, args...);
+        while (state.remaining.load(std::memory_order_acquire) != 0)
+            if (!pool.RunPendingTask())
+                std::this_thread::yield();
+        assert(!internal::EventAccess::HasPendingOperations(event) && "handlers must not change an event emitted in parallel.");
+
+        if (state.exception)
+            std::rethrow_exception(state.exception);
+        internal::EventAccess::ResumeWaiters(event, args...);
+    }
+
+    template<typename R, typename... Args, typename Instrumentation>
+    void ParallelInvoke(ThreadPool& pool, const Event<R(Args...), Instrumentation>& event, typename internal::NonDeduced<Args>::Type... args)
+    {
+        ParallelInvoke<R, Args...>(pool, event, defaultMinChunkSize, std::forward<Args>(args)...);
+    }
+
+    //like ParallelInvoke, but return at once with a future that becomes ready when every chunk finishes.
+    //the arguments are copied into the shared state, as the chunks may outlive the call.
+    //the event must not be changed, emitted or destroyed until the future is ready.
+    //coroutines waiting for the emit are resumed before that, on the pool thread that finishes the last chunk.
+    template<typename R, typename... Args, typename Instrumentation>
+    std::future<void> ParallelInvokeAsync(ThreadPool& pool, const Event<R(Args...), Instrumentation>& event, std::size_t minChunkSize, typename internal::NonDeduced<Args>::Type... args)
+    {
+        using State = internal::ParallelDispatchAsyncState<Event<R(Args...), Instrumentation>, typename std::decay<Args>::type...>;
+
+        const auto& entries = internal::EventAccess::GetEntries(event);
+        const auto count = entries.size();
+        const auto chunkSize = count <= minChunkSize ? std::max<std::size_t>(count, 1) : internal::GetChunkSize(count, pool.GetThreadCount(), minChunkSize);
+        const auto chunkCount = std::max<std::size_t>((count + chunkSize - 1) / chunkSize, 1);
+
+        const auto& instrumentation = event.GetInstrumentation();
+
+        auto state = std::make_shared<State>(event, std::forward<Args>(args)...);
+        auto future = state->promise.get_future();
+        state->remaining.store(chunkCount);
+        for (std::size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            const auto begin = chunk * chunkSize;
+            const auto end = std::min(begin + chunkSize, count);
+            pool.Submit([&entries, &instrumentation, begin, end, state]()
+            {
+                internal::ApplyTuple(state->arguments, [&](auto&... arguments)
+                {
+                    internal::InvokeChunk(entries, instrumentation, begin, end, *state, arguments...);
+                }, std::index_sequence_for<Args...>());
+                state->Finish();
+            });
+        }
+        return future;
+    }
+
+    template<typename R, typename... Args, typename Instrumentation>
+    std::future<void> ParallelInvokeAsync(ThreadPool& pool, const Event<R(Args...), Instrumentation>& event, typename internal::NonDeduced<Args>::Type... args)
+    {
+        return ParallelInvokeAsync<R, Args...>(pool, event, defaultMinChunkSize, std::forward<Args>(args)...);
+    }
+}
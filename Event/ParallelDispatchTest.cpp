@@ -0,0 +1,142 @@
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "EventInstrumentation.h"
+#include "ParallelDispatch.h"
+#include "Test.h"
+
+using namespace cru;
+
+namespace
+{
+    const std::size_t handlerCount = 300;
+
+    //count the calls of every handler, to check each one runs exactly once per emit.
+    template<typename EventType>
+    std::shared_ptr<std::vector<std::atomic<int>>> AddCountingHandlers(EventType& event)
+    {
+        auto counts = std::make_shared<std::vector<std::atomic<int>>>(handlerCount);
+        for (std::size_t i = 0; i < handlerCount; i++)
+            event.AddHandler([counts, i](int value, const std::string& text) { (*counts)[i] += value + static_cast<int>(text.size()); });
+        return counts;
+    }
+
+    bool AllEqual(const std::vector<std::atomic<int>>& counts, int expected)
+    {
+        for (auto& i : counts)
+            if (i.load() != expected)
+                return false;
+        return true;
+    }
+}
+
+CRU_TEST(ParallelInvokeCallsEveryHandlerOnce)
+{
+    ThreadPool pool(4);
+    Event<void(int, const std::string&)> event;
+    auto counts = AddCountingHandlers(event);
+    ParallelInvoke(pool, event, 2, 1, std::string("ab"));
+    CRU_CHECK(AllEqual(*counts, 3));
+    ParallelInvoke(pool, event, 1, std::string());
+    CRU_CHECK(AllEqual(*counts, 4));
+    //too few handlers for the chunk size, emitted sequentially.
+    ParallelInvoke(pool, event, handlerCount, 1, std::string());
+    CRU_CHECK(AllEqual(*counts, 5));
+
+    //the event is settled again afterwards.
+    int added = 0;
+    event.AddHandler([&added](int, const std::string&) { added++; });
+    CRU_CHECK(event.GetHandlerCount() == handlerCount + 1);
+    ParallelInvoke(pool, event, 2, 0, std::string());
+    CRU_CHECK(added == 1);
+}
+
+CRU_TEST(ParallelInvokeAsyncCallsEveryHandlerOnce)
+{
+    ThreadPool pool(4);
+    Event<void(int, const std::string&)> event;
+    auto counts = AddCountingHandlers(event);
+    std::string text("abc");
+    auto future = ParallelInvokeAsync(pool, event, 2, 1, text);
+    //the arguments were copied.
+    text.clear();
+    future.get();
+    CRU_CHECK(AllEqual(*counts, 4));
+    ParallelInvokeAsync(pool, event, handlerCount, 1, std::string()).get();
+    CRU_CHECK(AllEqual(*counts, 5));
+
+    Event<void(int, const std::string&)> empty;
+    ParallelInvokeAsync(pool, empty, 0, std::string()).get();
+    empty.AddHandler([](int, const std::string&) { });
+    CRU_CHECK(empty.GetHandlerCount() == 1);
+}
+
+CRU_TEST(ParallelInvokeRethrowsHandlerException)
+{
+    ThreadPool pool(4);
+    Event<void(int, const std::string&)> event;
+    auto counts = AddCountingHandlers(event);
+    event.AddHandler([](int, const std::string&) { throw std::runtime_error("handler"); });
+
+    bool thrown = false;
+    try
+    {
+        ParallelInvoke(pool, event, 2, 0, std::string());
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CRU_CHECK(thrown);
+
+    thrown = false;
+    try
+    {
+        ParallelInvokeAsync(pool, event, 2, 0, std::string()).get();
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CRU_CHECK(thrown);
+}
+
+CRU_TEST(ParallelInvokeInsideThePool)
+{
+    ThreadPool pool(2);
+    Event<void()> outer;
+    std::vector<std::unique_ptr<Event<void(int, const std::string&)>>> inners;
+    std::vector<std::shared_ptr<std::vector<std::atomic<int>>>> counts;
+    for (int i = 0; i < 40; i++)
+    {
+        inners.push_back(std::make_unique<Event<void(int, const std::string&)>>());
+        counts.push_back(AddCountingHandlers(*inners.back()));
+        auto inner = inners.back().get();
+        outer.AddHandler([&pool, inner]() { ParallelInvoke(pool, *inner, 4, 1, std::string()); });
+    }
+    ParallelInvoke(pool, outer, 1);
+    bool allCalled = true;
+    for (auto& i : counts)
+        allCalled = allCalled && AllEqual(*i, 1);
+    CRU_CHECK(allCalled);
+}
+
+CRU_TEST(ParallelInvokeReportsToInstrumentation)
+{
+    ThreadPool pool(4);
+    Event<void(int, const std::string&), LatencyInstrumentation> event;
+    auto counts = AddCountingHandlers(event);
+    ParallelInvoke(pool, event, 2, 1, std::string());
+    ParallelInvokeAsync(pool, event, 2, 1, std::string()).get();
+    CRU_CHECK(AllEqual(*counts, 2));
+
+    const auto snapshot = event.GetInstrumentation().GetSnapshot();
+    CRU_CHECK(snapshot.size() == handlerCount);
+    bool allCounted = true;
+    for (auto& i : snapshot)
+        allCounted = allCounted && i.callCount == 2;
+    CRU_CHECK(allCounted);
+}
@@ -0,0 +1,616 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "Event.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace cru
+{
+    enum class SharedEventChannelError
+    {
+        None,
+        CannotOpen,      //the shared memory can't be created or opened.
+        CannotMap,       //it can't be sized or mapped.
+        InvalidFormat,   //it isn't a channel, or its publisher hasn't finished creating it.
+        PayloadMismatch  //the channel carries arguments of another size.
+    };
+
+    struct SharedEventChannelStatistics
+    {
+        std::uint64_t received; //messages emitted into the local event.
+        std::uint64_t lost;     //messages overwritten by the publisher before they were read.
+    };
+
+    namespace internal
+    {
+        //a named shared memory segment: shm_open and mmap on POSIX, a file mapping backed by the paging file on Windows.
+        class SharedMemorySegment
+        {
+        public:
+            SharedMemorySegment() = default;
+            SharedMemorySegment(const SharedMemorySegment&) = delete;
+            SharedMemorySegment& operator = (const SharedMemorySegment&) = delete;
+            ~SharedMemorySegment() { Close(); }
+
+            //create a zeroed segment of "size" bytes, replacing one left behind by a process that died.
+            SharedEventChannelError Create(const char* name, std::size_t size);
+            SharedEventChannelError Open(const char* name);
+            void Close();
+
+            void* GetData() const { return data_; }
+            std::size_t GetSize() const { return size_; }
+
+        private:
+            void* data_ = nullptr;
+            std::size_t size_ = 0;
+#ifdef _WIN32
+            HANDLE mapping_ = nullptr;
+#else
+            //only the creator removes the name, and processes that opened it keep their mapping.
+            char name_[256] = {};
+#endif
+        };
+
+#ifdef _WIN32
+        inline SharedEventChannelError SharedMemorySegment::Create(const char* name, std::size_t size)
+        {
+            Close();
+            const auto large = static_cast<unsigned long long>(size);
+            mapping_ = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(large >> 32), static_cast<DWORD>(large & 0xFFFFFFFF), name);
+            if (mapping_ == nullptr)
+                return SharedEventChannelError::CannotOpen;
+            data_ = ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size);
+            if (data_ == nullptr)
+            {
+                Close();
+                return SharedEventChannelError::CannotMap;
+            }
+            //a mapping that already existed keeps its old content.
+            std::memset(data_, 0, size);
+            size_ = size;
+            return SharedEventChannelError::None;
+        }
+
+        inline SharedEventChannelError SharedMemorySegment::Open(const char* name)
+        {
+            Close();
+            mapping_ = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+            if (mapping_ == nullptr)
+                return SharedEventChannelError::CannotOpen;
+            data_ = ::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+            MEMORY_BASIC_INFORMATION information;
+            if (data_ == nullptr || ::VirtualQuery(data_, &information, sizeof(information)) == 0)
+            {
+                Close();
+                return SharedEventChannelError::CannotMap;
+            }
+            size_ = information.RegionSize;
+            return SharedEventChannelError::None;
+        }
+
+        inline void SharedMemorySegment::Close()
+        {
+            if (data_)
+                ::UnmapViewOfFile(data_);
+            if (mapping_)
+                ::CloseHandle(mapping_);
+            data_ = nullptr;
+            size_ = 0;
+            mapping_ = nullptr;
+        }
+#else
+        inline SharedEventChannelError SharedMemorySegment::Create(const char* name, std::size_t size)
+        {
+            Close();
+            if (std::strlen(name) >= sizeof(name_))
+                return SharedEventChannelError::CannotOpen;
+            ::shm_unlink(name);
+            const auto file = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (file < 0)
+                return SharedEventChannelError::CannotOpen;
+            std::strcpy(name_, name);
+            //a new segment reads as zeros.
+            if (::ftruncate(file, static_cast<off_t>(size)) != 0)
+            {
+                ::close(file);
+                Close();
+                return SharedEventChannelError::CannotMap;
+            }
+            const auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            ::close(file);
+            if (data == MAP_FAILED)
+            {
+                Close();
+                return SharedEventChannelError::CannotMap;
+            }
+            data_ = data;
+            size_ = size;
+            return SharedEventChannelError::None;
+        }
+
+        inline SharedEventChannelError SharedMemorySegment::Open(const char* name)
+        {
+            Close();
+            const auto file = ::shm_open(name, O_RDWR, 0);
+            if (file < 0)
+                return SharedEventChannelError::CannotOpen;
+            struct stat status;
+            if (::fstat(file, &status) != 0 || status.st_size == 0)
+            {
+                ::close(file);
+                return SharedEventChannelError::CannotMap;
+            }
+            const auto size = static_cast<std::size_t>(status.st_size);
+            const auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            ::close(file);
+            if (data == MAP_FAILED)
+                return SharedEventChannelError::CannotMap;
+            data_ = data;
+            size_ = size;
+            return SharedEventChannelError::None;
+        }
+
+        inline void SharedMemorySegment::Close()
+        {
+            if (data_)
+                ::munmap(data_, size_);
+            if (name_[0] != '\0')
+                ::shm_unlink(name_);
+            data_ = nullptr;
+            size_ = 0;
+            name_[0] = '\0';
+        }
+#endif
+
+        //block while "*word" is "expected", for at most "timeout", unless woken by WakeAllOnSharedWord.
+        //it may return early for no reason, so the caller checks again.
+        //Linux waits on a futex shared between processes, elsewhere this sleeps a little and lets the caller check.
+        inline void WaitOnSharedWord(std::atomic<std::uint32_t>* word, std::uint32_t expected, std::chrono::nanoseconds timeout)
+        {
+#ifdef __linux__
+            struct timespec time;
+            time.tv_sec = static_cast<std::time_t>(timeout.count() / 1000000000);
+            time.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAIT, expected, &time, nullptr, 0);
+#else
+            if (word->load(std::memory_order_acquire) == expected)
+                std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(100)));
+#endif
+        }
+
+        inline void WakeAllOnSharedWord(std::atomic<std::uint32_t>* word)
+        {
+#ifdef __linux__
+            ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), FUTEX_WAKE, 0x7FFFFFFF, nullptr, nullptr, 0);
+#else
+            (void)word;
+#endif
+        }
+
+        //the beginning of the segment, followed by the ring of cells.
+        //everything is in fixed size types and atomics that are lock-free, so every process sees the same layout.
+        struct SharedChannelHeader
+        {
+            static const std::uint32_t currentVersion = 1;
+
+            //set last by the publisher with release, so a subscriber reads the rest only after seeing it.
+            std::atomic<std::uint32_t> version;
+            std::uint32_t payloadSize;
+            std::uint32_t capacity;
+            std::uint32_t cellSize;
+
+            //number of the last message written completely, counted from 1.
+            alignas(64) std::atomic<std::uint64_t> published;
+            std::atomic<std::uint32_t> closed;
+
+            //the futex word, bumped when there are waiters to wake.
+            alignas(64) std::atomic<std::uint32_t> wakeCount;
+            std::atomic<std::uint32_t> waiterCount;
+        };
+
+        //a message of "wordCount" 64-bit words under a sequence number, as a seqlock:
+        //2n - 1 while message n is written into the cell and 2n once it is complete.
+        //a reader copies the words and checks the number didn't change meanwhile.
+        //the words are relaxed atomics, so a read racing with a write is well defined and only discarded.
+        template<std::size_t wordCount>
+        struct alignas(64) SharedChannelCell
+        {
+            std::atomic<std::uint64_t> sequence;
+            std::atomic<std::uint64_t> words[wordCount];
+        };
+
+        //the arguments of an emit as one trivially copyable struct, which std::tuple isn't.
+        template<typename... T>
+        struct SharedChannelPayload
+        {
+            template<typename Function, typename... Taken>
+            void Apply(Function& function, Taken&... taken) { function(taken...); }
+            void Store() { }
+        };
+
+        template<typename T, typename... Rest>
+        struct SharedChannelPayload<T, Rest...>
+        {
+            //the arguments taken so far are appended to the ones still in the payload.
+            template<typename Function, typename... Taken>
+            void Apply(Function& function, Taken&... taken) { rest.Apply(function, taken..., first); }
+
+            template<typename U, typename... Others>
+            void Store(U&& value, Others&&... others)
+            {
+                first = std::forward<U>(value);
+                rest.Store(std::forward<Others>(others)...);
+            }
+
+            T first;
+            SharedChannelPayload<Rest...> rest;
+        };
+
+        template<typename ValueType>
+        struct SharedChannelLayout
+        {
+            static_assert(std::is_trivially_copyable<ValueType>::value, "The arguments of a shared event channel must be trivially copyable.");
+            static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "A shared event channel needs lock-free atomics.");
+
+            static const std::size_t wordCount = (sizeof(ValueType) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+            using Cell = SharedChannelCell<wordCount>;
+            static const std::size_t cellOffset = (sizeof(SharedChannelHeader) + alignof(Cell) - 1) / alignof(Cell) * alignof(Cell);
+
+            static std::size_t GetSize(std::size_t capacity) { return cellOffset + capacity * sizeof(Cell); }
+            static SharedChannelHeader* GetHeader(void* data) { return static_cast<SharedChannelHeader*>(data); }
+            static Cell* GetCells(void* data) { return reinterpret_cast<Cell*>(static_cast<char*>(data) + cellOffset); }
+        };
+    }
+
+    template<typename >
+    class SharedEventPublisher;
+
+    template<typename >
+    class SharedEventSubscriber;
+
+    //the producing side of an event shared by the processes of a host.
+    //it owns a named shared memory segment holding a ring of messages, each one the arguments of an emit,
+    //and every SharedEventSubscriber that opens the name emits its own local Event with each of them.
+    //
+    //there is one publisher per channel and it never waits for the subscribers:
+    //a subscriber that falls a whole ring behind loses the oldest messages and counts them,
+    //which it finds out from the sequence numbers of the cells.
+    //the arguments are copied into the ring byte for byte, so they must be trivially copyable,
+    //and a pointer in them means nothing in another process.
+    //
+    //  SharedEventPublisher<void(int, double)> publisher;
+    //  publisher.Create("/prices", 4096);
+    //  publisher.Publish(7, 99.5);
+    //
+    //the name is a POSIX shared memory name such as "/prices", or a file mapping name such as "Local\\prices" on Windows.
+    //the segment goes away with the publisher, though subscribers that have it open keep their view of it.
+    template<typename... Args>
+    class SharedEventPublisher<void(Args...)>
+    {
+    public:
+        SharedEventPublisher() = default;
+        SharedEventPublisher(const SharedEventPublisher&) = delete;
+        SharedEventPublisher& operator = (const SharedEventPublisher&) = delete;
+        ~SharedEventPublisher() { Close(); }
+
+        //capacity is rounded up to a power of two.
+        SharedEventChannelError Create(const char* name, std::size_t capacity);
+        //wake up the subscribers, which see the channel closed once they've read everything, and remove it.
+        void Close();
+        bool IsOpen() const { return header_ != nullptr; }
+
+        //must be called from one thread at a time. it never blocks.
+        template<typename... T>
+        void Publish(T&&... args);
+
+    private:
+        using ValueType = internal::SharedChannelPayload<typename std::decay<Args>::type...>;
+        using Layout = internal::SharedChannelLayout<ValueType>;
+
+        internal::SharedMemorySegment segment_;
+        internal::SharedChannelHeader* header_ = nullptr;
+        typename Layout::Cell* cells_ = nullptr;
+        std::uint64_t mask_ = 0;
+        std::uint64_t sequence_ = 0;
+    };
+
+    //the consuming side of a channel made by SharedEventPublisher, in any process of the host.
+    //it emits "event" with the arguments of every message published after Open, in order,
+    //on the thread that calls Dispatch; nothing happens behind its back.
+    //
+    //  Event<void(int, double)> prices;
+    //  SharedEventSubscriber<void(int, double)> subscriber(prices);
+    //  subscriber.Open("/prices");
+    //  while (subscriber.Wait(std::chrono::seconds(1)) || !subscriber.IsClosed())
+    //      subscriber.Dispatch();
+    //
+    //open it after the publisher has created the channel: a name left behind by a publisher that died
+    //still opens, but nothing is ever published into it again.
+    //
+    //Wait spins on the count of published messages for a while before it sleeps, which is what keeps the latency low.
+    //the spin adapts: it grows while messages keep arriving during it and shrinks while they don't,
+    //so an idle subscriber soon goes to sleep at once, on a futex shared with the publisher on Linux.
+    template<typename... Args>
+    class SharedEventSubscriber<void(Args...)>
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        explicit SharedEventSubscriber(Event<void(Args...)>& event) : event_(event) { }
+        SharedEventSubscriber(const SharedEventSubscriber&) = delete;
+        SharedEventSubscriber& operator = (const SharedEventSubscriber&) = delete;
+        ~SharedEventSubscriber() = default;
+
+        SharedEventChannelError Open(const char* name);
+        void Close();
+        bool IsOpen() const { return header_ != nullptr; }
+        //whether the publisher has closed the channel and every message it published is read or lost.
+        bool IsClosed() const;
+
+        //wait at most "timeout" for a message, return whether there is one to dispatch.
+        bool Wait(Clock::duration timeout);
+
+        //emit the event for at most "maxCount" messages that are already published and return how many were emitted.
+        std::size_t Dispatch(std::size_t maxCount = std::numeric_limits<std::size_t>::max());
+
+        SharedEventChannelStatistics GetStatistics() const { return SharedEventChannelStatistics{ received_, lost_ }; }
+
+    private:
+        using ValueType = internal::SharedChannelPayload<typename std::decay<Args>::type...>;
+        using Layout = internal::SharedChannelLayout<ValueType>;
+
+        enum class ReadResult
+        {
+            Read,
+            NotPublished,
+            Overrun
+        };
+
+        static const std::uint32_t minSpinCount = 16;
+        static const std::uint32_t maxSpinCount = 1 << 14;
+
+        bool IsPublished() const { return header_->published.load(std::memory_order_acquire) >= next_; }
+        ReadResult TryRead(ValueType& value);
+
+
+        Event<void(Args...)>& event_;
+        internal::SharedMemorySegment segment_;
+        internal::SharedChannelHeader* header_ = nullptr;
+        typename Layout::Cell* cells_ = nullptr;
+        std::uint64_t mask_ = 0;
+        //number of the next message to read.
+        std::uint64_t next_ = 0;
+        std::uint32_t spinCount_ = minSpinCount;
+        std::uint64_t received_ = 0;
+        std::uint64_t lost_ = 0;
+    };
+
+    template<typename ...Args>
+    inline SharedEventChannelError SharedEventPublisher<void(Args...)>::Create(const char* name, std::size_t capacity)
+    {
+        Close();
+        std::size_t roundedCapacity = 1;
+        while (roundedCapacity < capacity)
+            roundedCapacity <<= 1;
+        const auto error = segment_.Create(name, Layout::GetSize(roundedCapacity));
+        if (error != SharedEventChannelError::None)
+            return error;
+
+        //the segment is zeroed, which is a valid state for every atomic in it.
+        const auto header = Layout::GetHeader(segment_.GetData());
+        header->payloadSize = static_cast<std::uint32_t>(sizeof(ValueType));
+        header->capacity = static_cast<std::uint32_t>(roundedCapacity);
+        header->cellSize = static_cast<std::uint32_t>(sizeof(typename Layout::Cell));
+        header->version.store(internal::SharedChannelHeader::currentVersion, std::memory_order_release);
+
+        header_ = header;
+        cells_ = Layout::GetCells(segment_.GetData());
+        mask_ = roundedCapacity - 1;
+        sequence_ = 0;
+        return SharedEventChannelError::None;
+    }
+
+    template<typename ...Args>
+    inline void SharedEventPublisher<void(Args...)>::Close()
+    {
+        if (header_)
+        {
+            header_->closed.store(1, std::memory_order_release);
+            header_->wakeCount.fetch_add(1, std::memory_order_release);
+            internal::WakeAllOnSharedWord(&header_->wakeCount);
+        }
+        segment_.Close();
+        header_ = nullptr;
+        cells_ = nullptr;
+    }
+
+    template<typename ...Args>
+    template<typename ...T>
+    inline void SharedEventPublisher<void(Args...)>::Publish(T&&... args)
+    {
+        //value-initialized, so not even the padding carries garbage to other processes.
+        ValueType value = ValueType();
+        value.Store(std::forward<T>(args)...);
+        std::uint64_t words[Layout::wordCount] = {};
+        std::memcpy(words, &value, sizeof(ValueType));
+
+        const auto sequence = ++sequence_;
+        auto& cell = cells_[(sequence - 1) & mask_];
+        cell.sequence.store(sequence * 2 - 1, std::memory_order_relaxed);
+        //no word may be seen before the cell is marked as being written.
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < Layout::wordCount; i++)
+            cell.words[i].store(words[i], std::memory_order_relaxed);
+        cell.sequence.store(sequence * 2, std::memory_order_release);
+        header_->published.store(sequence, std::memory_order_release);
+
+        //pairs with the fence in Wait: either the waiter sees the message, or this sees the waiter.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (header_->waiterCount.load(std::memory_order_relaxed) != 0)
+        {
+            header_->wakeCount.fetch_add(1, std::memory_order_release);
+            internal::WakeAllOnSharedWord(&header_->wakeCount);
+        }
+    }
+
+    template<typename ...Args>
+    inline SharedEventChannelError SharedEventSubscriber<void(Args...)>::Open(const char* name)
+    {
+        Close();
+        const auto error = segment_.Open(name);
+        if (error != SharedEventChannelError::None)
+            return error;
+
+        const auto header = Layout::GetHeader(segment_.GetData());
+        if (segment_.GetSize() < sizeof(internal::SharedChannelHeader)
+            || header->version.load(std::memory_order_acquire) != internal::SharedChannelHeader::currentVersion
+            || header->capacity == 0 || (header->capacity & (header->capacity - 1)) != 0
+            || segment_.GetSize() < Layout::GetSize(header->capacity))
+        {
+            segment_.Close();
+            return SharedEventChannelError::InvalidFormat;
+        }
+        if (header->payloadSize != sizeof(ValueType) || header->cellSize != sizeof(typename Layout::Cell))
+        {
+            segment_.Close();
+            return SharedEventChannelError::PayloadMismatch;
+        }
+
+        header_ = header;
+        cells_ = Layout::GetCells(segment_.GetData());
+        mask_ = header->capacity - 1;
+        next_ = header->published.load(std::memory_order_acquire) + 1;
+        return SharedEventChannelError::None;
+    }
+
+    template<typename ...Args>
+    inline void SharedEventSubscriber<void(Args...)>::Close()
+    {
+        segment_.Close();
+        header_ = nullptr;
+        cells_ = nullptr;
+    }
+
+    template<typename ...Args>
+    inline bool SharedEventSubscriber<void(Args...)>::IsClosed() const
+    {
+        //"closed" is stored after the last message is published.
+        return header_ == nullptr || (header_->closed.load(std::memory_order_acquire) != 0 && !IsPublished());
+    }
+
+    template<typename ...Args>
+    inline bool SharedEventSubscriber<void(Args...)>::Wait(Clock::duration timeout)
+    {
+        if (header_ == nullptr)
+            return false;
+        if (IsPublished())
+            return true;
+
+        for (std::uint32_t i = 0; i < spinCount_; i++)
+            if (IsPublished())
+            {
+                spinCount_ = spinCount_ < maxSpinCount ? spinCount_ * 2 : spinCount_;
+                return true;
+            }
+        spinCount_ = spinCount_ > minSpinCount ? spinCount_ / 2 : spinCount_;
+
+        const auto deadline = Clock::now() + timeout;
+        header_->waiterCount.fetch_add(1, std::memory_order_relaxed);
+        for (;;)
+        {
+            const auto wakeCount = header_->wakeCount.load(std::memory_order_acquire);
+            //pairs with the fence in Publish.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (IsPublished() || header_->closed.load(std::memory_order_acquire) != 0)
+                break;
+            const auto now = Clock::now();
+            if (now >= deadline)
+                break;
+            internal::WaitOnSharedWord(&header_->wakeCount, wakeCount, deadline - now);
+        }
+        header_->waiterCount.fetch_sub(1, std::memory_order_relaxed);
+        return IsPublished();
+    }
+
+    template<typename ...Args>
+    inline std::size_t SharedEventSubscriber<void(Args...)>::Dispatch(std::size_t maxCount)
+    {
+        if (header_ == nullptr)
+            return 0;
+        std::size_t count = 0;
+        ValueType value;
+        while (count < maxCount)
+        {
+            const auto result = TryRead(value);
+            if (result == ReadResult::NotPublished)
+                break;
+            if (result == ReadResult::Overrun)
+            {
+                //skip to the oldest message the ring still holds, and go on from there.
+                const auto published = header_->published.load(std::memory_order_acquire);
+                const auto oldest = published > mask_ ? published - mask_ : 1;
+                const auto skipped = std::max(oldest, next_ + 1) - next_;
+                lost_ += skipped;
+                next_ += skipped;
+                continue;
+            }
+            next_++;
+            received_++;
+            count++;
+            value.Apply(event_);
+        }
+        return count;
+    }
+
+    template<typename ...Args>
+    inline typename SharedEventSubscriber<void(Args...)>::ReadResult SharedEventSubscriber<void(Args...)>::TryRead(ValueType& value)
+    {
+        auto& cell = cells_[(next_ - 1) & mask_];
+        const auto expected = next_ * 2;
+        const auto sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence < expected)
+            return ReadResult::NotPublished;
+        if (sequence > expected)
+            return ReadResult::Overrun;
+
+        std::uint64_t words[Layout::wordCount];
+        for (std::size_t i = 0; i < Layout::wordCount; i++)
+            words[i] = cell.words[i].load(std::memory_order_relaxed);
+        //no word may be read after the sequence number is checked again.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (cell.sequence.load(std::memory_order_relaxed) != expected)
+            return ReadResult::Overrun;
+        std::memcpy(&value, words, sizeof(ValueType));
+        return ReadResult::Read;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Combiner.h"
+
+namespace cru
+{
+    //wrap a function as a handler type of StaticEvent.
+    //because C++14 doesn't take "auto" template parameters, use macro StaticFunctionHandler to write it.
+    template<typename FunctionPointer, FunctionPointer function>
+    struct FunctionHandler
+    {
+        template<typename... Args>
+        decltype(auto) operator()(Args&&... args) const { return function(std::forward<Args>(args)...); }
+    };
+
+    //handler type that calls a function known at compile time.
+    #define StaticFunctionHandler(function) ::cru::FunctionHandler<decltype(&function), &function>
+
+
+    template<typename, typename... >
+    class StaticEvent;
+
+    //an event whose handlers are fixed at compile time.
+    //handlers are function object types, held by value, so there is no type erasure and no heap.
+    //emitting is a sequence of direct calls the compiler can inline,
+    //while the call syntax is the same as Event<R(Args...)>.
+    //
+    //  StaticEvent<void(int), StaticFunctionHandler(OnValue), Logger> event;
+    //  auto event2 = MakeStaticEvent<void(int)>([](int) { ... }, [&](int) { ... });
+    //  event(1);
+    template<typename R, typename... Args, typename... Handlers>
+    class StaticEvent<R(Args...), Handlers...>
+    {
+    public:
+        StaticEvent() = default;
+        explicit StaticEvent(Handlers... handlers) : handlers_(std::move(handlers)...) { }
+
+        static constexpr std::size_t GetHandlerCount() { return sizeof...(Handlers); }
+
+        //invoke every handler. when R is not void, return the result of the last one (see LastValue).
+        R operator()(Args... args) const { return Emit(std::is_void<R>(), args...); }
+
+        //invoke the handlers and fold their results with "combiner" (see Combiner.h),
+        //stopping as soon as the combiner asks to.
+        template<typename Combiner>
+        auto Invoke(Combiner combiner, Args... args) const
+        {
+            InvokeFrom(std::integral_constant<std::size_t, 0>(), combiner, args...);
+            return combiner.GetResult();
+        }
+
+    private:
+        void Emit(std::true_type, Args&... args) const { Emit(std::index_sequence_for<Handlers...>(), args...); }
+        R Emit(std::false_type, Args&... args) const { return Invoke(LastValue<R>(), args...); }
+
+        template<std::size_t... Indexes>
+        void Emit(std::index_sequence<Indexes...>, Args&... args) const
+        {
+            using Expand = int[];
+            (void)Expand{ 0, (std::get<Indexes>(handlers_)(args...), 0)... };
+        }
+
+        template<typename Combiner>
+        void InvokeFrom(std::integral_constant<std::size_t, sizeof...(Handlers)>, Combiner&, Args&...) const { }
+
+        template<std::size_t Index, typename Combiner>
+        void InvokeFrom(std::integral_constant<std::size_t, Index>, Combiner& combiner, Args&... args) const
+        {
+            if (combiner.Combine(std::get<Index>(handlers_)(args...)))
+                InvokeFrom(std::integral_constant<std::size_t, Index + 1>(), combiner, args...);
+        }
+
+        //mutable as Event can call mutable handlers from its const operator() too.
+        mutable std::tuple<Handlers...> handlers_;
+    };
+
+    template<typename Signature, typename... Handlers>
+    StaticEvent<Signature, typename std::decay<Handlers>::type...> MakeStaticEvent(Handlers&&... handlers)
+    {
+        return StaticEvent<Signature, typename std::decay<Handlers>::type...>(std::forward<Handlers>(handlers)...);
+    }
+}
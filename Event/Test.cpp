@@ -1,13 +1,18 @@
-#include <iostream>
+#include <cstdio>
 
-#include "Event.h"
+#include "Test.h"
 
-using namespace cru;
-using namespace std;
+using namespace cru::test;
 
+//run every test, and exit with a failure if any check failed.
 int main()
 {
-    getchar();
-
-    return 0;
+    for (auto& testCase : GetTestCases())
+    {
+        const auto failureCount = GetFailureCount();
+        testCase.function();
+        std::printf("%s %s\n", GetFailureCount() == failureCount ? "passed" : "FAILED", testCase.name);
+    }
+    std::printf("%zu tests, %zu failed checks\n", GetTestCases().size(), GetFailureCount());
+    return GetFailureCount() == 0 ? 0 : 1;
 }
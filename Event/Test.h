@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace cru
+{
+    namespace test
+    {
+        //a test registered by CRU_TEST, run by the main in Test.cpp.
+        struct TestCase
+        {
+            const char* name;
+            void (*function)();
+        };
+
+        inline std::vector<TestCase>& GetTestCases()
+        {
+            static std::vector<TestCase> testCases;
+            return testCases;
+        }
+
+        inline std::size_t& GetFailureCount()
+        {
+            static std::size_t failureCount = 0;
+            return failureCount;
+        }
+
+        inline void ReportFailure(const char* file, int line, const char* expression)
+        {
+            std::printf("%s(%d): check failed: %s\n", file, line, expression);
+            ++GetFailureCount();
+        }
+
+        struct TestRegistrar
+        {
+            TestRegistrar(const char* name, void (*function)()) { GetTestCases().push_back(TestCase{ name, function }); }
+        };
+    }
+}
+
+//define a test function, registered to run with every other one.
+#define CRU_TEST(name) \
+    static void name(); \
+    static const ::cru::test::TestRegistrar name##Registrar(#name, &name); \
+    static void name()
+
+//report the failure and go on with the test.
+#define CRU_CHECK(...) \
+    do { if (!(__VA_ARGS__)) ::cru::test::ReportFailure(__FILE__, __LINE__, #__VA_ARGS__); } while (false)
@@ -0,0 +1,186 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "InlineFunction.h"
+
+namespace cru
+{
+    //a fixed size pool of worker threads with work stealing.
+    //every worker owns a deque: it pushes and pops its own tasks at the back,
+    //and idle workers steal from the front of the others'.
+    //tasks submitted from outside the pool are spread over the deques round robin.
+    class ThreadPool
+    {
+    public:
+        using Task = InlineFunction<void()>;
+
+        //0 means one worker per hardware thread.
+        explicit ThreadPool(std::size_t threadCount = 0);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+        ThreadPool& operator = (ThreadPool&&) = delete;
+        ~ThreadPool();
+
+        std::size_t GetThreadCount() const { return workers_.size(); }
+
+        void Submit(Task task);
+
+        //run one pending task on the calling thread if there is any.
+        //a thread waiting for tasks it submitted should help with this instead of blocking.
+        bool RunPendingTask();
+
+    private:
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        bool PopLocal(std::size_t index, Task& task);
+        bool Steal(std::size_t thief, Task& task);
+        void Run(std::size_t index);
+
+        //index of the worker running on this thread in this pool, or -1.
+        std::size_t CurrentWorker() const;
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<std::size_t> nextWorker_{ 0 };
+        std::atomic<std::size_t> pendingCount_{ 0 };
+        std::atomic<bool> stop_{ false };
+
+        std::mutex sleepMutex_;
+        std::condition_variable sleepCondition_;
+    };
+
+    namespace internal
+    {
+        struct ThreadPoolWorkerIdentity
+        {
+            const ThreadPool* pool;
+            std::size_t index;
+        };
+
+        inline ThreadPoolWorkerIdentity& CurrentThreadPoolWorker()
+        {
+            thread_local ThreadPoolWorkerIdentity identity{ nullptr, 0 };
+            return identity;
+        }
+    }
+
+    inline ThreadPool::ThreadPool(std::size_t threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        for (std::size_t i = 0; i < threadCount; i++)
+            workers_.push_back(std::make_unique<Worker>());
+        for (std::size_t i = 0; i < threadCount; i++)
+            workers_[i]->thread = std::thread([this, i]() { Run(i); });
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_.store(true);
+        }
+        sleepCondition_.notify_all();
+        for (auto& i : workers_)
+            i->thread.join();
+    }
+
+    inline void ThreadPool::Submit(Task task)
+    {
+        auto index = CurrentWorker();
+        if (index == static_cast<std::size_t>(-1))
+            index = nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+        pendingCount_.fetch_add(1);
+        {
+            //take the lock so a worker can't miss the notification between checking and sleeping.
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+        }
+        sleepCondition_.notify_one();
+    }
+
+    inline bool ThreadPool::RunPendingTask()
+    {
+        Task task;
+        const auto index = CurrentWorker();
+        if (index != static_cast<std::size_t>(-1) ? !PopLocal(index, task) && !Steal(index, task) : !Steal(workers_.size(), task))
+            return false;
+        task();
+        return true;
+    }
+
+    inline bool ThreadPool::PopLocal(std::size_t index, Task& task)
+    {
+        auto& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+            return false;
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        pendingCount_.fetch_sub(1);
+        return true;
+    }
+
+    inline bool ThreadPool::Steal(std::size_t thief, Task& task)
+    {
+        const auto count = workers_.size();
+        for (std::size_t i = 1; i <= count; i++)
+        {
+            const auto victim = (thief + i) % count;
+            if (victim == thief)
+                continue;
+            auto& worker = *workers_[victim];
+            std::unique_lock<std::mutex> lock(worker.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || worker.tasks.empty())
+                continue;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            pendingCount_.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    inline void ThreadPool::Run(std::size_t index)
+    {
+        internal::CurrentThreadPoolWorker() = internal::ThreadPoolWorkerIdentity{ this, index };
+        while (true)
+        {
+            Task task;
+            if (PopLocal(index, task) || Steal(index, task))
+            {
+                task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            if (stop_.load())
+                return;
+            if (pendingCount_.load() == 0)
+                sleepCondition_.wait(lock);
+        }
+    }
+
+    inline std::size_t ThreadPool::CurrentWorker() const
+    {
+        const auto& identity = internal::CurrentThreadPoolWorker();
+        return identity.pool == this ? identity.index : static_cast<std::size_t>(-1);
+    }
+}
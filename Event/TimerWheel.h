@@ -0,0 +1,325 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Event.h"
+#include "../SystemOfUnits/SystemOfUnits.h"
+
+namespace cru
+{
+    //any time quantity of SystemOfUnits, such as unit::s, unit::ms, unit::min or unit::WithRep<unit::ms, std::int64_t>.
+    template<typename MultipleFactorType, typename Rep = unit::internal::NumericType>
+    using TimeQuantity = unit::internal::Unit<unit::internal::Dimension<0, 0, 1, 0, 0, 0, 0>, MultipleFactorType, Rep>;
+
+    //identifies a timer of a TimerWheel.
+    //a default constructed handle never refers to a timer.
+    struct TimerHandle
+    {
+        std::uint32_t index = 0;
+        std::uint32_t generation = 0;
+    };
+
+    //schedules a great number of delayed and periodic timers, each of which emits an Event<void()> when it expires.
+    //
+    //time is counted in ticks of a fixed length given at construction.
+    //timers are kept in a hierarchy of wheels: the lowest one has a slot for each of the next 256 ticks,
+    //every wheel above it has slots 256 times as long as the one below,
+    //and a slot of a higher wheel is spread over the lower ones when time reaches it.
+    //so scheduling and cancelling are O(1), and a tick takes one slot and fires all of it at once.
+    //
+    //the wheel never reads a clock. the owner moves time forward with Advance,
+    //from a real clock or a simulated one, and the events are emitted on that thread.
+    //
+    //  TimerWheel wheel(unit::ms(1));
+    //  Event<void()> timeout;
+    //  timeout += []() { ... };
+    //  auto timer = wheel.Schedule(timeout, unit::s(1.5));
+    //  wheel.SchedulePeriodic(heartbeat, unit::min(1));
+    //  wheel.Advance(unit::ms(16));
+    class TimerWheel
+    {
+    public:
+        template<typename MultipleFactorType, typename Rep>
+        explicit TimerWheel(const TimeQuantity<MultipleFactorType, Rep>& tickLength);
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel(TimerWheel&&) = delete;
+        TimerWheel& operator = (const TimerWheel&) = delete;
+        TimerWheel& operator = (TimerWheel&&) = delete;
+        ~TimerWheel() = default;
+
+        //emit "event" once after "delay", rounded up to whole ticks and at least one tick.
+        //the event must outlive the timer.
+        template<typename MultipleFactorType, typename Rep>
+        TimerHandle Schedule(Event<void()>& event, const TimeQuantity<MultipleFactorType, Rep>& delay)
+        {
+            return Add(event, ToTicks(delay), 0);
+        }
+
+        //emit "event" every "period" until the timer is cancelled.
+        template<typename MultipleFactorType, typename Rep>
+        TimerHandle SchedulePeriodic(Event<void()>& event, const TimeQuantity<MultipleFactorType, Rep>& period)
+        {
+            const auto ticks = ToTicks(period);
+            return Add(event, ticks, ticks);
+        }
+
+        //return false if the timer has already expired or been cancelled.
+        //can be called from a handler, also for the timer being fired.
+        bool Cancel(TimerHandle handle);
+        bool IsPending(TimerHandle handle) const;
+
+        //move time forward by "elapsed" and fire the timers that expire on the way, tick by tick.
+        //the part of "elapsed" shorter than a tick is carried over to the next call.
+        //handlers can schedule and cancel timers, but must not call Advance.
+        template<typename MultipleFactorType, typename Rep>
+        void Advance(const TimeQuantity<MultipleFactorType, Rep>& elapsed);
+        void AdvanceTicks(std::uint64_t tickCount);
+
+        unit::s GetTickLength() const { return unit::s(tickSeconds_); }
+        std::uint64_t GetCurrentTick() const { return currentTick_; }
+        std::size_t GetPendingCount() const { return pendingCount_; }
+
+    private:
+        static const std::uint32_t none = 0xFFFFFFFF;
+        static const std::size_t slotBits = 8;
+        static const std::size_t slotCount = 1 << slotBits;
+        static const std::size_t levelCount = 4;
+        //the slot of a node that is in no list.
+        static const std::uint32_t noList = 0xFFFFFFFF;
+        //the list of timers taken out of a slot to be fired.
+        static const std::uint32_t firingList = levelCount * slotCount;
+        //durations are rounded to ticks with this much slack,
+        //so that 1.7s is 1700 ticks of 1ms even if the division comes out as 1700.0000000002.
+        static constexpr double tickTolerance = 1e-6;
+
+        struct Node
+        {
+            Event<void()>* event;
+            std::uint64_t expiry;
+            std::uint64_t period;
+            std::uint32_t previous;
+            std::uint32_t next;
+            std::uint32_t list;
+            std::uint32_t generation;
+        };
+
+        template<typename MultipleFactorType, typename Rep>
+        std::uint64_t ToTicks(const TimeQuantity<MultipleFactorType, Rep>& duration) const;
+
+        TimerHandle Add(Event<void()>& event, std::uint64_t delay, std::uint64_t period);
+        void Insert(std::uint32_t index);
+        void Link(std::uint32_t index, std::uint32_t list);
+        void Unlink(std::uint32_t index);
+        void Free(std::uint32_t index);
+        //put every timer of a slot of a higher wheel back by its expiry.
+        void Cascade(std::size_t level);
+        void Tick();
+
+        double tickSeconds_;
+        double carriedSeconds_ = 0;
+        std::uint64_t currentTick_ = 0;
+        std::size_t pendingCount_ = 0;
+
+        //nodes are pooled and linked by index, so no timer allocates once the pool is big enough.
+        std::vector<Node> nodes_;
+        std::uint32_t freeNodes_ = none;
+        //heads of the lists of every slot, then the one of firingList.
+        std::uint32_t heads_[levelCount * slotCount + 1];
+    };
+
+    template<typename MultipleFactorType, typename Rep>
+    inline TimerWheel::TimerWheel(const TimeQuantity<MultipleFactorType, Rep>& tickLength)
+        : tickSeconds_(static_cast<unit::s>(tickLength).value)
+    {
+        for (auto& i : heads_)
+            i = none;
+    }
+
+    template<typename MultipleFactorType, typename Rep>
+    inline std::uint64_t TimerWheel::ToTicks(const TimeQuantity<MultipleFactorType, Rep>& duration) const
+    {
+        const auto ticks = std::ceil(static_cast<unit::s>(duration).value / tickSeconds_ - tickTolerance);
+        if (!(ticks >= 1))
+            return 1;
+        if (ticks >= static_cast<double>(std::numeric_limits<std::uint64_t>::max() / 2))
+            return std::numeric_limits<std::uint64_t>::max() / 2;
+        return static_cast<std::uint64_t>(ticks);
+    }
+
+    template<typename MultipleFactorType, typename Rep>
+    inline void TimerWheel::Advance(const TimeQuantity<MultipleFactorType, Rep>& elapsed)
+    {
+        const auto seconds = carriedSeconds_ + static_cast<unit::s>(elapsed).value;
+        const auto ticks = std::floor(seconds / tickSeconds_ + tickTolerance);
+        if (!(ticks >= 1))
+        {
+            carriedSeconds_ = seconds > 0 ? seconds : 0;
+            return;
+        }
+        carriedSeconds_ = seconds - ticks * tickSeconds_;
+        if (carriedSeconds_ < 0)
+            carriedSeconds_ = 0;
+        AdvanceTicks(static_cast<std::uint64_t>(ticks));
+    }
+
+    inline TimerHandle TimerWheel::Add(Event<void()>& event, std::uint64_t delay, std::uint64_t period)
+    {
+        std::uint32_t index;
+        if (freeNodes_ != none)
+        {
+            index = freeNodes_;
+            freeNodes_ = nodes_[index].next;
+        }
+        else
+        {
+            index = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.push_back(Node{ nullptr, 0, 0, none, none, noList, 1 });
+        }
+
+        auto& node = nodes_[index];
+        node.event = &event;
+        node.expiry = currentTick_ + delay;
+        node.period = period;
+        Insert(index);
+        pendingCount_++;
+        return TimerHandle{ index, node.generation };
+    }
+
+    inline void TimerWheel::Insert(std::uint32_t index)
+    {
+        const auto expiry = nodes_[index].expiry;
+        const auto delta = expiry - currentTick_;
+        std::size_t level = 0;
+        while (level < levelCount - 1 && delta >= (std::uint64_t(1) << ((level + 1) * slotBits)))
+            level++;
+
+        //a timer beyond the range of the highest wheel waits in its farthest slot,
+        //and is put back by its real expiry when time reaches that slot.
+        auto position = expiry;
+        if (delta >= (std::uint64_t(1) << (levelCount * slotBits)))
+            position = currentTick_ + (std::uint64_t(1) << (levelCount * slotBits)) - 1;
+        const auto slot = (position >> (level * slotBits)) & (slotCount - 1);
+        Link(index, static_cast<std::uint32_t>(level * slotCount + slot));
+    }
+
+    inline void TimerWheel::Link(std::uint32_t index, std::uint32_t list)
+    {
+        auto& node = nodes_[index];
+        node.list = list;
+        node.previous = none;
+        node.next = heads_[list];
+        if (node.next != none)
+            nodes_[node.next].previous = index;
+        heads_[list] = index;
+    }
+
+    inline void TimerWheel::Unlink(std::uint32_t index)
+    {
+        auto& node = nodes_[index];
+        if (node.previous != none)
+            nodes_[node.previous].next = node.next;
+        else
+            heads_[node.list] = node.next;
+        if (node.next != none)
+            nodes_[node.next].previous = node.previous;
+        node.list = noList;
+    }
+
+    inline void TimerWheel::Free(std::uint32_t index)
+    {
+        auto& node = nodes_[index];
+        node.event = nullptr;
+        node.generation++;
+        node.next = freeNodes_;
+        freeNodes_ = index;
+        pendingCount_--;
+    }
+
+    inline bool TimerWheel::Cancel(TimerHandle handle)
+    {
+        if (!IsPending(handle))
+            return false;
+        Unlink(handle.index);
+        Free(handle.index);
+        return true;
+    }
+
+    inline bool TimerWheel::IsPending(TimerHandle handle) const
+    {
+        return handle.index < nodes_.size()
+            && nodes_[handle.index].generation == handle.generation
+            && nodes_[handle.index].list != noList;
+    }
+
+    inline void TimerWheel::AdvanceTicks(std::uint64_t tickCount)
+    {
+        while (tickCount != 0)
+        {
+            //nothing can fire, so skip the rest at once.
+            if (pendingCount_ == 0)
+            {
+                currentTick_ += tickCount;
+                return;
+            }
+            Tick();
+            tickCount--;
+        }
+    }
+
+    inline void TimerWheel::Cascade(std::size_t level)
+    {
+        const auto list = static_cast<std::uint32_t>(level * slotCount + ((currentTick_ >> (level * slotBits)) & (slotCount - 1)));
+        auto index = heads_[list];
+        heads_[list] = none;
+        while (index != none)
+        {
+            const auto next = nodes_[index].next;
+            Insert(index);
+            index = next;
+        }
+    }
+
+    inline void TimerWheel::Tick()
+    {
+        currentTick_++;
+
+        //when a wheel comes round, the slot of the wheel above that begins now is spread over the lower ones.
+        for (std::size_t level = 1; level < levelCount; level++)
+        {
+            if ((currentTick_ & ((std::uint64_t(1) << (level * slotBits)) - 1)) != 0)
+                break;
+            Cascade(level);
+        }
+
+        //take the whole slot at once, so timers scheduled by the handlers don't join this batch,
+        //while the ones still in it can be cancelled.
+        const auto slot = static_cast<std::uint32_t>(currentTick_ & (slotCount - 1));
+        auto index = heads_[slot];
+        heads_[slot] = none;
+        heads_[firingList] = index;
+        while (index != none)
+        {
+            nodes_[index].list = firingList;
+            index = nodes_[index].next;
+        }
+
+        while ((index = heads_[firingList]) != none)
+        {
+            Unlink(index);
+            auto& node = nodes_[index];
+            const auto event = node.event;
+            //a periodic timer is scheduled again before it fires, so its handler can cancel it.
+            if (node.period != 0)
+            {
+                node.expiry += node.period;
+                Insert(index);
+            }
+            else
+                Free(index);
+            (*event)();
+        }
+    }
+}
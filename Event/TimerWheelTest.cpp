@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "TimerWheel.h"
+#include "Test.h"
+
+using namespace cru;
+
+CRU_TEST(TimerWheelFiresAtExpiry)
+{
+    TimerWheel wheel(unit::ms(1));
+    Event<void()> event;
+    std::vector<std::uint64_t> firedAt;
+    event += [&]() { firedAt.push_back(wheel.GetCurrentTick()); };
+    wheel.Schedule(event, unit::s(1.7));
+    wheel.Schedule(event, unit::ms(3));
+    //shorter than a tick is one tick.
+    wheel.Schedule(event, unit::ms(0.1));
+    CRU_CHECK(wheel.GetPendingCount() == 3);
+    wheel.Advance(unit::ms(2.5));
+    CRU_CHECK(firedAt == std::vector<std::uint64_t>{ 1 });
+    //the half tick left over is carried to the next advance.
+    wheel.Advance(unit::ms(0.5));
+    CRU_CHECK((firedAt == std::vector<std::uint64_t>{ 1, 3 }));
+    wheel.Advance(unit::s(2));
+    CRU_CHECK((firedAt == std::vector<std::uint64_t>{ 1, 3, 1700 }));
+    CRU_CHECK(wheel.GetPendingCount() == 0);
+}
+
+CRU_TEST(TimerWheelCancel)
+{
+    TimerWheel wheel(unit::ms(1));
+    Event<void()> event;
+    int count = 0;
+    event += [&count]() { count++; };
+    auto handle = wheel.Schedule(event, unit::ms(10));
+    CRU_CHECK(wheel.Cancel(handle));
+    CRU_CHECK(!wheel.Cancel(handle));
+    CRU_CHECK(!wheel.Cancel(TimerHandle()));
+    auto fired = wheel.Schedule(event, unit::ms(5));
+    wheel.Advance(unit::ms(20));
+    CRU_CHECK(count == 1);
+    CRU_CHECK(!wheel.Cancel(fired));
+    //a stale handle does not cancel the timer that reuses its node.
+    auto reused = wheel.Schedule(event, unit::ms(5));
+    CRU_CHECK(!wheel.Cancel(handle) && !wheel.Cancel(fired));
+    wheel.Advance(unit::ms(5));
+    CRU_CHECK(count == 2 && !wheel.Cancel(reused));
+}
+
+CRU_TEST(TimerWheelPeriodic)
+{
+    TimerWheel wheel(unit::ms(1));
+    Event<void()> event;
+    std::vector<std::uint64_t> firedAt;
+    TimerHandle handle;
+    event += [&]() {
+        firedAt.push_back(wheel.GetCurrentTick());
+        //cancelling the timer being fired stops it.
+        if (firedAt.size() == 5)
+            CRU_CHECK(wheel.Cancel(handle));
+    };
+    handle = wheel.SchedulePeriodic(event, unit::s(0.25));
+    wheel.Advance(unit::min(1));
+    CRU_CHECK((firedAt == std::vector<std::uint64_t>{ 250, 500, 750, 1000, 1250 }));
+    CRU_CHECK(wheel.GetPendingCount() == 0);
+}
+
+CRU_TEST(TimerWheelScheduleFromHandler)
+{
+    TimerWheel wheel(unit::ms(1));
+    Event<void()> first, second;
+    std::uint64_t secondAt = 0;
+    first += [&]() { wheel.Schedule(second, unit::ms(1)); };
+    second += [&]() { secondAt = wheel.GetCurrentTick(); };
+    wheel.Schedule(first, unit::ms(300));
+    wheel.AdvanceTicks(1000);
+    CRU_CHECK(secondAt == 301);
+}
+
+//timers far enough to sit in the higher wheels must come down through every level and fire on their exact tick.
+CRU_TEST(TimerWheelCascade)
+{
+    TimerWheel wheel(unit::ms(1));
+    std::mt19937_64 random(1);
+    const int timerCount = 20000;
+    std::vector<std::unique_ptr<Event<void()>>> events(timerCount);
+    std::vector<std::uint64_t> expected(timerCount), firedAt(timerCount, 0);
+    std::vector<TimerHandle> handles(timerCount);
+    int firedTwice = 0;
+    for (int i = 0; i < timerCount; i++)
+    {
+        events[i].reset(new Event<void()>());
+        *events[i] += [&, i]() {
+            if (firedAt[i] != 0)
+                firedTwice++;
+            firedAt[i] = wheel.GetCurrentTick();
+        };
+        //every tenth beyond the second wheel, which spans 65536 ticks.
+        expected[i] = 1 + random() % (i % 10 == 0 ? (1u << 25) : (1u << 17));
+        handles[i] = wheel.Schedule(*events[i], unit::WithRep<unit::ms, std::int64_t>(static_cast<std::int64_t>(expected[i])));
+    }
+    for (int i = 0; i < timerCount; i += 7)
+        CRU_CHECK(wheel.Cancel(handles[i]));
+
+    //a tick exactly on a boundary of the second and third wheels.
+    Event<void()> boundary;
+    std::uint64_t boundaryAt = 0;
+    boundary += [&]() { boundaryAt = wheel.GetCurrentTick(); };
+    wheel.Schedule(boundary, unit::WithRep<unit::ms, std::int64_t>(256 * 256));
+
+    const std::uint64_t end = 1u << 25;
+    wheel.AdvanceTicks(end);
+    int wrong = 0;
+    for (int i = 0; i < timerCount; i++)
+        if (firedAt[i] != (i % 7 == 0 ? 0 : expected[i]))
+            wrong++;
+    CRU_CHECK(wrong == 0);
+    CRU_CHECK(firedTwice == 0);
+    CRU_CHECK(boundaryAt == 256 * 256);
+    CRU_CHECK(wheel.GetPendingCount() == 0);
+}
@@ -0,0 +1,25 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark.h"
+
+using namespace unit::benchmark;
+
+//run the benchmarks whose names contain one of the arguments, or all of them without arguments.
+//exit with a failure if any check of a regression failed.
+int main(int argc, char** argv)
+{
+	for (auto& benchmarkCase : getBenchmarkCases())
+	{
+		bool selected = argc <= 1;
+		for (int i = 1; i < argc; i++)
+			if (std::strstr(benchmarkCase.name, argv[i]))
+				selected = true;
+		if (!selected)
+			continue;
+		std::printf("%s\n", benchmarkCase.name);
+		benchmarkCase.function();
+	}
+	std::printf("%zu failed checks\n", getFailureCount());
+	return getFailureCount() == 0 ? 0 : 1;
+}
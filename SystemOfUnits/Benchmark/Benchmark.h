@@ -0,0 +1,81 @@
+//A small harness for the benchmarks of SystemOfUnits: define benchmarks with UNIT_BENCHMARK,
+//and the main in Benchmark.cpp runs the ones asked for.
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace unit
+{
+	namespace benchmark
+	{
+		//a benchmark registered by UNIT_BENCHMARK.
+		struct BenchmarkCase
+		{
+			const char* name;
+			void (*function)();
+		};
+
+		inline std::vector<BenchmarkCase>& getBenchmarkCases()
+		{
+			static std::vector<BenchmarkCase> benchmarkCases;
+			return benchmarkCases;
+		}
+
+		inline std::size_t& getFailureCount()
+		{
+			static std::size_t failureCount = 0;
+			return failureCount;
+		}
+
+		struct BenchmarkRegistrar
+		{
+			BenchmarkRegistrar(const char* name, void (*function)()) { getBenchmarkCases().push_back(BenchmarkCase{ name, function }); }
+		};
+
+		//run "function" "repeat" times and return the fastest run in seconds,
+		//which is the one least disturbed by the rest of the machine.
+		template<typename _Function>
+		double measureBest(_Function&& function, int repeat = 5)
+		{
+			double best = 0;
+			for (int i = 0; i < repeat; i++)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				function();
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				if (i == 0 || seconds < best)
+					best = seconds;
+			}
+			return best;
+		}
+
+		//keep a result from being optimized away.
+		template<typename T>
+		void consume(const T& value)
+		{
+			static volatile T sink;
+			sink = value;
+			static_cast<void>(sink);
+		}
+
+		//fail the run when "value" is above "limit", like a check in a test.
+		inline void checkAtMost(const char* what, double value, double limit)
+		{
+			if (value <= limit)
+				return;
+			std::printf("regression: %s is %.3f, more than %.3f\n", what, value, limit);
+			++getFailureCount();
+		}
+	}
+}
+
+//define a benchmark function, registered to run with every other one.
+#define UNIT_BENCHMARK(name) \
+	static void name(); \
+	static const ::unit::benchmark::BenchmarkRegistrar name##Registrar(#name, &name); \
+	static void name()
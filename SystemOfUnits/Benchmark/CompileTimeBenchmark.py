@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Measure what expressions over Units cost the compiler.
+
+Generate sources of many functions, each computing an expression of many
+terms, once with Units and once with doubles, and compile each one with
+-fsyntax-only, which is where templates are instantiated. Report the CPU
+time and the peak memory of the compiler, and fail when the Units cost
+more than LIMIT times the doubles.
+
+    CompileTimeBenchmark.py [functions] [terms]     (default: 400 16)
+
+The compiler is $CXX, or g++, with the flags in $CXXFLAGS added.
+It runs on POSIX systems, where os.wait4 reports the resources of a child.
+"""
+
+import os
+import shlex
+import subprocess
+import sys
+import tempfile
+
+DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+TIME_LIMIT = 8.0
+MEMORY_LIMIT = 4.0
+
+#terms of a length, mixing multiple factors and dimensions so the operators instantiate many Units.
+LENGTH_TERMS = [
+    "m(x * {k})",
+    "km(x + {k})",
+    "mm(x - {k})",
+    "m_ps(x) * s({k})",
+    "0.5 * m_ps2(x) * s({k}) * s(x)",
+    "m2(x) / km({k})",
+    "N(x) / (kg({k}) * m_ps2(x)) * m(x)",
+    "-mm({k}) * x",
+]
+
+UNIT_PRELUDE = """#include "{header}"
+using namespace unit;
+"""
+
+#the same names as functions of doubles, so both sources parse the same expressions.
+RAW_PRELUDE = """namespace raw
+{{
+{functions}
+}}
+using namespace raw;
+"""
+
+RAW_NAMES = ["m", "km", "mm", "s", "m_ps", "m_ps2", "m2", "N", "kg"]
+
+
+def generate(useUnits, functionCount, termCount):
+    if useUnits:
+        lines = [UNIT_PRELUDE.format(header=os.path.join(DIRECTORY, "..", "SystemOfUnits.h").replace("\\", "/"))]
+    else:
+        functions = "\n".join("\tconstexpr double %s(double value) { return value; }" % i for i in RAW_NAMES)
+        lines = [RAW_PRELUDE.format(functions=functions)]
+    for f in range(functionCount):
+        terms = [LENGTH_TERMS[(f + t) % len(LENGTH_TERMS)].format(k=f * termCount + t + 1) for t in range(termCount)]
+        expression = "\n\t\t+ ".join(terms)
+        if useUnits:
+            lines.append("double length%d(double x)\n{\n\tconst m result = %s;\n\treturn result.value;\n}\n" % (f, expression))
+        else:
+            lines.append("double length%d(double x)\n{\n\tconst double result = %s;\n\treturn result;\n}\n" % (f, expression))
+    return "\n".join(lines)
+
+
+def compile_source(text):
+    """Return the CPU seconds and the peak memory in MB of compiling "text"."""
+    with tempfile.NamedTemporaryFile("w", suffix=".cpp", delete=False) as source:
+        source.write(text)
+    try:
+        command = [os.environ.get("CXX", "g++"), "-std=c++14", "-fsyntax-only"]
+        command += shlex.split(os.environ.get("CXXFLAGS", ""))
+        command.append(source.name)
+        process = subprocess.Popen(command)
+        _, status, usage = os.wait4(process.pid, 0)
+        process.returncode = status
+        if status != 0:
+            raise RuntimeError("the generated source doesn't compile: %s" % source.name)
+        #ru_maxrss is in kB on Linux and in bytes on macOS.
+        megabytes = usage.ru_maxrss / (1024.0 * 1024.0 if sys.platform == "darwin" else 1024.0)
+        return usage.ru_utime + usage.ru_stime, megabytes
+    finally:
+        os.remove(source.name)
+
+
+def check_at_most(what, value, limit):
+    if value <= limit:
+        return 0
+    print("regression: %s is %.3f, more than %.3f" % (what, value, limit))
+    return 1
+
+
+def main(arguments):
+    functionCount = int(arguments[0]) if len(arguments) > 0 else 400
+    termCount = int(arguments[1]) if len(arguments) > 1 else 16
+    print("%d functions of %d terms" % (functionCount, termCount))
+    unitSeconds, unitMegabytes = compile_source(generate(True, functionCount, termCount))
+    rawSeconds, rawMegabytes = compile_source(generate(False, functionCount, termCount))
+    print("  Unit   %.2f s, %.0f MB" % (unitSeconds, unitMegabytes))
+    print("  double %.2f s, %.0f MB" % (rawSeconds, rawMegabytes))
+    failureCount = check_at_most("Unit / double CPU time", unitSeconds / rawSeconds, TIME_LIMIT)
+    failureCount += check_at_most("Unit / double peak memory", unitMegabytes / rawMegabytes, MEMORY_LIMIT)
+    print("%d failed checks" % failureCount)
+    return 0 if failureCount == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
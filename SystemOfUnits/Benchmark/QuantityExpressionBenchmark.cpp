@@ -0,0 +1,55 @@
+#include <cstdio>
+#include <vector>
+
+#include "../QuantityArray.h"
+#include "Benchmark.h"
+
+using namespace unit;
+using namespace unit::benchmark;
+
+namespace
+{
+	const std::size_t elementCount = 1 << 22;
+	const int evaluationCount = 10;
+}
+
+//0.5 * m * v * v + m * g * h over arrays, as one fused expression and element-wise with a temporary for every step.
+//the fused one reads each input once and writes nothing else, so it must be the faster.
+UNIT_BENCHMARK(QuantityExpressionFused)
+{
+	const QuantityArray<kg> mass(elementCount, kg(1.5));
+	const QuantityArray<m_ps> speed(elementCount, m_ps(2));
+	const QuantityArray<m> height(elementCount, m(3));
+	const m_ps2 gravity(9.8);
+	QuantityArray<J> energy(elementCount);
+
+	const double fused = measureBest([&]() {
+		for (int i = 0; i < evaluationCount; i++)
+			energy = 0.5 * mass * speed * speed + mass * gravity * height;
+	}, 3);
+	consume(energy[elementCount - 1].value);
+
+	std::vector<double> halfMass(elementCount), momentum(elementCount), kinetic(elementCount), weight(elementCount), potential(elementCount);
+	const double naive = measureBest([&]() {
+		for (int i = 0; i < evaluationCount; i++)
+		{
+			for (std::size_t j = 0; j < elementCount; j++)
+				halfMass[j] = 0.5 * mass.rawData()[j];
+			for (std::size_t j = 0; j < elementCount; j++)
+				momentum[j] = halfMass[j] * speed.rawData()[j];
+			for (std::size_t j = 0; j < elementCount; j++)
+				kinetic[j] = momentum[j] * speed.rawData()[j];
+			for (std::size_t j = 0; j < elementCount; j++)
+				weight[j] = mass.rawData()[j] * gravity.value;
+			for (std::size_t j = 0; j < elementCount; j++)
+				potential[j] = weight[j] * height.rawData()[j];
+			for (std::size_t j = 0; j < elementCount; j++)
+				energy.rawData()[j] = kinetic[j] + potential[j];
+		}
+	}, 3);
+	consume(energy[0].value);
+
+	std::printf("  fused %.2f ms, element-wise with temporaries %.2f ms per evaluation of %zu elements\n",
+		fused * 1e3 / evaluationCount, naive * 1e3 / evaluationCount, elementCount);
+	checkAtMost("fused / element-wise", fused / naive, 1.0);
+}
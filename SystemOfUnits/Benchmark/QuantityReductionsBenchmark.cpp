@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+#include "../QuantityReductions.h"
+#include "Benchmark.h"
+
+using namespace unit;
+using namespace unit::benchmark;
+
+namespace
+{
+	const std::size_t elementCount = 10000003;
+}
+
+//sum, dot and trapezoid of 10M quantities with 1, 2, 4... threads up to the cores,
+//against a plain loop over the doubles, which is what they replace.
+//compensated summation must not cost more than half again the plain loop on one thread.
+UNIT_BENCHMARK(QuantityReductionsScaling)
+{
+	std::mt19937_64 random(3);
+	std::uniform_real_distribution<double> distribution(0, 1);
+	QuantityArray<m_ps> speed(elementCount);
+	QuantityArray<W> power(elementCount);
+	QuantityArray<s> time(elementCount);
+	for (std::size_t i = 0; i < elementCount; i++)
+	{
+		speed[i] = m_ps(distribution(random));
+		power[i] = W(1 + distribution(random));
+		time[i] = s(i * 0.001);
+	}
+
+	const double plain = measureBest([&]() {
+		double result = 0;
+		for (std::size_t i = 0; i < elementCount; i++)
+			result += speed.rawData()[i];
+		consume(result);
+	});
+	std::printf("  plain loop sum %.2f ms\n", plain * 1e3);
+
+	const auto maxThreadCount = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	double sequentialSum = 0;
+	for (std::size_t threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreadCount))
+	{
+		const execution::ParallelPolicy policy{ threadCount, 1 };
+		const double sumSeconds = measureBest([&]() { consume(sum(policy, speed).value); });
+		const double dotSeconds = measureBest([&]() { consume(dot(policy, speed, speed).value); });
+		const double trapezoidSeconds = measureBest([&]() { consume(trapezoid(policy, power, time).value); });
+		if (threadCount == 1)
+			sequentialSum = sumSeconds;
+		std::printf("  %2zu threads: sum %.2f ms (x%.2f), dot %.2f ms, trapezoid %.2f ms\n",
+			threadCount, sumSeconds * 1e3, sequentialSum / sumSeconds, dotSeconds * 1e3, trapezoidSeconds * 1e3);
+		if (threadCount == maxThreadCount)
+			break;
+	}
+	checkAtMost("compensated sum / plain loop", sequentialSum / plain, 1.5);
+}
@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../QuantityText.h"
+#include "Benchmark.h"
+
+using namespace unit;
+using namespace unit::benchmark;
+
+namespace
+{
+	const std::size_t fieldCount = 2000000;
+
+	//a field of a CSV file, as an offset and a length in the text.
+	struct Field
+	{
+		std::size_t offset;
+		std::size_t length;
+	};
+}
+
+//parse and format 2M distances like "512.25 km" in MB/s,
+//against std::stod and a comparison of the unit strings, which is what a hand written reader does.
+//the parser must not be much slower than that, even without std::from_chars, when it goes through std::strtod too.
+UNIT_BENCHMARK(QuantityTextThroughput)
+{
+	const char* const symbols[] = { "km", "m", "mm", "cm" };
+	const double scales[] = { 1000, 1, 0.001, 0.01 };
+	std::mt19937 random(1);
+	std::uniform_real_distribution<double> distribution(0, 1000);
+	std::string text;
+	std::vector<Field> fields;
+	fields.reserve(fieldCount);
+	for (std::size_t i = 0; i < fieldCount; i++)
+	{
+		char buffer[64];
+		const int length = std::snprintf(buffer, sizeof(buffer), "%.6g %s", distribution(random), symbols[i % 4]);
+		fields.push_back(Field{ text.size(), static_cast<std::size_t>(length) });
+		text.append(buffer, static_cast<std::size_t>(length));
+		text += ',';
+	}
+	const double megabytes = text.size() / 1e6;
+
+	const double parse = measureBest([&]() {
+		double result = 0;
+		for (auto& i : fields)
+		{
+			m distance;
+			parseQuantity(text.data() + i.offset, text.data() + i.offset + i.length, distance);
+			result += distance.value;
+		}
+		consume(result);
+	});
+	const double baseline = measureBest([&]() {
+		double result = 0;
+		for (auto& i : fields)
+		{
+			const std::string field(text, i.offset, i.length);
+			std::size_t end;
+			const double value = std::stod(field, &end);
+			const auto symbol = field.substr(end + 1);
+			for (std::size_t j = 0; j < 4; j++)
+				if (symbol == symbols[j])
+					result += value * scales[j];
+		}
+		consume(result);
+	});
+	std::printf("  parseQuantity %.0f MB/s, std::stod %.0f MB/s\n", megabytes / parse, megabytes / baseline);
+
+	std::vector<km> values(fieldCount);
+	for (auto& i : values)
+		i = km(distribution(random));
+	std::vector<char> output(32 * fieldCount);
+	std::size_t written = 0;
+	const double format = measureBest([&]() {
+		auto position = output.data();
+		for (auto& i : values)
+		{
+			position = formatQuantity(position, output.data() + output.size(), i).end;
+			*position++ = ',';
+		}
+		written = position - output.data();
+		consume(written);
+	});
+	std::printf("  formatQuantity %.0f MB/s\n", written / 1e6 / format);
+	checkAtMost("parseQuantity / std::stod", parse / baseline, 1.5);
+}
@@ -0,0 +1,44 @@
+#include <cstdio>
+
+#include "../QuantityArray.h"
+#include "Benchmark.h"
+
+using namespace unit;
+using namespace unit::benchmark;
+
+namespace
+{
+	const std::size_t elementCount = 1 << 22;
+
+	template<typename _Rep>
+	double measureArea(internal::simd::Level level)
+	{
+		internal::simd::setLevel(level);
+		const QuantityArray<WithRep<m, _Rep>> width(elementCount, WithRep<m, _Rep>(_Rep(1.5)));
+		const QuantityArray<WithRep<m, _Rep>> height(elementCount, WithRep<m, _Rep>(_Rep(2.5)));
+		QuantityArray<WithRep<m2, _Rep>> area(elementCount);
+		const double seconds = measureBest([&]() { area = width * height + width * width; });
+		consume(area[elementCount - 1].value);
+		return seconds;
+	}
+}
+
+//a * b + a * a over large arrays of float and of double, at every instruction set.
+//float moves half the bytes and fills twice the lanes, so it must not be slower.
+UNIT_BENCHMARK(QuantityArrayFloatAgainstDouble)
+{
+	const auto detected = internal::simd::getLevel();
+	const char* levelNames[] = { "scalar", "SSE2", "AVX2" };
+	for (auto level : { internal::simd::Level::Scalar, internal::simd::Level::Sse2, internal::simd::Level::Avx2 })
+	{
+		if (level > detected)
+			break;
+		const double floatSeconds = measureArea<float>(level);
+		const double doubleSeconds = measureArea<double>(level);
+		std::printf("  %-6s float %.2f ms, double %.2f ms (x%.2f)\n", levelNames[static_cast<int>(level)],
+			floatSeconds * 1e3, doubleSeconds * 1e3, doubleSeconds / floatSeconds);
+		if (level == detected)
+			checkAtMost("float / double", floatSeconds / doubleSeconds, 1.0);
+	}
+	internal::simd::setLevel(detected);
+}
@@ -0,0 +1,86 @@
+//functions whose assembly CheckCodegen.py inspects, it is not run.
+//every function "Name" is compared to "NameExpected", the same work on doubles written by hand:
+//both must compile to the same instructions, so a Unit costs nothing over the double it holds.
+
+#include <cstddef>
+
+#include "../SystemOfUnits.h"
+
+using namespace unit;
+
+extern "C" double UnitSum(double left, double right)
+{
+	return (m(left) + m(right)).value;
+}
+
+extern "C" double UnitSumExpected(double left, double right)
+{
+	return left + right;
+}
+
+//the kilometres are converted to the better multiple factor of the two, the metre.
+extern "C" double UnitSumOfMultiples(double left, double right)
+{
+	return (km(left) + m(right)).value;
+}
+
+extern "C" double UnitSumOfMultiplesExpected(double left, double right)
+{
+	return left * 1000 + right;
+}
+
+extern "C" double UnitKineticEnergy(double mass, double speed)
+{
+	const J energy = 0.5 * kg(mass) * m_ps(speed) * m_ps(speed);
+	return energy.value;
+}
+
+extern "C" double UnitKineticEnergyExpected(double mass, double speed)
+{
+	return 0.5 * mass * speed * speed;
+}
+
+extern "C" double UnitCompoundAssignment(double value, double increment, double factor)
+{
+	m result(value);
+	result += km(increment);
+	result *= factor;
+	return result.value;
+}
+
+extern "C" double UnitCompoundAssignmentExpected(double value, double increment, double factor)
+{
+	value += increment * 1000;
+	value *= factor;
+	return value;
+}
+
+extern "C" bool UnitLess(double left, double right)
+{
+	return km(left) < m(right);
+}
+
+extern "C" bool UnitLessExpected(double left, double right)
+{
+	return left * 1000 < right;
+}
+
+//the loop must be vectorized the same way.
+extern "C" void UnitIntegrate(m* position, m_ps* speed, const m_ps2* acceleration, double step, std::size_t count)
+{
+	const s timeStep(step);
+	for (std::size_t i = 0; i < count; i++)
+	{
+		speed[i] += acceleration[i] * timeStep;
+		position[i] += speed[i] * timeStep;
+	}
+}
+
+extern "C" void UnitIntegrateExpected(double* position, double* speed, const double* acceleration, double step, std::size_t count)
+{
+	for (std::size_t i = 0; i < count; i++)
+	{
+		speed[i] += acceleration[i] * step;
+		position[i] += speed[i] * step;
+	}
+}
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "../SystemOfUnits.h"
+#include "Benchmark.h"
+
+using namespace unit;
+using namespace unit::benchmark;
+
+namespace
+{
+	const std::size_t elementCount = 1 << 20;
+
+	//the types a kernel computes with: the Units, or doubles for all of them.
+	struct UnitTypes
+	{
+		typedef m Length;
+		typedef km LongLength;
+		typedef s Time;
+		typedef m_ps Speed;
+		typedef m_ps2 Acceleration;
+		typedef kg Mass;
+		typedef J Energy;
+	};
+
+	struct RawTypes
+	{
+		typedef double Length;
+		typedef double LongLength;
+		typedef double Time;
+		typedef double Speed;
+		typedef double Acceleration;
+		typedef double Mass;
+		typedef double Energy;
+	};
+
+	//the raw kernels convert kilometres by hand, where a Unit converts them itself.
+	inline m toLength(km value) { return value; }
+	inline double toLength(double value) { return value * 1000; }
+
+	template<typename _Types>
+	struct Kernels
+	{
+		typedef typename _Types::Length Length;
+		typedef typename _Types::Speed Speed;
+
+		std::vector<Length> position = std::vector<Length>(elementCount, Length(0));
+		std::vector<Speed> speed = std::vector<Speed>(elementCount, Speed(1));
+		std::vector<typename _Types::Acceleration> acceleration = std::vector<typename _Types::Acceleration>(elementCount, typename _Types::Acceleration(0.5));
+		std::vector<typename _Types::LongLength> offset = std::vector<typename _Types::LongLength>(elementCount, typename _Types::LongLength(0.25));
+		std::vector<typename _Types::Mass> mass = std::vector<typename _Types::Mass>(elementCount, typename _Types::Mass(2));
+
+		void integrate(typename _Types::Time step)
+		{
+			for (std::size_t i = 0; i < elementCount; i++)
+			{
+				speed[i] += acceleration[i] * step;
+				position[i] += speed[i] * step;
+			}
+		}
+
+		typename _Types::Energy kineticEnergy() const
+		{
+			auto result = typename _Types::Energy(0);
+			for (std::size_t i = 0; i < elementCount; i++)
+				result += 0.5 * mass[i] * speed[i] * speed[i];
+			return result;
+		}
+
+		Length farthest() const
+		{
+			auto result = Length(0);
+			for (std::size_t i = 0; i < elementCount; i++)
+			{
+				const Length distance = position[i] + toLength(offset[i]);
+				if (result < distance)
+					result = distance;
+			}
+			return result;
+		}
+	};
+
+	template<typename _Function>
+	double measureKernel(_Function&& function)
+	{
+		return measureBest(function, 9);
+	}
+
+	double valueOf(double value) { return value; }
+	template<typename _UnitType>
+	double valueOf(const _UnitType& value) { return value.value; }
+}
+
+//the same kernels over Units and over doubles: a step of motion, a sum of kinetic energies, and a maximum of sums in two multiple factors.
+//a Unit is a double at run time, so the Units must not be more than 10% slower than the doubles, within the noise of the machine.
+UNIT_BENCHMARK(UnitAgainstRawDouble)
+{
+	Kernels<UnitTypes> units;
+	Kernels<RawTypes> raw;
+	const char* kernelNames[] = { "integrate", "kinetic energy", "farthest" };
+	const double unitSeconds[] = {
+		measureKernel([&]() { units.integrate(s(0.01)); consume(valueOf(units.position[elementCount - 1])); }),
+		measureKernel([&]() { consume(valueOf(units.kineticEnergy())); }),
+		measureKernel([&]() { consume(valueOf(units.farthest())); }) };
+	const double rawSeconds[] = {
+		measureKernel([&]() { raw.integrate(0.01); consume(valueOf(raw.position[elementCount - 1])); }),
+		measureKernel([&]() { consume(valueOf(raw.kineticEnergy())); }),
+		measureKernel([&]() { consume(valueOf(raw.farthest())); }) };
+
+	double unitTotal = 0, rawTotal = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		std::printf("  %-15s Unit %.3f ms, double %.3f ms (x%.2f)\n", kernelNames[i], unitSeconds[i] * 1e3, rawSeconds[i] * 1e3, unitSeconds[i] / rawSeconds[i]);
+		unitTotal += unitSeconds[i];
+		rawTotal += rawSeconds[i];
+	}
+	checkAtMost("Unit / double", unitTotal / rawTotal, 1.1);
+	//both computed the same values.
+	checkAtMost("difference of the results", std::abs(valueOf(units.kineticEnergy()) - valueOf(raw.kineticEnergy())), 0);
+}
@@ -0,0 +1,410 @@
+//Quantities whose dimension is only known at run time, such as the ones read from a configuration file.
+//DynamicQuantity and DynamicQuantityArray keep the exponents of their dimension and a scale to the coherent SI unit,
+//and check dimensions as they compute, throwing std::domain_error on a mismatch.
+//An array is checked once as a whole when it is converted to a QuantityArray of a static Unit,
+//then the values are scaled in one pass of the SIMD kernels, and the hot code goes on with the static types.
+
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "SystemOfUnits.h"
+#include "QuantityArray.h"
+#include "QuantityText.h"
+
+namespace unit
+{
+	//the exponents of a dimension: L, M, T, I, P, N, J as in internal::Dimension.
+	struct DynamicDimension
+	{
+		internal::IntegerType exponents[7];
+	};
+
+	inline bool operator == (const DynamicDimension& left, const DynamicDimension& right)
+	{
+		return std::memcmp(left.exponents, right.exponents, sizeof(left.exponents)) == 0;
+	}
+
+	inline bool operator != (const DynamicDimension& left, const DynamicDimension& right)
+	{
+		return !(left == right);
+	}
+
+	//the dimension of a product, which adds the exponents.
+	inline DynamicDimension operator * (const DynamicDimension& left, const DynamicDimension& right)
+	{
+		DynamicDimension result;
+		for (std::size_t i = 0; i < 7; i++)
+			result.exponents[i] = left.exponents[i] + right.exponents[i];
+		return result;
+	}
+
+	//the dimension of a quotient, which subtracts the exponents.
+	inline DynamicDimension operator / (const DynamicDimension& left, const DynamicDimension& right)
+	{
+		DynamicDimension result;
+		for (std::size_t i = 0; i < 7; i++)
+			result.exponents[i] = left.exponents[i] - right.exponents[i];
+		return result;
+	}
+
+	//the DynamicDimension of a Dimension, such as unit::J::Dimension.
+	template<typename D>
+	inline DynamicDimension makeDynamicDimension()
+	{
+		return DynamicDimension{ { D::L, D::M, D::T, D::I, D::P, D::N, D::J } };
+	}
+
+	namespace internal
+	{
+		//the exception of every dimension mismatch found at run time.
+		inline void _checkDimension(const DynamicDimension& left, const DynamicDimension& right)
+		{
+			if (left != right)
+				throw std::domain_error("unit: the quantities have different dimensions.");
+		}
+
+		//"value" in a unit of "fromScale" to a unit of "toScale", both relative to the coherent SI unit.
+		//divide by a ratio below one instead of multiplying by it, as parseQuantity does, so 1500 mm is exactly 1.5 m.
+		inline NumericType _rescale(NumericType value, NumericType fromScale, NumericType toScale)
+		{
+			return fromScale > toScale ? value * (fromScale / toScale)
+				: fromScale < toScale ? value / (toScale / fromScale)
+				: value;
+		}
+
+		//a value already in the multiple factor of "_UnitType" to its representation, checked like ConversionFactor does.
+		template<typename _UnitType>
+		inline _UnitType _toStaticUnit(NumericType value, YesType)
+		{
+			return _UnitType(_checkedTruncate<typename _UnitType::Rep>(static_cast<long double>(value)));
+		}
+
+		template<typename _UnitType>
+		inline _UnitType _toStaticUnit(NumericType value, NoType)
+		{
+			return _UnitType(static_cast<typename _UnitType::Rep>(value));
+		}
+
+		template<typename _UnitType>
+		inline _UnitType _toStaticUnit(NumericType value)
+		{
+			return _toStaticUnit<_UnitType>(value, typename BoolToType<std::is_integral<typename _UnitType::Rep>::value>::ResultType());
+		}
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Classes definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//"value" in a unit of "dimension" that is "scale" times the coherent SI unit, so 12.5 km is { 12.5, 1000, length }.
+	//operators check dimensions at run time and work out the result like the ones of Unit,
+	//+ and - keep the scale of the left operand, and * and / multiply and divide the scales.
+	//
+	//	unit::DynamicQuantity speed;
+	//	unit::parseQuantity(text.data(), text.data() + text.size(), speed);	// "36 km/h" from a configuration file
+	//	unit::m_ps limit = speed.to<unit::m_ps>();								// throws if it isn't a speed
+	struct DynamicQuantity
+	{
+		internal::NumericType value = 0;
+		internal::NumericType scale = 1;
+		DynamicDimension dimension = {};
+
+		DynamicQuantity() = default;
+		DynamicQuantity(internal::NumericType _value, internal::NumericType _scale, const DynamicDimension& _dimension) : value(_value), scale(_scale), dimension(_dimension) { }
+		//a number is dimensionless.
+		DynamicQuantity(internal::NumericType _value) : value(_value) { }
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+		DynamicQuantity(const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& quantity)
+			: value(static_cast<internal::NumericType>(quantity.value)), scale(static_cast<internal::NumericType>(quantity.multipleFactor)), dimension(makeDynamicDimension<_Dimension>()) { }
+
+		//the value in the coherent SI unit.
+		internal::NumericType coherentValue() const { return value * scale; }
+
+		template<typename _UnitType>
+		bool hasDimensionOf() const { return dimension == makeDynamicDimension<typename _UnitType::Dimension>(); }
+
+		//converted to a static Unit, throwing std::domain_error if it has another dimension.
+		template<typename _UnitType>
+		_UnitType to() const
+		{
+			internal::_checkDimension(dimension, makeDynamicDimension<typename _UnitType::Dimension>());
+			return internal::_toStaticUnit<_UnitType>(internal::_rescale(value, scale, _UnitType::multipleFactor));
+		}
+
+		DynamicQuantity& operator += (const DynamicQuantity& right);
+		DynamicQuantity& operator -= (const DynamicQuantity& right);
+		DynamicQuantity& operator *= (internal::NumericType factor) { value *= factor; return *this; }
+		DynamicQuantity& operator /= (internal::NumericType factor) { value /= factor; return *this; }
+	};
+
+	//------------------------------
+	//quantities of one dimension and scale known at run time.
+	//the values are stored like a QuantityArray of dimensionless numbers in that scale,
+	//so the arithmetic on whole arrays runs in the SIMD kernels, with the dimension checked once per operation.
+	//
+	//	unit::DynamicQuantityArray samples(dimension, scale);	// from the header of a data file
+	//	...
+	//	unit::QuantityArray<unit::W> power = samples.to<unit::W>();	// one check, one pass
+	class DynamicQuantityArray
+	{
+	public:
+		typedef internal::Unit<internal::NoDimension> ScalarType;
+
+		DynamicQuantityArray() = default;
+		explicit DynamicQuantityArray(const DynamicDimension& dimension, internal::NumericType scale = 1, std::size_t size = 0)
+			: values_(size), scale_(scale), dimension_(dimension) { }
+		DynamicQuantityArray(const DynamicDimension& dimension, internal::NumericType scale, QuantityArray<ScalarType> values)
+			: values_(std::move(values)), scale_(scale), dimension_(dimension) { }
+		template<typename _UnitType>
+		explicit DynamicQuantityArray(const QuantityArray<_UnitType>& values);
+
+		std::size_t size() const { return values_.size(); }
+		bool empty() const { return values_.empty(); }
+		internal::NumericType scale() const { return scale_; }
+		const DynamicDimension& dimension() const { return dimension_; }
+
+		DynamicQuantity operator [] (std::size_t index) const { return DynamicQuantity(values_[index].value, scale_, dimension_); }
+		//converted to the scale of the array, throwing std::domain_error if it has another dimension.
+		void push_back(const DynamicQuantity& value);
+		void reserve(std::size_t capacity) { values_.reserve(capacity); }
+
+		//the values in the scale of the array.
+		QuantityArray<ScalarType>& values() { return values_; }
+		const QuantityArray<ScalarType>& values() const { return values_; }
+
+		template<typename _UnitType>
+		bool hasDimensionOf() const { return dimension_ == makeDynamicDimension<typename _UnitType::Dimension>(); }
+
+		//converted to a QuantityArray of a static Unit, throwing std::domain_error if it has another dimension.
+		//only the dimension of the whole array is checked, and a Unit in internal::NumericType is converted by the SIMD kernels.
+		template<typename _UnitType>
+		QuantityArray<_UnitType> to() const
+		{
+			QuantityArray<_UnitType> result;
+			convertTo(result);
+			return result;
+		}
+		template<typename _UnitType>
+		void convertTo(QuantityArray<_UnitType>& result) const;
+
+		DynamicQuantityArray& operator += (const DynamicQuantityArray& right);
+		DynamicQuantityArray& operator -= (const DynamicQuantityArray& right);
+		DynamicQuantityArray& operator *= (internal::NumericType factor) { values_ *= factor; return *this; }
+		DynamicQuantityArray& operator /= (internal::NumericType factor) { values_ /= factor; return *this; }
+
+	private:
+		template<typename _UnitType>
+		void convertTo(QuantityArray<_UnitType>& result, internal::YesType) const;
+		template<typename _UnitType>
+		void convertTo(QuantityArray<_UnitType>& result, internal::NoType) const;
+
+		QuantityArray<ScalarType> values_;
+		internal::NumericType scale_ = 1;
+		DynamicDimension dimension_ = {};
+	};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Operators of DynamicQuantity
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	inline DynamicQuantity& DynamicQuantity::operator += (const DynamicQuantity& right)
+	{
+		internal::_checkDimension(dimension, right.dimension);
+		value += internal::_rescale(right.value, right.scale, scale);
+		return *this;
+	}
+
+	inline DynamicQuantity& DynamicQuantity::operator -= (const DynamicQuantity& right)
+	{
+		internal::_checkDimension(dimension, right.dimension);
+		value -= internal::_rescale(right.value, right.scale, scale);
+		return *this;
+	}
+
+	inline DynamicQuantity operator + (DynamicQuantity left, const DynamicQuantity& right)
+	{
+		return left += right;
+	}
+
+	inline DynamicQuantity operator - (DynamicQuantity left, const DynamicQuantity& right)
+	{
+		return left -= right;
+	}
+
+	inline DynamicQuantity operator - (const DynamicQuantity& operand)
+	{
+		return DynamicQuantity(-operand.value, operand.scale, operand.dimension);
+	}
+
+	inline DynamicQuantity operator * (const DynamicQuantity& left, const DynamicQuantity& right)
+	{
+		return DynamicQuantity(left.value * right.value, left.scale * right.scale, left.dimension * right.dimension);
+	}
+
+	inline DynamicQuantity operator / (const DynamicQuantity& left, const DynamicQuantity& right)
+	{
+		return DynamicQuantity(left.value / right.value, left.scale / right.scale, left.dimension / right.dimension);
+	}
+
+	//------------------------------
+	//comparisons need the same dimension, and compare the values in the coherent SI unit.
+	#define Define_DynamicQuantityComparison(theOperator)													\
+	inline bool operator theOperator (const DynamicQuantity& left, const DynamicQuantity& right)			\
+	{																										\
+		internal::_checkDimension(left.dimension, right.dimension);											\
+		return left.value theOperator internal::_rescale(right.value, right.scale, left.scale);				\
+	}
+
+	Define_DynamicQuantityComparison(==)
+	Define_DynamicQuantityComparison(!=)
+	Define_DynamicQuantityComparison(<)
+	Define_DynamicQuantityComparison(<=)
+	Define_DynamicQuantityComparison(>)
+	Define_DynamicQuantityComparison(>=)
+
+	#undef Define_DynamicQuantityComparison
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Members and operators of DynamicQuantityArray
+//the operators are the ones of DynamicQuantity applied to every element,
+//and an operand is a DynamicQuantityArray or a DynamicQuantity, which includes a number and a static Unit.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template<typename _UnitType>
+	inline DynamicQuantityArray::DynamicQuantityArray(const QuantityArray<_UnitType>& values)
+		: scale_(static_cast<internal::NumericType>(_UnitType::multipleFactor)), dimension_(makeDynamicDimension<typename _UnitType::Dimension>())
+	{
+		values_.resize(values.size());
+		for (std::size_t i = 0; i < values.size(); i++)
+			values_[i] = ScalarType(static_cast<internal::NumericType>(values[i].value));
+	}
+
+	inline void DynamicQuantityArray::push_back(const DynamicQuantity& value)
+	{
+		internal::_checkDimension(dimension_, value.dimension);
+		values_.push_back(ScalarType(internal::_rescale(value.value, value.scale, scale_)));
+	}
+
+	template<typename _UnitType>
+	inline void DynamicQuantityArray::convertTo(QuantityArray<_UnitType>& result) const
+	{
+		internal::_checkDimension(dimension_, makeDynamicDimension<typename _UnitType::Dimension>());
+		convertTo(result, typename internal::IsTypeSame<typename _UnitType::Rep, internal::NumericType>::ResultType());
+	}
+
+	//the representation of the values, so the kernels scale them on the way.
+	template<typename _UnitType>
+	inline void DynamicQuantityArray::convertTo(QuantityArray<_UnitType>& result, internal::YesType) const
+	{
+		typedef internal::_ScaledArrayNode<_UnitType> NodeType;
+		const auto factor = internal::_rescale(1, scale_, _UnitType::multipleFactor);
+		result = QuantityExpression<NodeType>(NodeType(values_.rawData(), values_.size(), factor));
+	}
+
+	//another representation, converted one by one with the overflow checks of an integer one.
+	template<typename _UnitType>
+	inline void DynamicQuantityArray::convertTo(QuantityArray<_UnitType>& result, internal::NoType) const
+	{
+		result.resize(values_.size());
+		for (std::size_t i = 0; i < values_.size(); i++)
+			result[i] = internal::_toStaticUnit<_UnitType>(internal::_rescale(values_[i].value, scale_, _UnitType::multipleFactor));
+	}
+
+	inline DynamicQuantityArray& DynamicQuantityArray::operator += (const DynamicQuantityArray& right)
+	{
+		internal::_checkDimension(dimension_, right.dimension_);
+		values_ = values_ + right.values_ * internal::_rescale(1, right.scale_, scale_);
+		return *this;
+	}
+
+	inline DynamicQuantityArray& DynamicQuantityArray::operator -= (const DynamicQuantityArray& right)
+	{
+		internal::_checkDimension(dimension_, right.dimension_);
+		values_ = values_ - right.values_ * internal::_rescale(1, right.scale_, scale_);
+		return *this;
+	}
+
+	//------------------------------
+	inline DynamicQuantityArray operator + (DynamicQuantityArray left, const DynamicQuantityArray& right)
+	{
+		return left += right;
+	}
+
+	inline DynamicQuantityArray operator + (const DynamicQuantityArray& left, const DynamicQuantity& right)
+	{
+		internal::_checkDimension(left.dimension(), right.dimension);
+		return DynamicQuantityArray(left.dimension(), left.scale(), left.values() + DynamicQuantityArray::ScalarType(internal::_rescale(right.value, right.scale, left.scale())));
+	}
+
+	inline DynamicQuantityArray operator - (DynamicQuantityArray left, const DynamicQuantityArray& right)
+	{
+		return left -= right;
+	}
+
+	inline DynamicQuantityArray operator - (const DynamicQuantityArray& left, const DynamicQuantity& right)
+	{
+		return left + -right;
+	}
+
+	//------------------------------
+	inline DynamicQuantityArray operator * (const DynamicQuantityArray& left, const DynamicQuantityArray& right)
+	{
+		return DynamicQuantityArray(left.dimension() * right.dimension(), left.scale() * right.scale(), left.values() * right.values());
+	}
+
+	inline DynamicQuantityArray operator * (const DynamicQuantityArray& left, const DynamicQuantity& right)
+	{
+		return DynamicQuantityArray(left.dimension() * right.dimension, left.scale() * right.scale, left.values() * right.value);
+	}
+
+	inline DynamicQuantityArray operator * (const DynamicQuantity& left, const DynamicQuantityArray& right)
+	{
+		return right * left;
+	}
+
+	inline DynamicQuantityArray operator / (const DynamicQuantityArray& left, const DynamicQuantityArray& right)
+	{
+		return DynamicQuantityArray(left.dimension() / right.dimension(), left.scale() / right.scale(), left.values() / right.values());
+	}
+
+	inline DynamicQuantityArray operator / (const DynamicQuantityArray& left, const DynamicQuantity& right)
+	{
+		return DynamicQuantityArray(left.dimension() / right.dimension, left.scale() / right.scale, left.values() / right.value);
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Text
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//like parseQuantity of a Unit, but any dimension is accepted and kept with the scale of the unit in the text,
+	//so "12.5 km" gives { 12.5, 1000, length }.
+	inline ParseResult parseQuantity(const char* first, const char* last, DynamicQuantity& result)
+	{
+		double value;
+		internal::_ParsedUnit unit;
+		const auto parsed = internal::_parseQuantity(first, last, value, unit);
+		if (parsed.error != TextError::None)
+			return parsed;
+		result = DynamicQuantity(value, unit.getScale(), DynamicDimension{});
+		std::memcpy(result.dimension.exponents, unit.exponents, sizeof(unit.exponents));
+		return parsed;
+	}
+
+	//like formatQuantity of a Unit, but the symbol is worked out for every call.
+	inline FormatResult formatQuantity(char* first, char* last, const DynamicQuantity& quantity)
+	{
+		const auto symbol = internal::_makeFormatSymbol(quantity.dimension.exponents, quantity.scale);
+		return internal::_formatQuantity(first, last, symbol.isCoherent ? quantity.coherentValue() : quantity.value, symbol);
+	}
+}
@@ -0,0 +1,118 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "DynamicQuantity.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	std::string format(const DynamicQuantity& quantity)
+	{
+		char buffer[64];
+		const auto result = formatQuantity(buffer, buffer + sizeof(buffer), quantity);
+		return std::string(buffer, result.end);
+	}
+
+	DynamicQuantityArray makePower(std::size_t count)
+	{
+		DynamicQuantityArray result(makeDynamicDimension<W::Dimension>(), 1000, count);
+		for (std::size_t i = 0; i < count; i++)
+			result.values()[i] = DynamicQuantityArray::ScalarType(i * 0.5);
+		return result;
+	}
+}
+
+UNIT_TEST(DynamicQuantityConvertsToStaticUnits)
+{
+	DynamicQuantity speed;
+	const char text[] = "36 km/h";
+	UNIT_CHECK(parseQuantity(text, text + std::strlen(text), speed).error == TextError::None);
+	UNIT_CHECK(speed.hasDimensionOf<m_ps>() && !speed.hasDimensionOf<m>());
+	UNIT_CHECK(std::abs(speed.to<m_ps>().value - 10) < 1e-12);
+	UNIT_CHECK_THROWS(std::domain_error, speed.to<m>());
+
+	UNIT_CHECK(DynamicQuantity(mm(1500)).to<m>().value == 1.5);
+	UNIT_CHECK((DynamicQuantity(m(2.7)).to<WithRep<mm, std::int64_t>>().value == 2700));
+	UNIT_CHECK_THROWS(std::overflow_error, DynamicQuantity(km(1e10)).to<WithRep<mm, std::int32_t>>());
+	UNIT_CHECK(DynamicQuantity(2.5).to<internal::Unit<internal::NoDimension>>().value == 2.5);
+}
+
+UNIT_TEST(DynamicQuantityOperators)
+{
+	const DynamicQuantity distance = km(12.5);
+	const DynamicQuantity shortDistance = m(500);
+	const DynamicQuantity time = s(10);
+	//+ and - keep the scale of the left operand.
+	UNIT_CHECK((distance + shortDistance).value == 13 && (distance + shortDistance).scale == 1000);
+	UNIT_CHECK((shortDistance + distance).value == 13000);
+	UNIT_CHECK((distance - shortDistance).value == 12);
+	UNIT_CHECK((-distance).value == -12.5);
+	UNIT_CHECK_THROWS(std::domain_error, distance + time);
+	UNIT_CHECK_THROWS(std::domain_error, distance - time);
+	UNIT_CHECK_THROWS(std::domain_error, static_cast<void>(distance < time));
+
+	UNIT_CHECK(distance > shortDistance && shortDistance < distance && !(distance == shortDistance));
+	UNIT_CHECK(DynamicQuantity(km(0.5)) == shortDistance && distance != shortDistance);
+	UNIT_CHECK((distance * shortDistance).to<m2>().value == 12500.0 * 500);
+	UNIT_CHECK((distance / time).to<m_ps>().value == 1250);
+	UNIT_CHECK((distance / time).hasDimensionOf<m_ps>());
+	auto scaled = distance;
+	scaled *= 4;
+	scaled /= 2;
+	UNIT_CHECK(scaled.value == 25 && scaled.scale == 1000);
+}
+
+UNIT_TEST(DynamicQuantityFormat)
+{
+	UNIT_CHECK(format(km(12.5)) == "12.5 km");
+	UNIT_CHECK(format(DynamicQuantity(km(12.5)) * DynamicQuantity(m(2))) == "25000 m^2");
+	UNIT_CHECK(format(2.5) == "2.5");
+}
+
+UNIT_TEST(DynamicQuantityArrayConvertsOnce)
+{
+	const auto power = makePower(2001);
+	const QuantityArray<W> watts = power.to<W>();
+	UNIT_CHECK(watts.size() == 2001 && watts[1001].value == 500500);
+	UNIT_CHECK(power[1001].to<W>().value == watts[1001].value);
+	const QuantityArray<WithRep<W, std::int32_t>> integers = power.to<WithRep<W, std::int32_t>>();
+	UNIT_CHECK(integers[3].value == 1500);
+	const QuantityArray<WithRep<W, float>> floats = power.to<WithRep<W, float>>();
+	UNIT_CHECK(floats[3].value == 1500.0f);
+	//the dimension of the whole array is checked, and nothing is converted on a mismatch.
+	UNIT_CHECK_THROWS(std::domain_error, power.to<J>());
+	UNIT_CHECK_THROWS(std::domain_error, power.to<WithRep<J, std::int32_t>>());
+}
+
+UNIT_TEST(DynamicQuantityArrayOperators)
+{
+	const DynamicQuantityArray watts(QuantityArray<W>{ W(1), W(2) });
+	UNIT_CHECK(watts.scale() == 1 && watts.dimension() == makeDynamicDimension<W::Dimension>());
+	const auto kilowatts = makePower(2);
+	UNIT_CHECK((watts + kilowatts).scale() == 1 && (watts + kilowatts)[1].value == 502);
+	UNIT_CHECK((kilowatts + watts).scale() == 1000 && (kilowatts + watts)[1].value == 0.502);
+	UNIT_CHECK((kilowatts - DynamicQuantity(W(500)))[1].value == 0);
+
+	const DynamicQuantityArray time(QuantityArray<s>{ s(2), s(3) });
+	const auto energy = kilowatts * time;
+	UNIT_CHECK(energy.to<J>()[1].value == 1500);
+	UNIT_CHECK((kilowatts * DynamicQuantity(h(1))).to<J>()[1].value == 1800000);
+	UNIT_CHECK((energy / time).to<W>()[1].value == 500);
+	UNIT_CHECK((energy / DynamicQuantity(s(3))).to<W>()[1].value == 500);
+	UNIT_CHECK_THROWS(std::domain_error, kilowatts + time);
+	UNIT_CHECK_THROWS(std::domain_error, kilowatts - time);
+	UNIT_CHECK_THROWS(std::length_error, kilowatts + makePower(3));
+
+	auto growing = watts;
+	growing *= 2;
+	UNIT_CHECK(growing[1].value == 4);
+	growing.push_back(DynamicQuantity(W(1000)));
+	UNIT_CHECK(growing.size() == 3 && growing[2].value == 1000);
+	UNIT_CHECK_THROWS(std::domain_error, growing.push_back(DynamicQuantity(s(1))));
+	UNIT_CHECK(growing.size() == 3);
+}
@@ -0,0 +1,849 @@
+//A container of quantities of one unit, stored as a contiguous aligned array of the representation of the unit.
+//Arithmetic on it builds expression templates, evaluated by the SIMD kernels in QuantityKernels.h,
+//and their result types are worked out just like the ones of Unit,
+//so a dimensional mistake is still a compile error.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SystemOfUnits.h"
+#include "QuantityKernels.h"
+
+namespace unit
+{
+	template<typename _UnitType>
+	class QuantityArray;
+
+	template<typename _Node>
+	class QuantityExpression;
+
+	namespace internal
+	{
+		//alignment of the storage of QuantityArray, the width of an AVX register.
+		constexpr std::size_t quantityArrayAlignment = 32;
+
+		//allocate "count" values of type "T" aligned to quantityArrayAlignment.
+		//the pointer returned by operator new is kept just before the aligned block.
+		template<typename T>
+		inline T* _allocateAligned(std::size_t count)
+		{
+			if (count == 0)
+				return nullptr;
+			const auto raw = static_cast<char*>(::operator new(count * sizeof(T) + quantityArrayAlignment + sizeof(void*)));
+			auto aligned = raw + sizeof(void*);
+			aligned += (quantityArrayAlignment - reinterpret_cast<std::uintptr_t>(aligned) % quantityArrayAlignment) % quantityArrayAlignment;
+			reinterpret_cast<void**>(aligned)[-1] = raw;
+			return reinterpret_cast<T*>(aligned);
+		}
+
+		inline void _freeAligned(void* pointer)
+		{
+			if (pointer)
+				::operator delete(reinterpret_cast<void**>(pointer)[-1]);
+		}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Expression nodes
+//a node has "UnitType", "size()" and "evaluate" defined by Define_EvaluateFunctions,
+//which gives the values at "index" in UnitType, in its representation.
+//all the nodes of a tree have the same representation, so the kernels run in one type.
+//nodes are held by value in the tree, and a leaf refers to the values of its QuantityArray.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		//the size of a node that fits any size, such as a single quantity.
+		constexpr std::size_t anySize = static_cast<std::size_t>(-1);
+
+		//the operands of an element-wise operation must have the same size, unless one fits any.
+		//it's checked once when the expression is built, and a mismatch throws std::length_error.
+		inline void _checkSameSize(std::size_t leftSize, std::size_t rightSize)
+		{
+			if (leftSize != anySize && rightSize != anySize && leftSize != rightSize)
+				throw std::length_error("unit: the arrays have different sizes.");
+		}
+
+		//------------------------------
+		//the values of a QuantityArray.
+		template<typename _UnitType>
+		struct _ArrayNode
+		{
+			typedef _UnitType UnitType;
+
+			const typename UnitType::Rep* values;
+			std::size_t count;
+
+			explicit _ArrayNode(const QuantityArray<UnitType>& array) : values(array.rawData()), count(array.size()) { }
+			_ArrayNode(const typename UnitType::Rep* _values, std::size_t _count) : values(_values), count(_count) { }
+
+			std::size_t size() const { return count; }
+			Define_EvaluateFunctions({ return decltype(lanes)::load(values + index); })
+		};
+
+		//------------------------------
+		//stored values multiplied by a factor known only at run time, such as a column of a QuantityFile of another multiple factor.
+		//the factor is 1 when there's nothing to convert, and a multiplication costs nothing next to reading the values from memory.
+		template<typename _UnitType>
+		struct _ScaledArrayNode
+		{
+			typedef _UnitType UnitType;
+
+			const typename UnitType::Rep* values;
+			std::size_t count;
+			typename UnitType::Rep factor;
+
+			_ScaledArrayNode(const typename UnitType::Rep* _values, std::size_t _count, typename UnitType::Rep _factor) : values(_values), count(_count), factor(_factor) { }
+
+			std::size_t size() const { return count; }
+			Define_EvaluateFunctions({ return decltype(lanes)::multiply(decltype(lanes)::load(values + index), decltype(lanes)::broadcast(factor)); })
+		};
+
+		//------------------------------
+		//one quantity for every element.
+		template<typename _UnitType>
+		struct _ValueNode
+		{
+			typedef _UnitType UnitType;
+
+			typename UnitType::Rep value;
+
+			explicit _ValueNode(typename UnitType::Rep _value) : value(_value) { }
+
+			std::size_t size() const { return anySize; }
+			Define_EvaluateFunctions({ (void)index; return decltype(lanes)::broadcast(value); })
+		};
+
+		//------------------------------
+		//both operands converted to the multiple factor of "_ResultUnit", then "_Operation".
+		//the conversions are the ones of Unit, so an element gives the same result as a single quantity.
+		template<typename _Operation, typename _ResultUnit, typename _Left, typename _Right>
+		struct _BinaryNode
+		{
+			typedef _ResultUnit UnitType;
+			typedef ConversionFactor<typename _Left::UnitType::MultipleFactorType, typename UnitType::MultipleFactorType> LeftFactor;
+			typedef ConversionFactor<typename _Right::UnitType::MultipleFactorType, typename UnitType::MultipleFactorType> RightFactor;
+
+			_Left left;
+			_Right right;
+
+			_BinaryNode(const _Left& _left, const _Right& _right) : left(_left), right(_right)
+			{
+				_checkSameSize(left.size(), right.size());
+			}
+
+			std::size_t size() const { return left.size() != anySize ? left.size() : right.size(); }
+			Define_EvaluateFunctions({
+				typedef decltype(lanes) Lanes;
+				return _Operation::apply(lanes,
+					Lanes::template convert<LeftFactor>(left.evaluate(lanes, index)),
+					Lanes::template convert<RightFactor>(right.evaluate(lanes, index)));
+			})
+		};
+
+		//------------------------------
+		//the operand in another multiple factor of the same dimension.
+		template<typename _ResultUnit, typename _Operand>
+		struct _ConvertNode
+		{
+			typedef _ResultUnit UnitType;
+			typedef ConversionFactor<typename _Operand::UnitType::MultipleFactorType, typename UnitType::MultipleFactorType> Factor;
+
+			_Operand operand;
+
+			explicit _ConvertNode(const _Operand& _operand) : operand(_operand) { }
+
+			std::size_t size() const { return operand.size(); }
+			Define_EvaluateFunctions({
+				typedef decltype(lanes) Lanes;
+				return Lanes::template convert<Factor>(operand.evaluate(lanes, index));
+			})
+		};
+
+		//------------------------------
+		template<typename _ResultUnit, typename _Operand>
+		struct _SqrtNode
+		{
+			typedef _ResultUnit UnitType;
+
+			_Operand operand;
+
+			explicit _SqrtNode(const _Operand& _operand) : operand(_operand) { }
+
+			std::size_t size() const { return operand.size(); }
+			Define_EvaluateFunctions({ return decltype(lanes)::sqrt(operand.evaluate(lanes, index)); })
+		};
+
+		//------------------------------
+		//the operand to the power "exponent" by square-and-multiply in the lanes, as pow of Unit does.
+		//the loop runs on constants, so it unrolls into nothing but the multiplications.
+		template<typename _ResultUnit, IntegerType exponent, typename _Operand>
+		struct _PowerNode
+		{
+			typedef _ResultUnit UnitType;
+
+			_Operand operand;
+
+			explicit _PowerNode(const _Operand& _operand) : operand(_operand) { }
+
+			std::size_t size() const { return operand.size(); }
+			Define_EvaluateFunctions({
+				typedef decltype(lanes) Lanes;
+				const auto one = Lanes::broadcast(static_cast<typename UnitType::Rep>(1));
+				auto power = operand.evaluate(lanes, index);
+				auto result = one;
+				auto isFirst = true;
+				for (auto i = exponent < 0 ? -exponent : exponent; i != 0; i /= 2)
+				{
+					if (i % 2 != 0)
+					{
+						result = isFirst ? power : Lanes::multiply(result, power);
+						isFirst = false;
+					}
+					if (i > 1)
+						power = Lanes::multiply(power, power);
+				}
+				return exponent < 0 ? Lanes::divide(one, result) : result;
+			})
+		};
+
+		//------------------------------
+		//the "degree"-th root of the operand, as root of Unit does.
+		//there's an instruction for no root but the square one, which is _SqrtNode,
+		//so this one takes the roots one element at a time, still in the single pass of the kernel.
+		template<typename _ResultUnit, IntegerType degree, typename _Operand>
+		struct _RootNode
+		{
+			typedef _ResultUnit UnitType;
+
+			_Operand operand;
+
+			explicit _RootNode(const _Operand& _operand) : operand(_operand) { }
+
+			std::size_t size() const { return operand.size(); }
+			Define_EvaluateFunctions({
+				typedef decltype(lanes) Lanes;
+				typename UnitType::Rep values[Lanes::width];
+				Lanes::store(values, operand.evaluate(lanes, index));
+				for (auto& i : values)
+					i = _root<degree>(i);
+				return Lanes::load(values);
+			})
+		};
+
+		//------------------------------
+		//hypot of both operands converted to the multiple factor of "_ResultUnit",
+		//as larger * sqrt(1 + (smaller / larger)^2), which overflows or underflows only where the result does.
+		//the ratio is 1 where both are 0, as the minimum of the lanes gives its second operand for NaN.
+		//it's within an ulp or two of std::hypot for finite elements.
+		template<typename _ResultUnit, typename _Left, typename _Right>
+		struct _HypotNode
+		{
+			typedef _ResultUnit UnitType;
+			typedef ConversionFactor<typename _Left::UnitType::MultipleFactorType, typename UnitType::MultipleFactorType> LeftFactor;
+			typedef ConversionFactor<typename _Right::UnitType::MultipleFactorType, typename UnitType::MultipleFactorType> RightFactor;
+
+			_Left left;
+			_Right right;
+
+			_HypotNode(const _Left& _left, const _Right& _right) : left(_left), right(_right)
+			{
+				_checkSameSize(left.size(), right.size());
+			}
+
+			std::size_t size() const { return left.size() != anySize ? left.size() : right.size(); }
+			Define_EvaluateFunctions({
+				typedef decltype(lanes) Lanes;
+				const auto one = Lanes::broadcast(static_cast<typename UnitType::Rep>(1));
+				const auto leftValue = Lanes::absolute(Lanes::template convert<LeftFactor>(left.evaluate(lanes, index)));
+				const auto rightValue = Lanes::absolute(Lanes::template convert<RightFactor>(right.evaluate(lanes, index)));
+				const auto larger = Lanes::maximum(leftValue, rightValue);
+				const auto ratio = Lanes::minimum(Lanes::divide(Lanes::minimum(leftValue, rightValue), larger), one);
+				return Lanes::multiply(larger, Lanes::sqrt(simd::AddOperation::apply(lanes, one, Lanes::multiply(ratio, ratio))));
+			})
+		};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Operands
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		//what an operand of the operators of QuantityArray turns into in the expression tree.
+		//"isOperand" tells whether it can be one,
+		//and "isExpression" whether it has elements, as at least one operand must.
+		//"NodeType" and "getNode" take the representation of the expression, which a Unit is cast to.
+		template<typename T>
+		struct _Operand
+		{
+			static const bool isOperand = false;
+			static const bool isExpression = false;
+		};
+
+		template<typename _UnitType>
+		struct _Operand<QuantityArray<_UnitType>>
+		{
+			static const bool isOperand = true;
+			static const bool isExpression = true;
+			typedef _UnitType UnitType;
+			template<typename Rep>
+			using NodeType = _ArrayNode<_UnitType>;
+			template<typename Rep>
+			static NodeType<Rep> getNode(const QuantityArray<_UnitType>& operand) { return NodeType<Rep>(operand); }
+		};
+
+		template<typename _Node>
+		struct _Operand<QuantityExpression<_Node>>
+		{
+			static const bool isOperand = true;
+			static const bool isExpression = true;
+			typedef typename _Node::UnitType UnitType;
+			template<typename Rep>
+			using NodeType = _Node;
+			template<typename Rep>
+			static const _Node& getNode(const QuantityExpression<_Node>& operand) { return operand.getNode(); }
+		};
+
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+		struct _Operand<Unit<_Dimension, _MultipleFactorType, _Rep>>
+		{
+			static const bool isOperand = true;
+			static const bool isExpression = false;
+			typedef Unit<_Dimension, _MultipleFactorType, _Rep> UnitType;
+			template<typename Rep>
+			using NodeType = _ValueNode<Unit<_Dimension, _MultipleFactorType, Rep>>;
+			template<typename Rep>
+			static NodeType<Rep> getNode(const UnitType& operand) { return NodeType<Rep>(static_cast<Rep>(operand.value)); }
+		};
+
+		template<typename Left, typename Right>
+		struct _IsElementWise
+		{
+			static const bool resultValue = _Operand<Left>::isOperand && _Operand<Right>::isOperand && (_Operand<Left>::isExpression || _Operand<Right>::isExpression);
+			DEFINERESULTTYPE;
+		};
+
+		template<typename T>
+		using _OperandUnitType = typename _Operand<T>::UnitType;
+
+		template<typename T, typename Rep>
+		using _OperandNodeType = typename _Operand<T>::template NodeType<Rep>;
+
+		//------------------------------
+		//the representation of an element-wise operation is the one of its operands with elements.
+		//the kernels run in one representation, so two of them must agree,
+		//and a QuantityArray is converted to another representation explicitly.
+		template<typename Left, typename Right, bool = _Operand<Left>::isExpression, bool = _Operand<Right>::isExpression>
+		struct _ExpressionRepHelper
+		{
+			static_assert(isTypeSame<typename _OperandUnitType<Left>::Rep, typename _OperandUnitType<Right>::Rep>,
+				"The operands of an element-wise operation must have the same representation.");
+			typedef typename _OperandUnitType<Left>::Rep ResultType;
+		};
+
+		template<typename Left, typename Right>
+		struct _ExpressionRepHelper<Left, Right, true, false>
+		{
+			typedef typename _OperandUnitType<Left>::Rep ResultType;
+		};
+
+		template<typename Left, typename Right>
+		struct _ExpressionRepHelper<Left, Right, false, true>
+		{
+			typedef typename _OperandUnitType<Right>::Rep ResultType;
+		};
+
+		template<typename Left, typename Right>
+		using _ExpressionRep = typename _ExpressionRepHelper<Left, Right>::ResultType;
+
+		//------------------------------
+		//result unit of "+", "-" and the comparisons, only when the dimensions are the same.
+		template<typename LeftUnit, typename RightUnit, typename Rep, bool = isDimensionSame<LeftUnit, RightUnit>>
+		struct _SumUnit
+		{
+		};
+
+		template<typename LeftUnit, typename RightUnit, typename Rep>
+		struct _SumUnit<LeftUnit, RightUnit, Rep, true>
+		{
+			typedef Unit<typename LeftUnit::Dimension, BetterMultipleFactorType<typename LeftUnit::MultipleFactorType, typename RightUnit::MultipleFactorType>, Rep> ResultType;
+		};
+
+		template<typename LeftUnit, typename RightUnit, typename Rep>
+		using _ProductUnit = Unit<DimensionMultiplyResultType<typename LeftUnit::Dimension, typename RightUnit::Dimension>,
+			BetterMultipleFactorType<typename LeftUnit::MultipleFactorType, typename RightUnit::MultipleFactorType>, Rep>;
+
+		template<typename LeftUnit, typename RightUnit, typename Rep>
+		using _QuotientUnit = Unit<DimensionDivideResultType<typename LeftUnit::Dimension, typename RightUnit::Dimension>,
+			BetterMultipleFactorType<typename LeftUnit::MultipleFactorType, typename RightUnit::MultipleFactorType>, Rep>;
+
+		//------------------------------
+		template<typename Operation, typename ResultUnit, typename Left, typename Right>
+		using _BinaryNodeType = _BinaryNode<Operation, ResultUnit,
+			_OperandNodeType<Left, typename ResultUnit::Rep>, _OperandNodeType<Right, typename ResultUnit::Rep>>;
+
+		template<typename Operation, typename ResultUnit, typename Left, typename Right>
+		inline QuantityExpression<_BinaryNodeType<Operation, ResultUnit, Left, Right>> _makeBinary(const Left& left, const Right& right)
+		{
+			typedef typename ResultUnit::Rep Rep;
+			return QuantityExpression<_BinaryNodeType<Operation, ResultUnit, Left, Right>>(_BinaryNodeType<Operation, ResultUnit, Left, Right>(
+				_Operand<Left>::template getNode<Rep>(left), _Operand<Right>::template getNode<Rep>(right)));
+		}
+
+		template<typename Operation, typename Left, typename Right>
+		inline std::vector<std::uint8_t> _compare(const Left& left, const Right& right)
+		{
+			using ResultUnit = typename _SumUnit<_OperandUnitType<Left>, _OperandUnitType<Right>, _ExpressionRep<Left, Right>>::ResultType;
+			const _BinaryNodeType<Operation, ResultUnit, Left, Right> node(
+				_Operand<Left>::template getNode<typename ResultUnit::Rep>(left), _Operand<Right>::template getNode<typename ResultUnit::Rep>(right));
+			std::vector<std::uint8_t> result(node.size());
+			simd::evaluateMask<typename ResultUnit::Rep>(node, result.data(), 0, node.size());
+			return result;
+		}
+
+		//------------------------------
+		//an operand as an array, which a QuantityArray already is and an expression is evaluated into.
+		template<typename _UnitType>
+		inline const QuantityArray<_UnitType>& _evaluateOperand(const QuantityArray<_UnitType>& operand)
+		{
+			return operand;
+		}
+
+		template<typename _Node>
+		inline QuantityArray<typename _Node::UnitType> _evaluateOperand(const QuantityExpression<_Node>& operand)
+		{
+			return QuantityArray<typename _Node::UnitType>(operand);
+		}
+
+		//------------------------------
+		//"_Operation" of an operand and a number, in the representation of Unit times that number, std::common_type_t of both.
+		//when it's the one of the operand, the number is cast to it and the result is an expression as usual;
+		//otherwise the kernels can't mix representations, so the operand is converted to an array of the common one first,
+		//which the result is then evaluated into.
+		template<typename _Operand, typename _Number>
+		using _ScaledUnit = WithRep<_OperandUnitType<_Operand>, std::common_type_t<typename _OperandUnitType<_Operand>::Rep, _Number>>;
+
+		template<typename _Operation, typename _Operand, typename _Number>
+		inline auto _scale(const _Operand& operand, _Number number, YesType)
+		{
+			return _makeBinary<_Operation, _OperandUnitType<_Operand>>(operand, Unit<NoDimension, DefaultMultipleFactorType, _Number>(number));
+		}
+
+		template<typename _Operation, typename _Operand, typename _Number>
+		inline QuantityArray<_ScaledUnit<_Operand, _Number>> _scale(const _Operand& operand, _Number number, NoType)
+		{
+			typedef _ScaledUnit<_Operand, _Number> ResultUnit;
+			QuantityArray<ResultUnit> result(_evaluateOperand(operand));
+			result = _makeBinary<_Operation, ResultUnit>(result, Unit<NoDimension, DefaultMultipleFactorType, typename ResultUnit::Rep>(number));
+			return result;
+		}
+
+		template<typename _Operation, typename _Operand, typename _Number>
+		inline auto _scale(const _Operand& operand, _Number number)
+		{
+			return _scale<_Operation>(operand, number, typename IsTypeSame<typename _OperandUnitType<_Operand>::Rep, typename _ScaledUnit<_Operand, _Number>::Rep>::ResultType());
+		}
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Classes definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//a lazily evaluated element-wise expression of QuantityArray, made by its operators.
+	//nothing is computed until it is assigned to a QuantityArray,
+	//then the whole tree runs in one pass with no temporary arrays.
+	//it refers to the arrays in it, so don't keep it with "auto" after they change or die.
+	template<typename _Node>
+	class QuantityExpression
+	{
+	public:
+		typedef typename _Node::UnitType UnitType;
+
+		explicit QuantityExpression(const _Node& node) : node_(node) { }
+
+		std::size_t size() const { return node_.size(); }
+		const _Node& getNode() const { return node_; }
+
+	private:
+		_Node node_;
+	};
+
+	//a growable array of quantities of "UnitType".
+	//the values are stored in the representation of "UnitType", so unit::WithRep<unit::m, float> takes half the memory
+	//and twice the elements in a SIMD register of the default double.
+	//
+	//	unit::QuantityArray<unit::kg> mass(count);
+	//	unit::QuantityArray<unit::m_ps> speed(count);
+	//	unit::QuantityArray<unit::m> height(count);
+	//	unit::QuantityArray<unit::J> energy = 0.5 * mass * speed * speed + mass * g * height; // one pass, no temporaries
+	//	auto mask = height > unit::km(1);
+	template<typename _UnitType>
+	class QuantityArray
+	{
+	public:
+		typedef _UnitType UnitType;
+		typedef typename UnitType::Dimension Dimension;
+		typedef typename UnitType::MultipleFactorType MultipleFactorType;
+		typedef typename UnitType::Rep Rep;
+
+		typedef UnitType value_type;
+		typedef UnitType* iterator;
+		typedef const UnitType* const_iterator;
+
+		QuantityArray() = default;
+		explicit QuantityArray(std::size_t size) { resize(size); }
+		QuantityArray(std::size_t size, const UnitType& value) { resize(size, value); }
+		QuantityArray(std::initializer_list<UnitType> values);
+		QuantityArray(const QuantityArray& other);
+		QuantityArray(QuantityArray&& other);
+		//convert every element of an array of the same dimension, like static_cast of Unit,
+		//which is how an array changes its representation.
+		template<typename _OtherUnitType>
+		explicit QuantityArray(const QuantityArray<_OtherUnitType>& other);
+		//evaluate an expression of the same dimension and representation.
+		template<typename _Node>
+		QuantityArray(const QuantityExpression<_Node>& expression) { assign(expression); }
+		QuantityArray& operator = (const QuantityArray& other);
+		QuantityArray& operator = (QuantityArray&& other);
+		template<typename _Node>
+		QuantityArray& operator = (const QuantityExpression<_Node>& expression) { assign(expression); return *this; }
+		~QuantityArray() { internal::_freeAligned(values_); }
+
+		std::size_t size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		std::size_t capacity() const { return capacity_; }
+
+		void reserve(std::size_t capacity);
+		//new elements are "value".
+		void resize(std::size_t size, const UnitType& value = UnitType());
+		void clear() { size_ = 0; }
+		void push_back(const UnitType& value);
+
+		UnitType& operator [] (std::size_t index) { return data()[index]; }
+		const UnitType& operator [] (std::size_t index) const { return data()[index]; }
+
+		UnitType* data() { return reinterpret_cast<UnitType*>(values_); }
+		const UnitType* data() const { return reinterpret_cast<const UnitType*>(values_); }
+		//the values in "UnitType", aligned to internal::quantityArrayAlignment.
+		Rep* rawData() { return values_; }
+		const Rep* rawData() const { return values_; }
+
+		iterator begin() { return data(); }
+		iterator end() { return data() + size_; }
+		const_iterator begin() const { return data(); }
+		const_iterator end() const { return data() + size_; }
+
+		//evaluate "expression" in place, which may contain this array itself.
+		template<typename _Node>
+		void assign(const QuantityExpression<_Node>& expression);
+
+		//these take a QuantityArray, a QuantityExpression or a Unit.
+		template<typename _Right>
+		QuantityArray& operator += (const _Right& right) { return *this = *this + right; }
+		template<typename _Right>
+		QuantityArray& operator -= (const _Right& right) { return *this = *this - right; }
+		//computed in the common representation of Rep and the number, as "*" and "/" are, then converted back,
+		//so an array of std::int32_t times 0.5 is halved, as an int is by "*= 0.5".
+		template<typename _Number, typename = internal::EnableIfNumber<_Number>>
+		QuantityArray& operator *= (_Number factor) { assignResult(*this * factor); return *this; }
+		template<typename _Number, typename = internal::EnableIfNumber<_Number>>
+		QuantityArray& operator /= (_Number factor) { assignResult(*this / factor); return *this; }
+
+	private:
+		template<typename _Node>
+		void assignResult(const QuantityExpression<_Node>& expression) { assign(expression); }
+		template<typename _OtherUnitType>
+		void assignResult(const QuantityArray<_OtherUnitType>& other) { *this = QuantityArray(other); }
+
+		//a Unit is nothing but its value, so the storage is viewed as either.
+		static_assert(sizeof(UnitType) == sizeof(Rep), "Unit must hold nothing but its value.");
+
+		Rep* values_ = nullptr;
+		std::size_t size_ = 0;
+		std::size_t capacity_ = 0;
+	};
+
+	//one byte for each element, 1 where the comparison holds and 0 where it doesn't.
+	using ComparisonMask = std::vector<std::uint8_t>;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Members of QuantityArray
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template<typename _UnitType>
+	inline QuantityArray<_UnitType>::QuantityArray(std::initializer_list<UnitType> values)
+	{
+		reserve(values.size());
+		for (auto& i : values)
+			values_[size_++] = i.value;
+	}
+
+	template<typename _UnitType>
+	inline QuantityArray<_UnitType>::QuantityArray(const QuantityArray& other)
+	{
+		reserve(other.size_);
+		for (std::size_t i = 0; i < other.size_; i++)
+			values_[i] = other.values_[i];
+		size_ = other.size_;
+	}
+
+	template<typename _UnitType>
+	inline QuantityArray<_UnitType>::QuantityArray(QuantityArray&& other)
+		: values_(other.values_), size_(other.size_), capacity_(other.capacity_)
+	{
+		other.values_ = nullptr;
+		other.size_ = 0;
+		other.capacity_ = 0;
+	}
+
+	template<typename _UnitType>
+	template<typename _OtherUnitType>
+	inline QuantityArray<_UnitType>::QuantityArray(const QuantityArray<_OtherUnitType>& other)
+	{
+		static_assert(internal::isTypeSame<Dimension, typename _OtherUnitType::Dimension>, "The dimension of the array is not the one of this array.");
+		reserve(other.size());
+		for (std::size_t i = 0; i < other.size(); i++)
+			values_[i] = static_cast<UnitType>(other[i]).value;
+		size_ = other.size();
+	}
+
+	template<typename _UnitType>
+	inline QuantityArray<_UnitType>& QuantityArray<_UnitType>::operator=(const QuantityArray& other)
+	{
+		if (this != &other)
+		{
+			size_ = 0;
+			reserve(other.size_);
+			for (std::size_t i = 0; i < other.size_; i++)
+				values_[i] = other.values_[i];
+			size_ = other.size_;
+		}
+		return *this;
+	}
+
+	template<typename _UnitType>
+	inline QuantityArray<_UnitType>& QuantityArray<_UnitType>::operator=(QuantityArray&& other)
+	{
+		std::swap(values_, other.values_);
+		std::swap(size_, other.size_);
+		std::swap(capacity_, other.capacity_);
+		return *this;
+	}
+
+	template<typename _UnitType>
+	inline void QuantityArray<_UnitType>::reserve(std::size_t capacity)
+	{
+		if (capacity <= capacity_)
+			return;
+		const auto values = internal::_allocateAligned<Rep>(capacity);
+		for (std::size_t i = 0; i < size_; i++)
+			values[i] = values_[i];
+		internal::_freeAligned(values_);
+		values_ = values;
+		capacity_ = capacity;
+	}
+
+	template<typename _UnitType>
+	inline void QuantityArray<_UnitType>::resize(std::size_t size, const UnitType& value)
+	{
+		reserve(size);
+		for (std::size_t i = size_; i < size; i++)
+			values_[i] = value.value;
+		size_ = size;
+	}
+
+	template<typename _UnitType>
+	inline void QuantityArray<_UnitType>::push_back(const UnitType& value)
+	{
+		if (size_ == capacity_)
+			reserve(capacity_ ? capacity_ * 2 : 8);
+		values_[size_++] = value.value;
+	}
+
+	template<typename _UnitType>
+	template<typename _Node>
+	inline void QuantityArray<_UnitType>::assign(const QuantityExpression<_Node>& expression)
+	{
+		static_assert(internal::isTypeSame<Dimension, typename _Node::UnitType::Dimension>, "The dimension of the expression is not the one of the array.");
+		static_assert(internal::isTypeSame<Rep, typename _Node::UnitType::Rep>, "The representation of the expression is not the one of the array.");
+		const internal::_ConvertNode<UnitType, _Node> node(expression.getNode());
+		const auto size = node.size();
+
+		//an element is read before it is written at the same index, so the old values can be overwritten,
+		//but new storage is needed when they don't fit, and the old one is read until the end.
+		if (size <= capacity_)
+		{
+			internal::simd::evaluate(node, values_, 0, size);
+			size_ = size;
+			return;
+		}
+		const auto values = internal::_allocateAligned<Rep>(size);
+		internal::simd::evaluate(node, values, 0, size);
+		internal::_freeAligned(values_);
+		values_ = values;
+		size_ = size;
+		capacity_ = size;
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Operators of QuantityArray
+//an operand is a QuantityArray, a QuantityExpression or a Unit, and at least one must not be a Unit.
+//arrays of different sizes throw std::length_error, see _checkSameSize.
+//the result types are the ones of the same operators of Unit,
+//except that the representation is always the one of the arrays, see _ExpressionRep,
+//and a number only widens it when it must, see _scale.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	////////////////////////////////////////////////////
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>,
+		typename _ResultUnit = typename internal::_SumUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>::ResultType>
+	inline auto operator + (const _Left& left, const _Right& right)
+	{
+		return internal::_makeBinary<internal::simd::AddOperation, _ResultUnit>(left, right);
+	}
+
+
+	////////////////////////////////////////////////////
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>,
+		typename _ResultUnit = typename internal::_SumUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>::ResultType>
+	inline auto operator - (const _Left& left, const _Right& right)
+	{
+		return internal::_makeBinary<internal::simd::SubtractOperation, _ResultUnit>(left, right);
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	inline auto operator - (const _Operand& operand)
+	{
+		return internal::_makeBinary<internal::simd::MultiplyOperation, internal::_OperandUnitType<_Operand>>(operand, internal::Unit<internal::NoDimension>(-1.0));
+	}
+
+
+	////////////////////////////////////////////////////
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>>
+	inline auto operator * (const _Left& left, const _Right& right)
+	{
+		return internal::_makeBinary<internal::simd::MultiplyOperation, internal::_ProductUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>>(left, right);
+	}
+
+	//like the ones of Unit, multiplying by a number keeps the multiple factor,
+	//and the representation is std::common_type_t of the one of the operand and the number's, see _scale.
+	//so an array of double or of float times an int stays an expression in its representation,
+	//but an array of std::int32_t times 0.5 is an array of double, as the Unit would be.
+	template<typename _Left, typename _Number, typename = std::enable_if_t<internal::_Operand<_Left>::isExpression>, typename = internal::EnableIfNumber<_Number>>
+	inline auto operator * (const _Left& left, _Number right)
+	{
+		return internal::_scale<internal::simd::MultiplyOperation>(left, right);
+	}
+
+	template<typename _Number, typename _Right, typename = internal::EnableIfNumber<_Number>, typename = std::enable_if_t<internal::_Operand<_Right>::isExpression>>
+	inline auto operator * (_Number left, const _Right& right)
+	{
+		return internal::_scale<internal::simd::MultiplyOperation>(right, left);
+	}
+
+
+	////////////////////////////////////////////////////
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>>
+	inline auto operator / (const _Left& left, const _Right& right)
+	{
+		return internal::_makeBinary<internal::simd::DivideOperation, internal::_QuotientUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>>(left, right);
+	}
+
+	template<typename _Left, typename _Number, typename = std::enable_if_t<internal::_Operand<_Left>::isExpression>, typename = internal::EnableIfNumber<_Number>>
+	inline auto operator / (const _Left& left, _Number right)
+	{
+		return internal::_scale<internal::simd::DivideOperation>(left, right);
+	}
+
+
+	////////////////////////////////////////////////////
+	//comparisons are evaluated at once and give a ComparisonMask, like std::valarray gives a std::valarray<bool>.
+	#define Define_QuantityArrayComparison(theOperator, operation)																		\
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>,		\
+		typename = typename internal::_SumUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>::ResultType>	\
+	inline ComparisonMask operator theOperator (const _Left& left, const _Right& right)													\
+	{																																	\
+		return internal::_compare<internal::simd::operation>(left, right);																\
+	}
+
+	Define_QuantityArrayComparison(==, EqualOperation)
+	Define_QuantityArrayComparison(!=, NotEqualOperation)
+	Define_QuantityArrayComparison(<, LessOperation)
+	Define_QuantityArrayComparison(<=, LessEqualOperation)
+	Define_QuantityArrayComparison(>, GreaterOperation)
+	Define_QuantityArrayComparison(>=, GreaterEqualOperation)
+
+	#undef Define_QuantityArrayComparison
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Functions of QuantityArray
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//an expression of "count" quantities already stored somewhere else, such as in a std::vector<unit::W>,
+	//so they take part in the operators and algorithms of QuantityArray without a copy.
+	//it refers to the quantities like any QuantityExpression.
+	template<typename _UnitType>
+	inline QuantityExpression<internal::_ArrayNode<_UnitType>> quantityView(const _UnitType* first, std::size_t count)
+	{
+		static_assert(sizeof(_UnitType) == sizeof(typename _UnitType::Rep), "Unit must hold nothing but its value.");
+		return QuantityExpression<internal::_ArrayNode<_UnitType>>(internal::_ArrayNode<_UnitType>(reinterpret_cast<const typename _UnitType::Rep*>(first), count));
+	}
+
+	//element-wise pow, with the same result type as pow of Unit, in the SIMD lanes of the representation.
+	template<internal::IntegerType exponent, typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	auto pow(const _Operand& operand)
+	{
+		using Rep = typename internal::_OperandUnitType<_Operand>::Rep;
+		using ResultType = decltype(pow<exponent>(std::declval<internal::_OperandUnitType<_Operand>>()));
+		using NodeType = internal::_PowerNode<ResultType, exponent, internal::_OperandNodeType<_Operand, Rep>>;
+		return QuantityExpression<NodeType>(NodeType(internal::_Operand<_Operand>::template getNode<Rep>(operand)));
+	}
+
+	//element-wise root, with the same result type as root of Unit, which keeps the multiple factor.
+	//only for a float representation, so the result has the same one.
+	//the square root runs in the SIMD lanes, and the other ones one element at a time.
+	template<internal::IntegerType degree, typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	auto root(const _Operand& operand)
+	{
+		using Rep = typename internal::_OperandUnitType<_Operand>::Rep;
+		static_assert(std::is_floating_point<Rep>::value, "A root of a QuantityArray needs a float representation.");
+		using ResultType = decltype(root<degree>(std::declval<internal::_OperandUnitType<_Operand>>()));
+		using NodeType = std::conditional_t<degree == 2, internal::_SqrtNode<ResultType, internal::_OperandNodeType<_Operand, Rep>>,
+			internal::_RootNode<ResultType, degree, internal::_OperandNodeType<_Operand, Rep>>>;
+		return QuantityExpression<NodeType>(NodeType(internal::_Operand<_Operand>::template getNode<Rep>(operand)));
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	auto sqrt(const _Operand& operand)
+	{
+		return root<2>(operand);
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	auto cbrt(const _Operand& operand)
+	{
+		return root<3>(operand);
+	}
+
+	//element-wise hypot, with the same result type as hypot of Unit, in the SIMD lanes of the representation.
+	//either operand may be a single quantity, and the representation must be a float one.
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_IsElementWise<_Left, _Right>::resultValue>>
+	auto hypot(const _Left& left, const _Right& right)
+	{
+		using ResultType = typename internal::_SumUnit<internal::_OperandUnitType<_Left>, internal::_OperandUnitType<_Right>, internal::_ExpressionRep<_Left, _Right>>::ResultType;
+		using Rep = typename ResultType::Rep;
+		static_assert(std::is_floating_point<Rep>::value, "hypot of a QuantityArray needs a float representation.");
+		using NodeType = internal::_HypotNode<ResultType, internal::_OperandNodeType<_Left, Rep>, internal::_OperandNodeType<_Right, Rep>>;
+		return QuantityExpression<NodeType>(NodeType(internal::_Operand<_Left>::template getNode<Rep>(left), internal::_Operand<_Right>::template getNode<Rep>(right)));
+	}
+}
@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "QuantityArray.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	//run "function" with every instruction set of the kernels the processor has.
+	template<typename _Function>
+	void forEachLevel(_Function function)
+	{
+		const auto detected = internal::simd::getLevel();
+		for (auto level : { internal::simd::Level::Scalar, internal::simd::Level::Sse2, internal::simd::Level::Avx2 })
+		{
+			internal::simd::setLevel(level);
+			function();
+		}
+		internal::simd::setLevel(detected);
+	}
+
+	bool isClose(double value, double expected)
+	{
+		return std::abs(value - expected) <= 1e-12 * std::max(1.0, std::abs(expected));
+	}
+
+	//a size that is not a multiple of any vector width, so the tail is tested too.
+	const std::size_t testSize = 1003;
+
+	template<typename _UnitType>
+	QuantityArray<_UnitType> makeRandomArray(std::mt19937& random)
+	{
+		std::uniform_real_distribution<double> distribution(0.1, 10);
+		QuantityArray<_UnitType> result(testSize);
+		for (auto& i : result)
+			i = _UnitType(distribution(random));
+		return result;
+	}
+}
+
+UNIT_TEST(QuantityArrayArithmetic)
+{
+	std::mt19937 random(3);
+	const auto v = makeRandomArray<m_ps>(random);
+	const auto t = makeRandomArray<s>(random);
+	const auto tm = makeRandomArray<ms>(random);
+	const auto dk = makeRandomArray<km>(random);
+	forEachLevel([&]() {
+		QuantityArray<m> distance = v * t;
+		QuantityArray<m> sum = distance + dk;
+		QuantityArray<km> difference = dk - distance;
+		QuantityArray<m_ps> quotient = distance / tm;
+		QuantityArray<s> time = t + tm;
+		QuantityArray<m_ps> root = sqrt(v * v);
+		QuantityArray<m_ps> negative = -v;
+		QuantityArray<m_ps> scaled = 2.0 * v / 4.0;
+		QuantityArray<m> fromUnit = m(3) - distance;
+		bool close = true;
+		for (std::size_t i = 0; i < testSize; i++)
+		{
+			close = close && isClose(distance[i].value, (v[i] * t[i]).value);
+			close = close && isClose(sum[i].value, m(distance[i] + dk[i]).value);
+			close = close && isClose(difference[i].value, km(dk[i] - distance[i]).value);
+			close = close && isClose(quotient[i].value, m_ps(distance[i] / tm[i]).value);
+			close = close && isClose(time[i].value, s(t[i] + tm[i]).value);
+			close = close && isClose(root[i].value, v[i].value);
+			close = close && negative[i].value == -v[i].value;
+			close = close && isClose(scaled[i].value, v[i].value / 2);
+			close = close && isClose(fromUnit[i].value, 3 - distance[i].value);
+		}
+		UNIT_CHECK(close);
+	});
+}
+
+UNIT_TEST(QuantityArrayComparisons)
+{
+	std::mt19937 random(5);
+	const auto v = makeRandomArray<m_ps>(random);
+	const auto t = makeRandomArray<s>(random);
+	forEachLevel([&]() {
+		const QuantityArray<m> distance = v * t;
+		const auto greater = distance > km(0.02);
+		const auto less = km(0.02) < distance;
+		const auto equal = distance == v * t;
+		bool correct = greater.size() == testSize && equal.size() == testSize;
+		for (std::size_t i = 0; i < testSize; i++)
+			correct = correct && greater[i] == (distance[i] > km(0.02)) && less[i] == greater[i] && equal[i] == 1;
+		UNIT_CHECK(correct);
+	});
+}
+
+UNIT_TEST(QuantityArrayCompoundAssignment)
+{
+	std::mt19937 random(7);
+	const auto dk = makeRandomArray<km>(random);
+	const auto distance = makeRandomArray<m>(random);
+	forEachLevel([&]() {
+		QuantityArray<m> result(testSize);
+		result += dk;
+		result -= distance;
+		result *= 3;
+		result /= 3;
+		result += m(1);
+		bool close = true;
+		for (std::size_t i = 0; i < testSize; i++)
+			close = close && isClose(result[i].value, dk[i].value * 1000 - distance[i].value + 1);
+		UNIT_CHECK(close);
+	});
+}
+
+UNIT_TEST(QuantityArrayContainer)
+{
+	QuantityArray<m_ps> array{ m_ps(1), m_ps(2) };
+	array.push_back(m_ps(3));
+	UNIT_CHECK(array.size() == 3 && array[2].value == 3);
+	for (int i = 0; i < 100; i++)
+		array.push_back(m_ps(i));
+	UNIT_CHECK(array.size() == 103 && array[102].value == 99 && array[1].value == 2);
+	UNIT_CHECK(reinterpret_cast<std::uintptr_t>(array.rawData()) % internal::quantityArrayAlignment == 0);
+
+	QuantityArray<m_ps> copy(array);
+	array[0] = m_ps(10);
+	UNIT_CHECK(copy[0].value == 1);
+	QuantityArray<m_ps> moved(std::move(copy));
+	UNIT_CHECK(moved.size() == 103 && copy.empty());
+	moved.resize(105, m_ps(7));
+	UNIT_CHECK(moved[104].value == 7);
+
+	const QuantityArray<m> lengths{ m(1500), m(20) };
+	const QuantityArray<km> converted(lengths);
+	UNIT_CHECK(converted.size() == 2 && isClose(converted[0].value, 1.5) && isClose(converted[1].value, 0.02));
+	const QuantityArray<WithRep<m_ps, float>> narrowed(moved);
+	UNIT_CHECK(narrowed[1].value == 2.0f);
+	double total = 0;
+	for (auto& i : moved)
+		total += i.value;
+	UNIT_CHECK(total > 0);
+}
+
+UNIT_TEST(QuantityArrayFloatRepresentation)
+{
+	QuantityArray<WithRep<m, float>> distance(testSize, WithRep<m, float>(3.0f));
+	QuantityArray<WithRep<s, float>> time(testSize, WithRep<s, float>(2.0f));
+	forEachLevel([&]() {
+		QuantityArray<WithRep<m_ps, float>> speed = distance / time;
+		bool correct = true;
+		for (auto& i : speed)
+			correct = correct && i.value == 1.5f;
+		UNIT_CHECK(correct);
+	});
+}
+
+UNIT_TEST(QuantityArrayIntegerTimesNumber)
+{
+	typedef WithRep<m, std::int32_t> IntegerMetre;
+	const QuantityArray<IntegerMetre> integers{ IntegerMetre(10), IntegerMetre(-3) };
+	//the same representations as the operators of Unit.
+	static_assert(std::is_same<decltype(integers * 0.5)::UnitType, decltype(IntegerMetre() * 0.5)>::value, "");
+	static_assert(std::is_same<decltype(integers / 0.5)::UnitType, decltype(IntegerMetre() / 0.5)>::value, "");
+	static_assert(std::is_same<decltype(integers * 2)::UnitType, IntegerMetre>::value, "");
+	static_assert(std::is_same<decltype(QuantityArray<WithRep<m, float>>() * 2)::UnitType, WithRep<m, float>>::value, "");
+
+	forEachLevel([&]() {
+		const QuantityArray<m> half = integers * 0.5;
+		const QuantityArray<m> quarter = 0.25 * (integers + integers);
+		const QuantityArray<m> twice = integers / 0.5;
+		UNIT_CHECK(half[0].value == (IntegerMetre(10) * 0.5).value && half[1].value == -1.5);
+		UNIT_CHECK(quarter[0].value == 5 && quarter[1].value == -1.5);
+		UNIT_CHECK(twice[0].value == (IntegerMetre(10) / 0.5).value && twice[1].value == -6);
+		const QuantityArray<IntegerMetre> doubled = integers * 2;
+		UNIT_CHECK(doubled[0].value == 20 && doubled[1].value == -6);
+
+		//computed in double, then truncated to the representation of the array.
+		auto compound = integers;
+		compound *= 0.5;
+		UNIT_CHECK(compound[0].value == 5 && compound[1].value == -1);
+		compound /= 0.5;
+		UNIT_CHECK(compound[0].value == 10 && compound[1].value == -2);
+		compound *= 3;
+		UNIT_CHECK(compound[0].value == 30 && compound[1].value == -6);
+	});
+}
+
+UNIT_TEST(QuantityArrayPowerAndRoot)
+{
+	std::mt19937 random(5);
+	auto length = makeRandomArray<m>(random);
+	auto other = makeRandomArray<m>(random);
+	length[0] = m(0);
+	other[0] = m(0);
+	length[1] = -length[1];
+	//the same result types as the functions of Unit.
+	static_assert(std::is_same<decltype(pow<3>(length))::UnitType, m3>::value, "");
+	static_assert(std::is_same<decltype(pow<-2>(length))::UnitType, decltype(pow<-2>(m()))>::value, "");
+	static_assert(std::is_same<decltype(sqrt(pow<2>(length)))::UnitType, m>::value, "");
+	static_assert(std::is_same<decltype(cbrt(pow<3>(length)))::UnitType, m>::value, "");
+	static_assert(std::is_same<decltype(root<4>(pow<4>(length)))::UnitType, m>::value, "");
+	static_assert(std::is_same<decltype(hypot(length, km(1)))::UnitType, m>::value, "");
+	static_assert(std::is_same<decltype(pow<3>(QuantityArray<WithRep<m, std::int32_t>>()))::UnitType, WithRep<m3, std::int32_t>>::value, "");
+
+	forEachLevel([&]() {
+		const QuantityArray<m3> cube = pow<3>(length);
+		const QuantityArray<m> cubeRoot = cbrt(cube);
+		const QuantityArray<m> squareRoot = sqrt(pow<2>(other));
+		const QuantityArray<m> fourthRoot = root<4>(pow<4>(other));
+		const QuantityArray<m> diagonal = hypot(length, other);
+		const QuantityArray<m> withScalar = hypot(length, m(1));
+		bool correct = true;
+		for (std::size_t i = 0; i < testSize; i++)
+			correct = correct && isClose(cube[i].value, pow<3>(length[i]).value) && isClose(cubeRoot[i].value, length[i].value)
+				&& isClose(squareRoot[i].value, other[i].value) && isClose(fourthRoot[i].value, other[i].value)
+				&& std::abs(diagonal[i].value - std::hypot(length[i].value, other[i].value)) <= 4e-16 * diagonal[i].value
+				&& std::abs(withScalar[i].value - std::hypot(length[i].value, 1.0)) <= 4e-16 * withScalar[i].value;
+		UNIT_CHECK(correct);
+		UNIT_CHECK(diagonal[0].value == 0);
+	});
+
+	QuantityArray<WithRep<m, std::int32_t>> integers{ WithRep<m, std::int32_t>(2), WithRep<m, std::int32_t>(-3), WithRep<m, std::int32_t>(7) };
+	const QuantityArray<WithRep<m3, std::int32_t>> integerCube = pow<3>(integers);
+	UNIT_CHECK(integerCube[0].value == 8 && integerCube[1].value == -27 && integerCube[2].value == 343);
+}
+
+UNIT_TEST(QuantityExpressionFusedEvaluation)
+{
+	std::mt19937 random(11);
+	const auto mass = makeRandomArray<kg>(random);
+	const auto speed = makeRandomArray<m_ps>(random);
+	const auto height = makeRandomArray<m>(random);
+	const m_ps2 gravity(9.8);
+	forEachLevel([&]() {
+		QuantityArray<J> energy = 0.5 * mass * speed * speed + mass * gravity * height;
+		bool close = energy.size() == testSize;
+		for (std::size_t i = 0; i < testSize; i++)
+			close = close && isClose(energy[i].value, (0.5 * mass[i] * speed[i] * speed[i] + mass[i] * gravity * height[i]).value);
+		UNIT_CHECK(close);
+	});
+}
+
+//assign reads every element before writing it, so the array may appear in its own expression.
+UNIT_TEST(QuantityExpressionAliasing)
+{
+	forEachLevel([&]() {
+		QuantityArray<m> array(testSize);
+		for (std::size_t i = 0; i < testSize; i++)
+			array[i] = m(static_cast<double>(i));
+		array = array * 2.0 + array;
+		bool correct = true;
+		for (std::size_t i = 0; i < testSize; i++)
+			correct = correct && array[i].value == 3.0 * i;
+		UNIT_CHECK(correct);
+
+		//the same values in another multiple factor.
+		QuantityArray<km> kilometres(testSize, km(1));
+		kilometres.assign(kilometres + array);
+		correct = true;
+		for (std::size_t i = 0; i < testSize; i++)
+			correct = correct && isClose(kilometres[i].value, 1 + 3.0 * i / 1000);
+		UNIT_CHECK(correct);
+
+		//new storage, while the old one is still read.
+		QuantityArray<m> small(2, m(1));
+		const QuantityArray<m> large(testSize, m(2));
+		small = large + large * 0.5;
+		UNIT_CHECK(small.size() == testSize && small[testSize - 1].value == 3);
+		small = small - m(1);
+		UNIT_CHECK(small[0].value == 2);
+	});
+}
+
+UNIT_TEST(QuantityExpressionSizeMismatchThrows)
+{
+	QuantityArray<m> shorter(3, m(1));
+	const QuantityArray<m> longer(4, m(2));
+	UNIT_CHECK_THROWS(std::length_error, shorter + longer);
+	UNIT_CHECK_THROWS(std::length_error, shorter * 2.0 - longer);
+	UNIT_CHECK_THROWS(std::length_error, hypot(shorter, longer));
+	UNIT_CHECK_THROWS(std::length_error, shorter = longer * 2.0 + shorter);
+	//nothing was written.
+	UNIT_CHECK(shorter.size() == 3 && shorter[0].value == 1);
+	//a single quantity fits any size.
+	const QuantityArray<m> sum = shorter + m(1);
+	UNIT_CHECK(sum.size() == 3 && sum[2].value == 2);
+}
@@ -0,0 +1,510 @@
+//A binary columnar file of quantities, read back by mapping it into memory.
+//The header records the dimension and the multiple factor of every column, and the values follow as aligned raw blocks,
+//so opening a file reads nothing but the header whatever its size, and a column is a view over the mapped values.
+//The dimension of a column is checked against the requested type once, when the column is taken,
+//and a column written with another multiple factor is converted element by element as it is read.
+
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SystemOfUnits.h"
+#include "QuantityArray.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace unit
+{
+	enum class QuantityFileError
+	{
+		None,
+		CannotOpen,				//the file can't be opened, created or written.
+		CannotMap,				//the file can't be mapped into memory.
+		InvalidFormat,			//not a quantity file, a damaged one, or one written on a machine of another byte order.
+		UnknownColumn,			//no column of this name or index.
+		DimensionMismatch,		//the column has another dimension than the requested type.
+		RepresentationMismatch,	//the column is stored in another representation than the one of the requested type.
+		ScaleMismatch,			//the column has another multiple factor and an integer representation, so it can't be converted exactly.
+		RowCountMismatch		//the column to be written has another number of quantities than the ones already added.
+	};
+
+	template<typename _UnitType>
+	class QuantityColumn;
+
+	namespace internal
+	{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		File layout
+//a _FileHeader, then "columnCount" _ColumnHeader, then the values of every column,
+//each block starting at a multiple of quantityFileAlignment from the beginning of the file.
+//everything is stored in the byte order of the machine that wrote it, which byteOrder tells.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		constexpr char quantityFileMagic[8] = { 'Q', 'U', 'A', 'N', 'T', 'I', 'T', 'Y' };
+		constexpr std::uint32_t quantityFileVersion = 1;
+		constexpr std::uint32_t quantityFileByteOrder = 0x01020304;
+		//a cache line, and a multiple of quantityArrayAlignment, so the kernels load a column as fast as a QuantityArray.
+		constexpr std::size_t quantityFileAlignment = 64;
+		constexpr std::size_t quantityColumnNameSize = 32;
+
+		struct _FileHeader
+		{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t byteOrder;
+			std::uint64_t rowCount;
+			std::uint64_t columnCount;
+		};
+
+		struct _ColumnHeader
+		{
+			char name[quantityColumnNameSize];		//terminated by '\0'.
+			std::int32_t exponents[7];				//L, M, T, I, P, N, J.
+			std::uint32_t representation;			//see _RepresentationCode.
+			double multipleFactor;
+			std::uint64_t offset;					//of the values, from the beginning of the file.
+		};
+
+		static_assert(sizeof(_FileHeader) == 32 && sizeof(_ColumnHeader) == 80, "The file headers must have no padding.");
+
+		//------------------------------
+		//the code of a representation in _ColumnHeader, only for the ones of a fixed size on every platform.
+		template<typename Rep>
+		struct _RepresentationCode
+		{
+			static_assert(isTypeSame<Rep, void>, "A quantity file stores float, double, std::int32_t or std::int64_t.");
+		};
+
+		#define Define_RepresentationCode(type, code)				\
+		template<>													\
+		struct _RepresentationCode<type>							\
+		{															\
+			static const std::uint32_t resultValue = code;			\
+		};
+
+		Define_RepresentationCode(float, 1)
+		Define_RepresentationCode(double, 2)
+		Define_RepresentationCode(std::int32_t, 3)
+		Define_RepresentationCode(std::int64_t, 4)
+
+		#undef Define_RepresentationCode
+
+		inline std::size_t _representationSize(std::uint32_t code)
+		{
+			switch (code)
+			{
+			case 1: case 3: return 4;
+			case 2: case 4: return 8;
+			default: return 0;
+			}
+		}
+
+		inline std::uint64_t _alignFileOffset(std::uint64_t offset)
+		{
+			return (offset + quantityFileAlignment - 1) / quantityFileAlignment * quantityFileAlignment;
+		}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Mapping
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		//a whole file mapped read only, unmapped when it dies.
+		class _MappedFile
+		{
+		public:
+			_MappedFile() = default;
+			_MappedFile(const _MappedFile&) = delete;
+			_MappedFile(_MappedFile&& other) { *this = std::move(other); }
+			_MappedFile& operator = (const _MappedFile&) = delete;
+			_MappedFile& operator = (_MappedFile&& other)
+			{
+				std::swap(data_, other.data_);
+				std::swap(size_, other.size_);
+				return *this;
+			}
+			~_MappedFile() { close(); }
+
+			QuantityFileError open(const char* path);
+			void close();
+
+			const std::uint8_t* data() const { return data_; }
+			std::size_t size() const { return size_; }
+
+		private:
+			const std::uint8_t* data_ = nullptr;
+			std::size_t size_ = 0;
+		};
+
+#ifdef _WIN32
+		inline QuantityFileError _MappedFile::open(const char* path)
+		{
+			close();
+			const auto file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return QuantityFileError::CannotOpen;
+			LARGE_INTEGER size;
+			if (!::GetFileSizeEx(file, &size) || static_cast<unsigned long long>(size.QuadPart) > static_cast<std::size_t>(-1))
+			{
+				::CloseHandle(file);
+				return QuantityFileError::CannotMap;
+			}
+			//a mapping can't be empty, and an empty file is no quantity file anyway.
+			if (size.QuadPart == 0)
+			{
+				::CloseHandle(file);
+				return QuantityFileError::InvalidFormat;
+			}
+			//the view keeps the mapping alive, and the mapping the file.
+			const auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			::CloseHandle(file);
+			if (mapping == nullptr)
+				return QuantityFileError::CannotMap;
+			const auto view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			::CloseHandle(mapping);
+			if (view == nullptr)
+				return QuantityFileError::CannotMap;
+			data_ = static_cast<const std::uint8_t*>(view);
+			size_ = static_cast<std::size_t>(size.QuadPart);
+			return QuantityFileError::None;
+		}
+
+		inline void _MappedFile::close()
+		{
+			if (data_)
+				::UnmapViewOfFile(data_);
+			data_ = nullptr;
+			size_ = 0;
+		}
+#else
+		inline QuantityFileError _MappedFile::open(const char* path)
+		{
+			close();
+			const auto file = ::open(path, O_RDONLY | O_CLOEXEC);
+			if (file < 0)
+				return QuantityFileError::CannotOpen;
+			struct stat status;
+			if (::fstat(file, &status) != 0 || static_cast<unsigned long long>(status.st_size) > static_cast<std::size_t>(-1))
+			{
+				::close(file);
+				return QuantityFileError::CannotMap;
+			}
+			//a mapping can't be empty, and an empty file is no quantity file anyway.
+			if (status.st_size == 0)
+			{
+				::close(file);
+				return QuantityFileError::InvalidFormat;
+			}
+			//the mapping stays valid after the descriptor is closed.
+			const auto view = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+			::close(file);
+			if (view == MAP_FAILED)
+				return QuantityFileError::CannotMap;
+			data_ = static_cast<const std::uint8_t*>(view);
+			size_ = static_cast<std::size_t>(status.st_size);
+			return QuantityFileError::None;
+		}
+
+		inline void _MappedFile::close()
+		{
+			if (data_)
+				::munmap(const_cast<std::uint8_t*>(data_), size_);
+			data_ = nullptr;
+			size_ = 0;
+		}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Operand
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		template<typename _UnitType>
+		struct _Operand<QuantityColumn<_UnitType>>
+		{
+			static const bool isOperand = true;
+			static const bool isExpression = true;
+			typedef _UnitType UnitType;
+			template<typename Rep>
+			using NodeType = _ScaledArrayNode<_UnitType>;
+			template<typename Rep>
+			static const NodeType<Rep>& getNode(const QuantityColumn<_UnitType>& operand) { return operand.getNode(); }
+		};
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Classes definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//a column of a QuantityFile in "UnitType", a view over the mapped values that copies nothing.
+	//it is an operand of the operators and algorithms of QuantityArray,
+	//and refers to the mapping, so it must not outlive its QuantityFile.
+	template<typename _UnitType>
+	class QuantityColumn
+	{
+	public:
+		typedef _UnitType UnitType;
+		typedef typename UnitType::Rep Rep;
+
+		QuantityColumn() : node_(nullptr, 0, Rep(1)) { }
+		QuantityColumn(const Rep* values, std::size_t count, Rep factor) : node_(values, count, factor) { }
+
+		std::size_t size() const { return node_.count; }
+		bool empty() const { return node_.count == 0; }
+
+		//whether the file has another multiple factor, so every element is converted as it is read.
+		bool isConverted() const { return node_.factor != Rep(1); }
+
+		UnitType operator [] (std::size_t index) const { return UnitType(node_.values[index] * node_.factor); }
+
+		//the values as they are stored, which are in "UnitType" only if the column isn't converted.
+		//they are aligned to internal::quantityFileAlignment.
+		const UnitType* data() const
+		{
+			assert(!isConverted());
+			return reinterpret_cast<const UnitType*>(node_.values);
+		}
+
+		const internal::_ScaledArrayNode<UnitType>& getNode() const { return node_; }
+
+	private:
+		internal::_ScaledArrayNode<UnitType> node_;
+	};
+
+	//------------------------------
+	//the columns of a file to be written, which must all have the same number of quantities.
+	//it refers to the quantities until "write" returns.
+	//
+	//	unit::QuantityFileWriter writer;
+	//	if (writer.addColumn("time", time) != unit::QuantityFileError::None || writer.addColumn("power", power) != unit::QuantityFileError::None)
+	//		...
+	//	if (writer.write("power.qty") != unit::QuantityFileError::None)
+	//		...
+	class QuantityFileWriter
+	{
+	public:
+		//"name" is at most internal::quantityColumnNameSize - 1 characters.
+		//a column with another number of quantities than the first one is not added, and RowCountMismatch is returned.
+		template<typename _UnitType>
+		QuantityFileError addColumn(const char* name, const QuantityArray<_UnitType>& values) { return addColumn(name, values.data(), values.size()); }
+		template<typename _UnitType>
+		QuantityFileError addColumn(const char* name, const _UnitType* first, std::size_t count);
+
+		QuantityFileError write(const char* path) const;
+
+	private:
+		struct Column
+		{
+			internal::_ColumnHeader header;
+			const void* values;
+			std::size_t count;
+		};
+
+		std::vector<Column> columns_;
+	};
+
+	//------------------------------
+	//a file written by QuantityFileWriter, mapped into memory.
+	//
+	//	unit::QuantityFile file;
+	//	unit::QuantityColumn<unit::kW> power;
+	//	if (file.open("power.qty") != unit::QuantityFileError::None || file.column("power", power) != unit::QuantityFileError::None)
+	//		...
+	//	unit::kW average = unit::mean(power);
+	class QuantityFile
+	{
+	public:
+		//the headers are checked at once, and nothing else is read until it is used.
+		QuantityFileError open(const char* path);
+		void close();
+
+		std::size_t rowCount() const { return rowCount_; }
+		std::size_t columnCount() const { return columnCount_; }
+		const char* columnName(std::size_t index) const { return columnHeader(index).name; }
+
+		//the column "name", or the one at "index", as a view of "_UnitType", if it has the same dimension and representation.
+		template<typename _UnitType>
+		QuantityFileError column(const char* name, QuantityColumn<_UnitType>& result) const;
+		template<typename _UnitType>
+		QuantityFileError columnAt(std::size_t index, QuantityColumn<_UnitType>& result) const;
+
+	private:
+		const internal::_ColumnHeader& columnHeader(std::size_t index) const
+		{
+			assert(index < columnCount_);
+			return reinterpret_cast<const internal::_ColumnHeader*>(file_.data() + sizeof(internal::_FileHeader))[index];
+		}
+
+		internal::_MappedFile file_;
+		std::size_t rowCount_ = 0;
+		std::size_t columnCount_ = 0;
+	};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Members of QuantityFileWriter
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	template<typename _UnitType>
+	inline QuantityFileError QuantityFileWriter::addColumn(const char* name, const _UnitType* first, std::size_t count)
+	{
+		typedef typename _UnitType::Dimension D;
+		assert(std::strlen(name) < internal::quantityColumnNameSize);
+		if (!columns_.empty() && columns_.front().count != count)
+			return QuantityFileError::RowCountMismatch;
+		Column column = {};
+		std::strncpy(column.header.name, name, internal::quantityColumnNameSize - 1);
+		const std::int32_t exponents[7] = { D::L, D::M, D::T, D::I, D::P, D::N, D::J };
+		std::memcpy(column.header.exponents, exponents, sizeof(exponents));
+		column.header.representation = internal::_RepresentationCode<typename _UnitType::Rep>::resultValue;
+		column.header.multipleFactor = static_cast<double>(_UnitType::multipleFactor);
+		column.values = first;
+		column.count = count;
+		columns_.push_back(column);
+		return QuantityFileError::None;
+	}
+
+	inline QuantityFileError QuantityFileWriter::write(const char* path) const
+	{
+		internal::_FileHeader header = {};
+		std::memcpy(header.magic, internal::quantityFileMagic, sizeof(header.magic));
+		header.version = internal::quantityFileVersion;
+		header.byteOrder = internal::quantityFileByteOrder;
+		header.rowCount = columns_.empty() ? 0 : columns_.front().count;
+		header.columnCount = columns_.size();
+
+		std::vector<internal::_ColumnHeader> columnHeaders;
+		columnHeaders.reserve(columns_.size());
+		auto offset = sizeof(internal::_FileHeader) + columns_.size() * sizeof(internal::_ColumnHeader);
+		for (auto& i : columns_)
+		{
+			offset = internal::_alignFileOffset(offset);
+			columnHeaders.push_back(i.header);
+			columnHeaders.back().offset = offset;
+			offset += i.count * internal::_representationSize(i.header.representation);
+		}
+
+		const auto file = std::fopen(path, "wb");
+		if (file == nullptr)
+			return QuantityFileError::CannotOpen;
+		bool succeeded = std::fwrite(&header, sizeof(header), 1, file) == 1
+			&& (columnHeaders.empty() || std::fwrite(columnHeaders.data(), sizeof(internal::_ColumnHeader), columnHeaders.size(), file) == columnHeaders.size());
+		auto position = sizeof(internal::_FileHeader) + columns_.size() * sizeof(internal::_ColumnHeader);
+		const char padding[internal::quantityFileAlignment] = {};
+		for (std::size_t i = 0; succeeded && i < columns_.size(); i++)
+		{
+			const auto paddingSize = static_cast<std::size_t>(columnHeaders[i].offset - position);
+			const auto valuesSize = columns_[i].count * internal::_representationSize(columns_[i].header.representation);
+			succeeded = (paddingSize == 0 || std::fwrite(padding, 1, paddingSize, file) == paddingSize)
+				&& (valuesSize == 0 || std::fwrite(columns_[i].values, 1, valuesSize, file) == valuesSize);
+			position = columnHeaders[i].offset + valuesSize;
+		}
+		succeeded = std::fclose(file) == 0 && succeeded;
+		return succeeded ? QuantityFileError::None : QuantityFileError::CannotOpen;
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Members of QuantityFile
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	inline QuantityFileError QuantityFile::open(const char* path)
+	{
+		close();
+		const auto error = file_.open(path);
+		if (error != QuantityFileError::None)
+			return error;
+
+		//every column is checked to lie in the file, so a damaged file is an error here and not a crash later.
+		internal::_FileHeader header;
+		bool isValid = file_.size() >= sizeof(header);
+		if (isValid)
+		{
+			std::memcpy(&header, file_.data(), sizeof(header));
+			isValid = std::memcmp(header.magic, internal::quantityFileMagic, sizeof(header.magic)) == 0
+				&& header.version == internal::quantityFileVersion && header.byteOrder == internal::quantityFileByteOrder
+				&& header.columnCount <= (file_.size() - sizeof(header)) / sizeof(internal::_ColumnHeader);
+		}
+		for (std::uint64_t i = 0; isValid && i < header.columnCount; i++)
+		{
+			const auto& column = reinterpret_cast<const internal::_ColumnHeader*>(file_.data() + sizeof(header))[i];
+			const auto elementSize = internal::_representationSize(column.representation);
+			isValid = elementSize != 0 && std::memchr(column.name, '\0', sizeof(column.name)) != nullptr
+				&& column.offset % internal::quantityFileAlignment == 0 && column.offset <= file_.size()
+				&& header.rowCount <= (file_.size() - column.offset) / elementSize;
+		}
+		if (!isValid)
+		{
+			file_.close();
+			return QuantityFileError::InvalidFormat;
+		}
+		rowCount_ = static_cast<std::size_t>(header.rowCount);
+		columnCount_ = static_cast<std::size_t>(header.columnCount);
+		return QuantityFileError::None;
+	}
+
+	inline void QuantityFile::close()
+	{
+		file_.close();
+		rowCount_ = 0;
+		columnCount_ = 0;
+	}
+
+	template<typename _UnitType>
+	inline QuantityFileError QuantityFile::column(const char* name, QuantityColumn<_UnitType>& result) const
+	{
+		for (std::size_t i = 0; i < columnCount_; i++)
+			if (std::strcmp(columnHeader(i).name, name) == 0)
+				return columnAt(i, result);
+		return QuantityFileError::UnknownColumn;
+	}
+
+	template<typename _UnitType>
+	inline QuantityFileError QuantityFile::columnAt(std::size_t index, QuantityColumn<_UnitType>& result) const
+	{
+		typedef typename _UnitType::Dimension D;
+		typedef typename _UnitType::Rep Rep;
+		if (index >= columnCount_)
+			return QuantityFileError::UnknownColumn;
+		const auto& header = columnHeader(index);
+
+		const std::int32_t exponents[7] = { D::L, D::M, D::T, D::I, D::P, D::N, D::J };
+		if (std::memcmp(header.exponents, exponents, sizeof(exponents)) != 0)
+			return QuantityFileError::DimensionMismatch;
+		if (header.representation != internal::_RepresentationCode<Rep>::resultValue)
+			return QuantityFileError::RepresentationMismatch;
+
+		//the same tolerance as the text formatter, as a multiple factor may have been rounded to a double.
+		const auto ratio = header.multipleFactor / static_cast<double>(_UnitType::multipleFactor);
+		const auto isSame = std::abs(ratio - 1.0) <= 1e-12;
+		if (!isSame && std::is_integral<Rep>::value)
+			return QuantityFileError::ScaleMismatch;
+
+		result = QuantityColumn<_UnitType>(reinterpret_cast<const Rep*>(file_.data() + header.offset), rowCount_, isSame ? Rep(1) : static_cast<Rep>(ratio));
+		return QuantityFileError::None;
+	}
+}
@@ -0,0 +1,161 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "QuantityFile.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	const char filePath[] = "QuantityFileTest.qty";
+	const char damagedPath[] = "QuantityFileTest.damaged.qty";
+
+	std::vector<char> readFile(const char* path)
+	{
+		std::vector<char> result;
+		if (const auto file = std::fopen(path, "rb"))
+		{
+			char buffer[4096];
+			std::size_t count;
+			while ((count = std::fread(buffer, 1, sizeof(buffer), file)) != 0)
+				result.insert(result.end(), buffer, buffer + count);
+			std::fclose(file);
+		}
+		return result;
+	}
+
+	void writeFile(const char* path, const std::vector<char>& bytes)
+	{
+		if (const auto file = std::fopen(path, "wb"))
+		{
+			std::fwrite(bytes.data(), 1, bytes.size(), file);
+			std::fclose(file);
+		}
+	}
+
+	//a file of three columns in different representations.
+	QuantityFileError writeSample(std::size_t rowCount)
+	{
+		QuantityArray<km> distance(rowCount);
+		QuantityArray<WithRep<s, std::int64_t>> time(rowCount);
+		QuantityArray<WithRep<W, float>> power(rowCount);
+		for (std::size_t i = 0; i < rowCount; i++)
+		{
+			distance[i] = km(i * 0.5);
+			time[i] = WithRep<s, std::int64_t>(static_cast<std::int64_t>(i));
+			power[i] = WithRep<W, float>(static_cast<float>(i % 100));
+		}
+		QuantityFileWriter writer;
+		if (writer.addColumn("distance", distance) != QuantityFileError::None || writer.addColumn("time", time) != QuantityFileError::None
+			|| writer.addColumn("power", power) != QuantityFileError::None)
+			return QuantityFileError::RowCountMismatch;
+		return writer.write(filePath);
+	}
+}
+
+UNIT_TEST(QuantityFileRoundTrip)
+{
+	const std::size_t rowCount = 1001;
+	UNIT_CHECK(writeSample(rowCount) == QuantityFileError::None);
+	{
+		QuantityFile file;
+		UNIT_CHECK(file.open(filePath) == QuantityFileError::None);
+		UNIT_CHECK(file.rowCount() == rowCount && file.columnCount() == 3);
+		UNIT_CHECK(std::strcmp(file.columnName(1), "time") == 0);
+
+		QuantityColumn<km> distance;
+		UNIT_CHECK(file.column("distance", distance) == QuantityFileError::None);
+		UNIT_CHECK(!distance.isConverted() && distance.size() == rowCount && distance[1000].value == 500);
+		UNIT_CHECK(reinterpret_cast<std::uintptr_t>(distance.data()) % internal::quantityFileAlignment == 0);
+		//another multiple factor is converted as it is read.
+		QuantityColumn<m> meters;
+		UNIT_CHECK(file.columnAt(0, meters) == QuantityFileError::None);
+		UNIT_CHECK(meters.isConverted() && meters[3].value == 1500);
+		const QuantityArray<m> total = distance + meters;
+		UNIT_CHECK(total[2].value == 2000);
+
+		QuantityColumn<WithRep<s, std::int64_t>> time;
+		UNIT_CHECK(file.column("time", time) == QuantityFileError::None && time[77].value == 77);
+		QuantityColumn<WithRep<W, float>> power;
+		UNIT_CHECK(file.column("power", power) == QuantityFileError::None && power[142].value == 42.0f);
+
+		QuantityColumn<s> seconds;
+		UNIT_CHECK(file.column("distance", seconds) == QuantityFileError::DimensionMismatch);
+		UNIT_CHECK(file.column("time", seconds) == QuantityFileError::RepresentationMismatch);
+		QuantityColumn<WithRep<ms, std::int64_t>> milliseconds;
+		UNIT_CHECK(file.column("time", milliseconds) == QuantityFileError::ScaleMismatch);
+		UNIT_CHECK(file.column("speed", seconds) == QuantityFileError::UnknownColumn);
+		UNIT_CHECK(file.columnAt(3, seconds) == QuantityFileError::UnknownColumn);
+	}
+
+	QuantityFileWriter empty;
+	UNIT_CHECK(empty.write(filePath) == QuantityFileError::None);
+	QuantityFile file;
+	UNIT_CHECK(file.open(filePath) == QuantityFileError::None && file.columnCount() == 0 && file.rowCount() == 0);
+	file.close();
+	std::remove(filePath);
+}
+
+UNIT_TEST(QuantityFileWriterRejectsRowCountMismatch)
+{
+	const QuantityArray<m> distance(10);
+	const QuantityArray<s> time(9);
+	QuantityFileWriter writer;
+	UNIT_CHECK(writer.addColumn("distance", distance) == QuantityFileError::None);
+	UNIT_CHECK(writer.addColumn("time", time) == QuantityFileError::RowCountMismatch);
+	//the column was not added.
+	UNIT_CHECK(writer.write(filePath) == QuantityFileError::None);
+	QuantityFile file;
+	UNIT_CHECK(file.open(filePath) == QuantityFileError::None && file.columnCount() == 1 && file.rowCount() == 10);
+	file.close();
+	std::remove(filePath);
+}
+
+UNIT_TEST(QuantityFileRejectsDamagedFiles)
+{
+	QuantityFile file;
+	UNIT_CHECK(file.open("QuantityFileTest.missing.qty") == QuantityFileError::CannotOpen);
+
+	UNIT_CHECK(writeSample(100) == QuantityFileError::None);
+	const auto bytes = readFile(filePath);
+	UNIT_CHECK(bytes.size() > sizeof(internal::_FileHeader) + 3 * sizeof(internal::_ColumnHeader));
+
+	//shorter than a header, another magic, another version, and the values cut off.
+	writeFile(damagedPath, std::vector<char>(bytes.begin(), bytes.begin() + 8));
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+	auto damaged = bytes;
+	damaged[0] ^= 1;
+	writeFile(damagedPath, damaged);
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+	damaged = bytes;
+	damaged[offsetof(internal::_FileHeader, version)] ^= 1;
+	writeFile(damagedPath, damaged);
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+	writeFile(damagedPath, std::vector<char>(bytes.begin(), bytes.end() - 1));
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+
+	//more columns than the file has room for, a column past the end, and a name without its '\0'.
+	damaged = bytes;
+	damaged[offsetof(internal::_FileHeader, columnCount) + 4] = 1;
+	writeFile(damagedPath, damaged);
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+	damaged = bytes;
+	const auto firstColumn = sizeof(internal::_FileHeader);
+	damaged[firstColumn + offsetof(internal::_ColumnHeader, offset) + 2] = 1;
+	writeFile(damagedPath, damaged);
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+	damaged = bytes;
+	std::memset(&damaged[firstColumn + offsetof(internal::_ColumnHeader, name)], 'x', internal::quantityColumnNameSize);
+	writeFile(damagedPath, damaged);
+	UNIT_CHECK(file.open(damagedPath) == QuantityFileError::InvalidFormat);
+
+	//the file itself still opens.
+	UNIT_CHECK(file.open(filePath) == QuantityFileError::None && file.rowCount() == 100);
+	file.close();
+	std::remove(filePath);
+	std::remove(damagedPath);
+}
@@ -0,0 +1,579 @@
+//Element-wise kernels over the arrays of values used by QuantityArray.
+//Every kernel has a scalar version for any representation, and SSE2 and AVX2 versions for float and double,
+//and the best one the processor supports is picked at run time.
+//A kernel evaluates a whole expression tree of QuantityArray in one pass, into an array or into a sum.
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "SystemOfUnits.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || (defined(__i386__) && defined(__SSE2__))
+#define UNIT_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//msvc compiles intrinsics of any instruction set anywhere,
+//while gcc and clang need the functions using them marked.
+#if defined(UNIT_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define UNIT_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define UNIT_SIMD_TARGET_AVX2
+#endif
+
+namespace unit
+{
+	namespace internal
+	{
+		namespace simd
+		{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Instruction set selection
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			enum class Level
+			{
+				Scalar,
+				Sse2,
+				Avx2
+			};
+
+			inline Level _detectLevel()
+			{
+#ifdef UNIT_SIMD_X86
+#if defined(__GNUC__) || defined(__clang__)
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("avx2"))
+					return Level::Avx2;
+#else
+				int info[4];
+				__cpuid(info, 0);
+				if (info[0] >= 7)
+				{
+					__cpuid(info, 1);
+					const bool osSavesAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+					__cpuidex(info, 7, 0);
+					if (osSavesAvx && (info[1] & (1 << 5)))
+						return Level::Avx2;
+				}
+#endif
+				return Level::Sse2;
+#else
+				return Level::Scalar;
+#endif
+			}
+
+			inline Level& _currentLevel()
+			{
+				static Level level = _detectLevel();
+				return level;
+			}
+
+			//the instruction set the kernels use.
+			inline Level getLevel() { return _currentLevel(); }
+
+			//use a lower instruction set than the detected one, for example to check the scalar fallback.
+			//a level the processor doesn't support is lowered to the detected one.
+			//not synchronized with running kernels.
+			inline void setLevel(Level level)
+			{
+				const auto supported = _detectLevel();
+				_currentLevel() = level < supported ? level : supported;
+			}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Lanes
+//the primitives of one instruction set for elements of type "T": "Vector" holds "width" values.
+//an expression is evaluated with each of them by overloads taking the lanes as the first argument.
+//every representation has ScalarLanes, and float and double have SSE2 and AVX2 ones too.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			template<typename T>
+			struct ScalarLanes
+			{
+				typedef T Vector;
+				static const std::size_t width = 1;
+
+				static Vector load(const T* source) { return *source; }
+				static void store(T* destination, Vector value) { *destination = value; }
+				static Vector broadcast(T value) { return value; }
+				static Vector multiply(Vector left, Vector right) { return left * right; }
+				static Vector divide(Vector left, Vector right) { return left / right; }
+				static Vector sqrt(Vector value) { return std::sqrt(value); }
+				static Vector absolute(Vector value) { return std::abs(value); }
+				//"right" where either is NaN, as the instructions of SSE2 and AVX2 give.
+				static Vector maximum(Vector left, Vector right) { return left > right ? left : right; }
+				static Vector minimum(Vector left, Vector right) { return left < right ? left : right; }
+				//a comparison gives a non zero value where it holds.
+				static void storeMask(std::uint8_t* destination, Vector mask) { *destination = mask != 0 ? 1 : 0; }
+				//convert to another multiple factor exactly as Unit does, with its overflow checks for integers.
+				template<typename Factor>
+				static Vector convert(Vector value) { return Factor::convert(value); }
+			};
+
+			template<typename T>
+			struct Sse2Lanes;
+
+			template<typename T>
+			struct Avx2Lanes;
+
+			//macro to define "convert" of SIMD lanes from their multiply, divide and broadcast,
+			//giving the same results as ConversionFactor::convert does for a float.
+			#define Define_LanesConvert(attribute)																	\
+			template<typename Factor>																				\
+			attribute static Vector convert(Vector value)															\
+			{																										\
+				return Factor::kind == ConversionKind::None ? value													\
+					: Factor::kind == ConversionKind::Multiply ? multiply(value, broadcast(static_cast<T>(Factor::num)))	\
+					: Factor::kind == ConversionKind::Divide ? divide(value, broadcast(static_cast<T>(Factor::den)))		\
+					: Factor::kind == ConversionKind::MultiplyDivide														\
+						? divide(multiply(value, broadcast(static_cast<T>(Factor::num))), broadcast(static_cast<T>(Factor::den)))	\
+					: multiply(value, broadcast(static_cast<T>(Factor::scale)));										\
+			}
+
+#ifdef UNIT_SIMD_X86
+			template<>
+			struct Sse2Lanes<double>
+			{
+				typedef double T;
+				typedef __m128d Vector;
+				static const std::size_t width = 2;
+
+				static Vector load(const T* source) { return _mm_loadu_pd(source); }
+				static void store(T* destination, Vector value) { _mm_storeu_pd(destination, value); }
+				static Vector broadcast(T value) { return _mm_set1_pd(value); }
+				static Vector multiply(Vector left, Vector right) { return _mm_mul_pd(left, right); }
+				static Vector divide(Vector left, Vector right) { return _mm_div_pd(left, right); }
+				static Vector sqrt(Vector value) { return _mm_sqrt_pd(value); }
+				static Vector absolute(Vector value) { return _mm_andnot_pd(_mm_set1_pd(-0.0), value); }
+				static Vector maximum(Vector left, Vector right) { return _mm_max_pd(left, right); }
+				static Vector minimum(Vector left, Vector right) { return _mm_min_pd(left, right); }
+				//a comparison gives all ones in a lane where it holds.
+				static void storeMask(std::uint8_t* destination, Vector mask)
+				{
+					const auto bits = _mm_movemask_pd(mask);
+					for (std::size_t i = 0; i < width; i++)
+						destination[i] = (bits >> i) & 1;
+				}
+				Define_LanesConvert()
+			};
+
+			template<>
+			struct Sse2Lanes<float>
+			{
+				typedef float T;
+				typedef __m128 Vector;
+				static const std::size_t width = 4;
+
+				static Vector load(const T* source) { return _mm_loadu_ps(source); }
+				static void store(T* destination, Vector value) { _mm_storeu_ps(destination, value); }
+				static Vector broadcast(T value) { return _mm_set1_ps(value); }
+				static Vector multiply(Vector left, Vector right) { return _mm_mul_ps(left, right); }
+				static Vector divide(Vector left, Vector right) { return _mm_div_ps(left, right); }
+				static Vector sqrt(Vector value) { return _mm_sqrt_ps(value); }
+				static Vector absolute(Vector value) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), value); }
+				static Vector maximum(Vector left, Vector right) { return _mm_max_ps(left, right); }
+				static Vector minimum(Vector left, Vector right) { return _mm_min_ps(left, right); }
+				static void storeMask(std::uint8_t* destination, Vector mask)
+				{
+					const auto bits = _mm_movemask_ps(mask);
+					for (std::size_t i = 0; i < width; i++)
+						destination[i] = (bits >> i) & 1;
+				}
+				Define_LanesConvert()
+			};
+
+			template<>
+			struct Avx2Lanes<double>
+			{
+				typedef double T;
+				typedef __m256d Vector;
+				static const std::size_t width = 4;
+
+				UNIT_SIMD_TARGET_AVX2 static Vector load(const T* source) { return _mm256_loadu_pd(source); }
+				UNIT_SIMD_TARGET_AVX2 static void store(T* destination, Vector value) { _mm256_storeu_pd(destination, value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector broadcast(T value) { return _mm256_set1_pd(value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector multiply(Vector left, Vector right) { return _mm256_mul_pd(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector divide(Vector left, Vector right) { return _mm256_div_pd(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector sqrt(Vector value) { return _mm256_sqrt_pd(value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector absolute(Vector value) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector maximum(Vector left, Vector right) { return _mm256_max_pd(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector minimum(Vector left, Vector right) { return _mm256_min_pd(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static void storeMask(std::uint8_t* destination, Vector mask)
+				{
+					const auto bits = _mm256_movemask_pd(mask);
+					for (std::size_t i = 0; i < width; i++)
+						destination[i] = (bits >> i) & 1;
+				}
+				Define_LanesConvert(UNIT_SIMD_TARGET_AVX2)
+			};
+
+			template<>
+			struct Avx2Lanes<float>
+			{
+				typedef float T;
+				typedef __m256 Vector;
+				static const std::size_t width = 8;
+
+				UNIT_SIMD_TARGET_AVX2 static Vector load(const T* source) { return _mm256_loadu_ps(source); }
+				UNIT_SIMD_TARGET_AVX2 static void store(T* destination, Vector value) { _mm256_storeu_ps(destination, value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector broadcast(T value) { return _mm256_set1_ps(value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector multiply(Vector left, Vector right) { return _mm256_mul_ps(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector divide(Vector left, Vector right) { return _mm256_div_ps(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector sqrt(Vector value) { return _mm256_sqrt_ps(value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector absolute(Vector value) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value); }
+				UNIT_SIMD_TARGET_AVX2 static Vector maximum(Vector left, Vector right) { return _mm256_max_ps(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static Vector minimum(Vector left, Vector right) { return _mm256_min_ps(left, right); }
+				UNIT_SIMD_TARGET_AVX2 static void storeMask(std::uint8_t* destination, Vector mask)
+				{
+					const auto bits = _mm256_movemask_ps(mask);
+					for (std::size_t i = 0; i < width; i++)
+						destination[i] = (bits >> i) & 1;
+				}
+				Define_LanesConvert(UNIT_SIMD_TARGET_AVX2)
+			};
+
+			//whether elements of type "T" have SIMD lanes.
+			template<typename T>
+			struct HasSimdLanes
+			{
+				static const bool resultValue = isTypeSame<T, double> || isTypeSame<T, float>;
+				DEFINERESULTTYPE;
+			};
+#else
+			template<typename T>
+			struct HasSimdLanes
+			{
+				static const bool resultValue = false;
+				DEFINERESULTTYPE;
+			};
+#endif
+
+			#undef Define_LanesConvert
+
+			//macro to define the member functions "evaluate" of an expression node for every instruction set.
+			//"lanes" is the lanes argument and "index" the first element to evaluate.
+			//the body is the same for all of them, so write it with "decltype(lanes)".
+			//they are templates, so only the lanes of the representation of the node are ever instantiated.
+			#ifdef UNIT_SIMD_X86
+			#define Define_EvaluateFunctions(...)																					\
+			template<typename T>																									\
+			T evaluate(unit::internal::simd::ScalarLanes<T> lanes, std::size_t index) const __VA_ARGS__								\
+			template<typename T>																									\
+			typename unit::internal::simd::Sse2Lanes<T>::Vector evaluate(unit::internal::simd::Sse2Lanes<T> lanes, std::size_t index) const __VA_ARGS__	\
+			template<typename T>																									\
+			UNIT_SIMD_TARGET_AVX2 typename unit::internal::simd::Avx2Lanes<T>::Vector evaluate(unit::internal::simd::Avx2Lanes<T> lanes, std::size_t index) const __VA_ARGS__
+			#else
+			#define Define_EvaluateFunctions(...)																					\
+			template<typename T>																									\
+			T evaluate(unit::internal::simd::ScalarLanes<T> lanes, std::size_t index) const __VA_ARGS__
+			#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Operations
+//every operation has "apply" for every lanes.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			//macro to define an operation from its scalar expression, its sse2 intrinsics and its avx2 ones, for double and float.
+			//"left" and "right" are the operands, and "T" the type of the scalar ones.
+			#ifdef UNIT_SIMD_X86
+			#define Define_Operation(className, scalarExpression, sse2Double, sse2Float, avx2Double, avx2Float)								\
+			struct className																										\
+			{																														\
+				template<typename T>																								\
+				static T apply(ScalarLanes<T>, T left, T right) { return scalarExpression; }										\
+				static __m128d apply(Sse2Lanes<double>, __m128d left, __m128d right) { return sse2Double; }							\
+				static __m128 apply(Sse2Lanes<float>, __m128 left, __m128 right) { return sse2Float; }								\
+				UNIT_SIMD_TARGET_AVX2 static __m256d apply(Avx2Lanes<double>, __m256d left, __m256d right) { return avx2Double; }	\
+				UNIT_SIMD_TARGET_AVX2 static __m256 apply(Avx2Lanes<float>, __m256 left, __m256 right) { return avx2Float; }		\
+			};
+			#else
+			#define Define_Operation(className, scalarExpression, sse2Double, sse2Float, avx2Double, avx2Float)								\
+			struct className																										\
+			{																														\
+				template<typename T>																								\
+				static T apply(ScalarLanes<T>, T left, T right) { return scalarExpression; }										\
+			};
+			#endif
+
+			Define_Operation(AddOperation, left + right,
+				_mm_add_pd(left, right), _mm_add_ps(left, right), _mm256_add_pd(left, right), _mm256_add_ps(left, right))
+			Define_Operation(SubtractOperation, left - right,
+				_mm_sub_pd(left, right), _mm_sub_ps(left, right), _mm256_sub_pd(left, right), _mm256_sub_ps(left, right))
+			Define_Operation(MultiplyOperation, left * right,
+				_mm_mul_pd(left, right), _mm_mul_ps(left, right), _mm256_mul_pd(left, right), _mm256_mul_ps(left, right))
+			Define_Operation(DivideOperation, left / right,
+				_mm_div_pd(left, right), _mm_div_ps(left, right), _mm256_div_pd(left, right), _mm256_div_ps(left, right))
+
+			//comparisons give a mask, see storeMask of the lanes.
+			//all of them are false for NaN except "not equal".
+			Define_Operation(EqualOperation, left == right ? T(1) : T(0),
+				_mm_cmpeq_pd(left, right), _mm_cmpeq_ps(left, right), _mm256_cmp_pd(left, right, _CMP_EQ_OQ), _mm256_cmp_ps(left, right, _CMP_EQ_OQ))
+			Define_Operation(NotEqualOperation, left != right ? T(1) : T(0),
+				_mm_cmpneq_pd(left, right), _mm_cmpneq_ps(left, right), _mm256_cmp_pd(left, right, _CMP_NEQ_UQ), _mm256_cmp_ps(left, right, _CMP_NEQ_UQ))
+			Define_Operation(LessOperation, left < right ? T(1) : T(0),
+				_mm_cmplt_pd(left, right), _mm_cmplt_ps(left, right), _mm256_cmp_pd(left, right, _CMP_LT_OQ), _mm256_cmp_ps(left, right, _CMP_LT_OQ))
+			Define_Operation(LessEqualOperation, left <= right ? T(1) : T(0),
+				_mm_cmple_pd(left, right), _mm_cmple_ps(left, right), _mm256_cmp_pd(left, right, _CMP_LE_OQ), _mm256_cmp_ps(left, right, _CMP_LE_OQ))
+			Define_Operation(GreaterOperation, left > right ? T(1) : T(0),
+				_mm_cmpgt_pd(left, right), _mm_cmpgt_ps(left, right), _mm256_cmp_pd(left, right, _CMP_GT_OQ), _mm256_cmp_ps(left, right, _CMP_GT_OQ))
+			Define_Operation(GreaterEqualOperation, left >= right ? T(1) : T(0),
+				_mm_cmpge_pd(left, right), _mm_cmpge_ps(left, right), _mm256_cmp_pd(left, right, _CMP_GE_OQ), _mm256_cmp_ps(left, right, _CMP_GE_OQ))
+
+			#undef Define_Operation
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Kernels
+//a kernel runs a whole expression over every element in one pass, "width" elements at a time,
+//so no intermediate result is ever stored.
+//an expression is anything with "evaluate" defined by Define_EvaluateFunctions.
+//pointers need no alignment, and "result" may be read by the expression at the same index.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			//------------------------------
+			template<typename Expression, typename T>
+			inline void _evaluateScalar(const Expression& expression, T* result, std::size_t begin, std::size_t end)
+			{
+				for (auto i = begin; i < end; i++)
+					result[i] = expression.evaluate(ScalarLanes<T>(), i);
+			}
+
+			template<typename T, typename Expression>
+			inline void _evaluateMaskScalar(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end)
+			{
+				for (auto i = begin; i < end; i++)
+					ScalarLanes<T>::storeMask(result + i, expression.evaluate(ScalarLanes<T>(), i));
+			}
+
+#ifdef UNIT_SIMD_X86
+			//------------------------------
+			template<typename Expression, typename T>
+			inline void _evaluateSse2(const Expression& expression, T* result, std::size_t begin, std::size_t end)
+			{
+				typedef Sse2Lanes<T> Lanes;
+				auto i = begin;
+				for (; i + Lanes::width <= end; i += Lanes::width)
+					Lanes::store(result + i, expression.evaluate(Lanes(), i));
+				_evaluateScalar(expression, result, i, end);
+			}
+
+			template<typename T, typename Expression>
+			inline void _evaluateMaskSse2(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end)
+			{
+				typedef Sse2Lanes<T> Lanes;
+				auto i = begin;
+				for (; i + Lanes::width <= end; i += Lanes::width)
+					Lanes::storeMask(result + i, expression.evaluate(Lanes(), i));
+				_evaluateMaskScalar<T>(expression, result, i, end);
+			}
+
+			//------------------------------
+			template<typename Expression, typename T>
+			UNIT_SIMD_TARGET_AVX2 inline void _evaluateAvx2(const Expression& expression, T* result, std::size_t begin, std::size_t end)
+			{
+				typedef Avx2Lanes<T> Lanes;
+				auto i = begin;
+				for (; i + Lanes::width <= end; i += Lanes::width)
+					Lanes::store(result + i, expression.evaluate(Lanes(), i));
+				_evaluateScalar(expression, result, i, end);
+			}
+
+			template<typename T, typename Expression>
+			UNIT_SIMD_TARGET_AVX2 inline void _evaluateMaskAvx2(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end)
+			{
+				typedef Avx2Lanes<T> Lanes;
+				auto i = begin;
+				for (; i + Lanes::width <= end; i += Lanes::width)
+					Lanes::storeMask(result + i, expression.evaluate(Lanes(), i));
+				_evaluateMaskScalar<T>(expression, result, i, end);
+			}
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Reductions
+//a sum kernel adds every element of a block into "reductionAccumulatorCount" independent vectors,
+//so the additions don't wait for each other, then adds the block sum to a CompensatedSum.
+//the error stays that of a short plain sum however long the range is.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			constexpr std::size_t reductionBlockSize = 256;
+			constexpr std::size_t reductionAccumulatorCount = 4;
+
+			//a running sum that keeps the rounding error of every addition and adds it back at the end,
+			//by the Neumaier variant of Kahan summation.
+			template<typename T, bool = std::is_floating_point<T>::value>
+			struct CompensatedSum
+			{
+				T sum = T();
+				T compensation = T();
+
+				void add(T value)
+				{
+					const T total = sum + value;
+					if (std::abs(sum) >= std::abs(value))
+						compensation += (sum - total) + value;
+					else
+						compensation += (value - total) + sum;
+					sum = total;
+				}
+
+				void add(const CompensatedSum& other)
+				{
+					add(other.sum);
+					compensation += other.compensation;
+				}
+
+				T get() const { return sum + compensation; }
+			};
+
+			//integers add exactly, so there is nothing to compensate.
+			template<typename T>
+			struct CompensatedSum<T, false>
+			{
+				T sum = T();
+
+				void add(T value) { sum += value; }
+				void add(const CompensatedSum& other) { sum += other.sum; }
+				T get() const { return sum; }
+			};
+
+			//add "count" values, a power of two, in pairs, overwriting them.
+			template<typename T>
+			inline T _pairwiseSum(T* values, std::size_t count)
+			{
+				for (; count > 1; count /= 2)
+					for (std::size_t i = 0; i < count / 2; i++)
+						values[i] += values[i + count / 2];
+				return values[0];
+			}
+
+			//macro to define the sum kernel of a lanes template, see above.
+			#define Define_SumKernel(name, LanesTemplate, attribute)																\
+			template<typename T, typename Expression>																				\
+			attribute inline void name(const Expression& expression, std::size_t begin, std::size_t end, CompensatedSum<T>& result)	\
+			{																														\
+				typedef LanesTemplate<T> Lanes;																						\
+				const std::size_t step = reductionAccumulatorCount * Lanes::width;													\
+				static_assert(reductionBlockSize % (reductionAccumulatorCount * Lanes::width) == 0, "A block must be whole steps.");	\
+				auto i = begin;																										\
+				for (; i + reductionBlockSize <= end; i += reductionBlockSize)														\
+				{																													\
+					typename Lanes::Vector accumulators[reductionAccumulatorCount];													\
+					for (auto& accumulator : accumulators)																			\
+						accumulator = Lanes::broadcast(T());																		\
+					for (std::size_t j = 0; j < reductionBlockSize; j += step)														\
+						for (std::size_t k = 0; k < reductionAccumulatorCount; k++)												\
+							accumulators[k] = AddOperation::apply(Lanes(), accumulators[k], expression.evaluate(Lanes(), i + j + k * Lanes::width));	\
+					T values[reductionAccumulatorCount * Lanes::width];																\
+					for (std::size_t k = 0; k < reductionAccumulatorCount; k++)													\
+						Lanes::store(values + k * Lanes::width, accumulators[k]);													\
+					result.add(_pairwiseSum(values, step));																			\
+				}																													\
+				for (; i < end; i++)																								\
+					result.add(expression.evaluate(ScalarLanes<T>(), i));															\
+			}
+
+			Define_SumKernel(_sumScalar, ScalarLanes, )
+#ifdef UNIT_SIMD_X86
+			Define_SumKernel(_sumSse2, Sse2Lanes, )
+			Define_SumKernel(_sumAvx2, Avx2Lanes, UNIT_SIMD_TARGET_AVX2)
+#endif
+
+			#undef Define_SumKernel
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Dispatchers
+//a representation without SIMD lanes, such as long double or an integer, always runs the scalar kernels.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef UNIT_SIMD_X86
+			#define UNIT_SIMD_DISPATCH(kernel, arguments)				\
+			switch (getLevel())											\
+			{															\
+			case Level::Avx2: kernel##Avx2 arguments; return;			\
+			case Level::Sse2: kernel##Sse2 arguments; return;			\
+			default: kernel##Scalar arguments; return;					\
+			}
+#else
+			#define UNIT_SIMD_DISPATCH(kernel, arguments) kernel##Scalar arguments;
+#endif
+
+			//------------------------------
+			template<typename Expression, typename T>
+			inline void _evaluate(const Expression& expression, T* result, std::size_t begin, std::size_t end, YesType)
+			{
+				UNIT_SIMD_DISPATCH(_evaluate, (expression, result, begin, end))
+			}
+
+			template<typename Expression, typename T>
+			inline void _evaluate(const Expression& expression, T* result, std::size_t begin, std::size_t end, NoType)
+			{
+				_evaluateScalar(expression, result, begin, end);
+			}
+
+			template<typename T, typename Expression>
+			inline void _evaluateMask(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end, YesType)
+			{
+				UNIT_SIMD_DISPATCH(_evaluateMask, <T>(expression, result, begin, end))
+			}
+
+			template<typename T, typename Expression>
+			inline void _evaluateMask(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end, NoType)
+			{
+				_evaluateMaskScalar<T>(expression, result, begin, end);
+			}
+
+			template<typename T, typename Expression>
+			inline void _sum(const Expression& expression, std::size_t begin, std::size_t end, CompensatedSum<T>& result, YesType)
+			{
+				UNIT_SIMD_DISPATCH(_sum, <T>(expression, begin, end, result))
+			}
+
+			template<typename T, typename Expression>
+			inline void _sum(const Expression& expression, std::size_t begin, std::size_t end, CompensatedSum<T>& result, NoType)
+			{
+				_sumScalar<T>(expression, begin, end, result);
+			}
+
+			//------------------------------
+			//result[i] = expression[i] for i in [begin, end), where "T" is the representation of the expression.
+			template<typename Expression, typename T>
+			inline void evaluate(const Expression& expression, T* result, std::size_t begin, std::size_t end)
+			{
+				_evaluate(expression, result, begin, end, typename HasSimdLanes<T>::ResultType());
+			}
+
+			//result[i] = expression[i] ? 1 : 0 for i in [begin, end), where "expression" is a comparison of elements of type "T".
+			template<typename T, typename Expression>
+			inline void evaluateMask(const Expression& expression, std::uint8_t* result, std::size_t begin, std::size_t end)
+			{
+				_evaluateMask<T>(expression, result, begin, end, typename HasSimdLanes<T>::ResultType());
+			}
+
+			//the sum of expression[i] for i in [begin, end), where "T" is the representation of the expression.
+			template<typename T, typename Expression>
+			inline CompensatedSum<T> sum(const Expression& expression, std::size_t begin, std::size_t end)
+			{
+				CompensatedSum<T> result;
+				_sum<T>(expression, begin, end, result, typename HasSimdLanes<T>::ResultType());
+				return result;
+			}
+
+			#undef UNIT_SIMD_DISPATCH
+		}//close namespace "simd"
+	}//close namespace "internal"
+}
@@ -0,0 +1,299 @@
+//Reductions over QuantityArray and its expressions: sum, mean, minimum, maximum, dot product and trapezoidal integral.
+//Their result types are worked out like the ones of the operators of Unit,
+//so the integral of unit::W over unit::s is a quantity of the dimension of unit::J.
+//Sums run through the SIMD sum kernels with compensated summation,
+//and an execution policy splits a range over several threads.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "QuantityArray.h"
+
+namespace unit
+{
+	namespace execution
+	{
+		//run on the calling thread.
+		struct SequencedPolicy
+		{
+		};
+
+		//split the range into contiguous chunks, one per thread, the calling thread included.
+		//"threadCount" 0 means std::thread::hardware_concurrency(),
+		//and a range gets fewer threads if it has less than "minimumChunk" elements per thread.
+		//the chunks are combined in order, so the result only depends on the number of chunks.
+		struct ParallelPolicy
+		{
+			std::size_t threadCount = 0;
+			std::size_t minimumChunk = 1 << 16;
+		};
+
+		constexpr SequencedPolicy seq{};
+		constexpr ParallelPolicy par{};
+	}
+
+	namespace internal
+	{
+		template<typename T>
+		struct IsExecutionPolicy
+		{
+			typedef NoType ResultType;
+			DEFINERESULTVALUE;
+		};
+
+		template<>
+		struct IsExecutionPolicy<execution::SequencedPolicy>
+		{
+			typedef YesType ResultType;
+			DEFINERESULTVALUE;
+		};
+
+		template<>
+		struct IsExecutionPolicy<execution::ParallelPolicy>
+		{
+			typedef YesType ResultType;
+			DEFINERESULTVALUE;
+		};
+
+		//------------------------------
+		//"function(begin, end)" for chunks of [0, size) as the policy says, the results of the chunks in order.
+		template<typename Result, typename Function>
+		inline std::vector<Result> _reduceChunks(const execution::SequencedPolicy&, std::size_t size, const Function& function)
+		{
+			return std::vector<Result>(1, function(0, size));
+		}
+
+		template<typename Result, typename Function>
+		inline std::vector<Result> _reduceChunks(const execution::ParallelPolicy& policy, std::size_t size, const Function& function)
+		{
+			std::size_t threadCount = policy.threadCount ? policy.threadCount : std::thread::hardware_concurrency();
+			threadCount = std::max<std::size_t>(1, std::min(threadCount, size / std::max<std::size_t>(1, policy.minimumChunk)));
+			//whole blocks of the sum kernels, so a chunk boundary never changes how a block is added.
+			auto chunk = (size + threadCount - 1) / threadCount;
+			chunk = (chunk + simd::reductionBlockSize - 1) / simd::reductionBlockSize * simd::reductionBlockSize;
+			const auto chunkCount = chunk ? (size + chunk - 1) / chunk : 1;
+			if (chunkCount <= 1)
+				return std::vector<Result>(1, function(0, size));
+
+			std::vector<Result> results(chunkCount);
+			std::vector<std::exception_ptr> errors(chunkCount);
+			const auto run = [&](std::size_t index)
+			{
+				try
+				{
+					results[index] = function(index * chunk, std::min(size, (index + 1) * chunk));
+				}
+				catch (...)
+				{
+					errors[index] = std::current_exception();
+				}
+			};
+
+			std::vector<std::thread> threads;
+			threads.reserve(chunkCount - 1);
+			for (std::size_t i = 1; i < chunkCount; i++)
+				threads.emplace_back(run, i);
+			run(0);
+			for (auto& i : threads)
+				i.join();
+			for (auto& i : errors)
+				if (i)
+					std::rethrow_exception(i);
+			return results;
+		}
+
+		//------------------------------
+		template<typename Rep, typename Policy, typename Node>
+		inline simd::CompensatedSum<Rep> _sum(const Policy& policy, const Node& node)
+		{
+			simd::CompensatedSum<Rep> result;
+			for (auto& i : _reduceChunks<simd::CompensatedSum<Rep>>(policy, node.size(),
+				[&node](std::size_t begin, std::size_t end) { return simd::sum<Rep>(node, begin, end); }))
+				result.add(i);
+			return result;
+		}
+
+		//the smallest element, or the largest one if "isMaximum".
+		template<bool isMaximum, typename Rep, typename Policy, typename Node>
+		inline Rep _extreme(const Policy& policy, const Node& node)
+		{
+			assert(node.size() != 0);
+			const auto better = [](Rep left, Rep right) { return isMaximum ? right < left : left < right; };
+			const auto results = _reduceChunks<Rep>(policy, node.size(), [&node, &better](std::size_t begin, std::size_t end)
+			{
+				auto result = node.evaluate(simd::ScalarLanes<Rep>(), begin);
+				for (auto i = begin + 1; i < end; i++)
+				{
+					const auto value = node.evaluate(simd::ScalarLanes<Rep>(), i);
+					if (better(value, result))
+						result = value;
+				}
+				return result;
+			});
+			auto result = results[0];
+			for (auto& i : results)
+				if (better(i, result))
+					result = i;
+			return result;
+		}
+
+		//------------------------------
+		//the node of an operand whose elements are stored contiguously: a QuantityArray or a quantityView.
+		template<typename _UnitType>
+		inline _ArrayNode<_UnitType> _arrayNode(const QuantityArray<_UnitType>& operand)
+		{
+			return _ArrayNode<_UnitType>(operand);
+		}
+
+		template<typename _UnitType>
+		inline _ArrayNode<_UnitType> _arrayNode(const QuantityExpression<_ArrayNode<_UnitType>>& operand)
+		{
+			return operand.getNode();
+		}
+
+		//"count" elements of an array node from "offset".
+		template<typename _UnitType>
+		inline QuantityExpression<_ArrayNode<_UnitType>> _slice(const _ArrayNode<_UnitType>& node, std::size_t offset, std::size_t count)
+		{
+			return QuantityExpression<_ArrayNode<_UnitType>>(_ArrayNode<_UnitType>(node.values + offset, count));
+		}
+
+		template<typename Policy, typename Operand>
+		using _EnableIfReduction = std::enable_if_t<IsExecutionPolicy<Policy>::resultValue && _Operand<Operand>::isExpression>;
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Reductions
+//an operand is a QuantityArray or a QuantityExpression, including a quantityView.
+//every one has an overload without a policy, which is execution::seq.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	////////////////////////////////////////////////////
+	template<typename _Policy, typename _Operand, typename = internal::_EnableIfReduction<_Policy, _Operand>>
+	inline auto sum(const _Policy& policy, const _Operand& operand)
+	{
+		using UnitType = internal::_OperandUnitType<_Operand>;
+		using Rep = typename UnitType::Rep;
+		return UnitType(internal::_sum<Rep>(policy, internal::_Operand<_Operand>::template getNode<Rep>(operand)).get());
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	inline auto sum(const _Operand& operand)
+	{
+		return sum(execution::seq, operand);
+	}
+
+
+	////////////////////////////////////////////////////
+	//the operand must not be empty.
+	template<typename _Policy, typename _Operand, typename = internal::_EnableIfReduction<_Policy, _Operand>>
+	inline auto mean(const _Policy& policy, const _Operand& operand)
+	{
+		using UnitType = internal::_OperandUnitType<_Operand>;
+		using Rep = typename UnitType::Rep;
+		const auto& node = internal::_Operand<_Operand>::template getNode<Rep>(operand);
+		assert(node.size() != 0);
+		return UnitType(internal::_sum<Rep>(policy, node).get() / static_cast<Rep>(node.size()));
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	inline auto mean(const _Operand& operand)
+	{
+		return mean(execution::seq, operand);
+	}
+
+
+	////////////////////////////////////////////////////
+	//the operand must not be empty.
+	template<typename _Policy, typename _Operand, typename = internal::_EnableIfReduction<_Policy, _Operand>>
+	inline auto minimum(const _Policy& policy, const _Operand& operand)
+	{
+		using UnitType = internal::_OperandUnitType<_Operand>;
+		using Rep = typename UnitType::Rep;
+		return UnitType(internal::_extreme<false, Rep>(policy, internal::_Operand<_Operand>::template getNode<Rep>(operand)));
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	inline auto minimum(const _Operand& operand)
+	{
+		return minimum(execution::seq, operand);
+	}
+
+	//------------------------------
+	template<typename _Policy, typename _Operand, typename = internal::_EnableIfReduction<_Policy, _Operand>>
+	inline auto maximum(const _Policy& policy, const _Operand& operand)
+	{
+		using UnitType = internal::_OperandUnitType<_Operand>;
+		using Rep = typename UnitType::Rep;
+		return UnitType(internal::_extreme<true, Rep>(policy, internal::_Operand<_Operand>::template getNode<Rep>(operand)));
+	}
+
+	template<typename _Operand, typename = std::enable_if_t<internal::_Operand<_Operand>::isExpression>>
+	inline auto maximum(const _Operand& operand)
+	{
+		return maximum(execution::seq, operand);
+	}
+
+
+	////////////////////////////////////////////////////
+	//the sum of left[i] * right[i], with the dimension of the product.
+	template<typename _Policy, typename _Left, typename _Right, typename = std::enable_if_t<internal::IsExecutionPolicy<_Policy>::resultValue>,
+		typename = std::enable_if_t<internal::_Operand<_Left>::isExpression && internal::_Operand<_Right>::isExpression>>
+	inline auto dot(const _Policy& policy, const _Left& left, const _Right& right)
+	{
+		return sum(policy, left * right);
+	}
+
+	template<typename _Left, typename _Right, typename = std::enable_if_t<internal::_Operand<_Left>::isExpression && internal::_Operand<_Right>::isExpression>>
+	inline auto dot(const _Left& left, const _Right& right)
+	{
+		return dot(execution::seq, left, right);
+	}
+
+
+	////////////////////////////////////////////////////
+	//the integral of "y" over "x" by the trapezoidal rule, with the dimension of y * x.
+	//both are a QuantityArray or a quantityView of the same size, or it throws std::length_error,
+	//and less than two points give zero.
+	template<typename _Policy, typename _Y, typename _X, typename = std::enable_if_t<internal::IsExecutionPolicy<_Policy>::resultValue>,
+		typename = decltype(internal::_arrayNode(std::declval<_Y>())), typename = decltype(internal::_arrayNode(std::declval<_X>()))>
+	inline auto trapezoid(const _Policy& policy, const _Y& y, const _X& x)
+	{
+		const auto yNode = internal::_arrayNode(y);
+		const auto xNode = internal::_arrayNode(x);
+		internal::_checkSameSize(yNode.size(), xNode.size());
+		const auto count = yNode.size() < 2 ? 0 : yNode.size() - 1;
+		const auto twice = sum(policy, (internal::_slice(xNode, 1, count) - internal::_slice(xNode, 0, count))
+			* (internal::_slice(yNode, 0, count) + internal::_slice(yNode, 1, count)));
+		return decltype(twice)(twice.value / static_cast<typename decltype(twice)::Rep>(2));
+	}
+
+	//the same with a constant step "dx" between the points.
+	template<typename _Policy, typename _Y, typename _Dimension, typename _MultipleFactorType, typename _Rep,
+		typename = std::enable_if_t<internal::IsExecutionPolicy<_Policy>::resultValue>, typename = decltype(internal::_arrayNode(std::declval<_Y>()))>
+	inline auto trapezoid(const _Policy& policy, const _Y& y, const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& dx)
+	{
+		using UnitType = internal::_OperandUnitType<_Y>;
+		using Rep = typename UnitType::Rep;
+		const auto yNode = internal::_arrayNode(y);
+		const auto count = yNode.size();
+		const auto total = sum(policy, y);
+		const auto ends = count < 2 ? total : UnitType((yNode.values[0] + yNode.values[count - 1]) / static_cast<Rep>(2));
+		return (total - ends) * dx;
+	}
+
+	template<typename _Y, typename _X, typename = std::enable_if_t<!internal::IsExecutionPolicy<_Y>::resultValue>>
+	inline auto trapezoid(const _Y& y, const _X& x)
+	{
+		return trapezoid(execution::seq, y, x);
+	}
+}
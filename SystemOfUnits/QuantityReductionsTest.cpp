@@ -0,0 +1,106 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "QuantityReductions.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	//values that lose digits when summed naively in double.
+	QuantityArray<m_ps> makeSpeeds(std::size_t count)
+	{
+		std::mt19937_64 random(3);
+		std::uniform_real_distribution<double> distribution(0, 1);
+		QuantityArray<m_ps> result(count);
+		for (auto& i : result)
+			i = m_ps(distribution(random) * (1 + 1e8 * (distribution(random) < 0.01)));
+		return result;
+	}
+
+	long double referenceSum(const QuantityArray<m_ps>& values)
+	{
+		long double result = 0;
+		for (auto& i : values)
+			result += i.value;
+		return result;
+	}
+}
+
+UNIT_TEST(ReductionResultTypes)
+{
+	const QuantityArray<W> power{ W(1), W(3), W(5) };
+	const QuantityArray<s> time{ s(0), s(1), s(3) };
+	const auto energy = trapezoid(power, time);
+	static_assert(internal::isTypeSame<decltype(energy)::Dimension, J::Dimension>, "W over s is J.");
+	UNIT_CHECK(J(energy).value == 2 + 8);
+	const QuantityArray<m_ps> speed{ m_ps(1), m_ps(2) };
+	const auto square = dot(speed, speed);
+	static_assert(internal::isTypeSame<decltype(square)::Dimension, internal::Dimension<2, 0, -2>>, "a dot product multiplies the dimensions.");
+	UNIT_CHECK(square.value == 5);
+	//a constant step in another multiple factor.
+	UNIT_CHECK(std::abs(J(trapezoid(power, ms(1000))).value - 6) < 1e-12);
+}
+
+UNIT_TEST(ReductionsOfSmallRanges)
+{
+	const QuantityArray<m> one{ m(3) };
+	UNIT_CHECK(trapezoid(one, s(1)).value == 0);
+	UNIT_CHECK(sum(QuantityArray<m>()).value == 0);
+	UNIT_CHECK(mean(one).value == 3 && minimum(one).value == 3 && maximum(one).value == 3);
+
+	const QuantityArray<WithRep<m, std::int64_t>> integers{ WithRep<m, std::int64_t>(1), WithRep<m, std::int64_t>(5), WithRep<m, std::int64_t>(-2) };
+	UNIT_CHECK(sum(integers).value == 4 && mean(integers).value == 1);
+	UNIT_CHECK(minimum(integers).value == -2 && maximum(integers).value == 5);
+}
+
+UNIT_TEST(CompensatedSum)
+{
+	const auto speeds = makeSpeeds(1000003);
+	const auto reference = referenceSum(speeds);
+	double naive = 0;
+	for (auto& i : speeds)
+		naive += i.value;
+	const auto error = std::abs(sum(speeds).value - reference);
+	UNIT_CHECK(error <= std::abs(naive - reference));
+	UNIT_CHECK(error <= 1e-15L * std::abs(reference));
+	UNIT_CHECK(std::abs(mean(speeds).value - reference / speeds.size()) <= 1e-15L * std::abs(reference / speeds.size()));
+
+	const QuantityArray<WithRep<m_ps, float>> floats(speeds);
+	UNIT_CHECK(std::abs(sum(floats).value - reference) <= 1e-6L * std::abs(reference));
+}
+
+UNIT_TEST(ParallelReductions)
+{
+	const auto speeds = makeSpeeds(100003);
+	const auto reference = referenceSum(speeds);
+	bool close = true;
+	for (std::size_t threadCount : { 1, 2, 3, 7 })
+	{
+		const execution::ParallelPolicy policy{ threadCount, 10 };
+		close = close && std::abs(sum(policy, speeds).value - reference) <= 1e-15L * std::abs(reference);
+		close = close && minimum(policy, speeds).value == minimum(speeds).value;
+		close = close && maximum(policy, speeds * s(2)).value == maximum(speeds * s(2)).value;
+		close = close && std::abs(dot(policy, speeds, speeds).value - dot(speeds, speeds).value) <= 1e-12 * dot(speeds, speeds).value;
+	}
+	UNIT_CHECK(close);
+
+	//the result only depends on the number of chunks.
+	const execution::ParallelPolicy policy{ 4, 10 };
+	UNIT_CHECK(sum(policy, speeds).value == sum(policy, speeds).value);
+	std::vector<m_ps> vector(speeds.begin(), speeds.end());
+	UNIT_CHECK(sum(policy, quantityView(vector.data(), vector.size())).value == sum(policy, speeds).value);
+}
+
+UNIT_TEST(TrapezoidSizeMismatchThrows)
+{
+	const QuantityArray<W> power(3, W(1));
+	const QuantityArray<s> time(4, s(1));
+	UNIT_CHECK_THROWS(std::length_error, trapezoid(power, time));
+	UNIT_CHECK_THROWS(std::length_error, dot(power, time));
+}
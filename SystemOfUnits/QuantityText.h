@@ -0,0 +1,580 @@
+//Reading and writing quantities as text, such as "12.5 km", "3.2e5 Pa", "90 min" or "9.8 m/s^2".
+//The parser reads into a statically typed Unit and reports a wrong dimension with an error code, never an exception.
+//The formatter writes into a buffer given by the caller and allocates nothing.
+//Numbers go through std::from_chars and std::to_chars where the standard library has them for floats.
+
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "SystemOfUnits.h"
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <charconv>
+#include <string_view>
+#define UNIT_TEXT_STRING_VIEW 1
+#if defined(__cpp_lib_to_chars)
+#define UNIT_TEXT_CHARCONV 1
+#endif
+#endif
+
+namespace unit
+{
+	enum class TextError
+	{
+		None,
+		InvalidNumber,		//no number at the beginning.
+		OutOfRange,			//the number doesn't fit in a double, or the quantity in an integer representation.
+		UnknownUnit,		//a unit symbol that isn't known, or a malformed exponent.
+		DimensionMismatch,	//the unit has another dimension than the requested type.
+		BufferTooSmall		//the buffer can't hold the text.
+	};
+
+	//like std::from_chars_result: "end" is the first character not read.
+	struct ParseResult
+	{
+		const char* end;
+		TextError error;
+	};
+
+	//like std::to_chars_result: "end" is one past the last character written.
+	struct FormatResult
+	{
+		char* end;
+		TextError error;
+	};
+
+	namespace internal
+	{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Unit symbols
+//a unit is a product of symbols, each with an optional SI prefix and an optional exponent,
+//separated by '*' or '/': "km", "m/s^2", "kg*m2/s2", "s^-1".
+//a symbol has a dimension and a scale to the coherent SI unit of that dimension.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		//a scale as a ratio of two integers held in doubles, exact as long as they are below 2^53.
+		struct _Ratio
+		{
+			double numerator;
+			double denominator;
+		};
+
+		struct _UnitSymbol
+		{
+			const char* text;
+			IntegerType exponents[7];
+			_Ratio scale;
+			bool prefixable;
+		};
+
+		//macro listing the symbols with "Define_Symbol(text, L, M, T, I, P, N, J, numerator, denominator, prefixable)",
+		//the scale being numerator / denominator, so a gram is exactly 1 / 1000 kg.
+		//the formatter takes the first one that fits, so the ones that are never prefixed come first.
+		#define UNIT_TEXT_SYMBOLS(Define_Symbol)						\
+			Define_Symbol("min", 0, 0, 1, 0, 0, 0, 0, 60.0, 1.0, false)		\
+			Define_Symbol("h", 0, 0, 1, 0, 0, 0, 0, 3600.0, 1.0, false)		\
+			Define_Symbol("d", 0, 0, 1, 0, 0, 0, 0, 86400.0, 1.0, false)		\
+			Define_Symbol("day", 0, 0, 1, 0, 0, 0, 0, 86400.0, 1.0, false)	\
+			Define_Symbol("t", 0, 1, 0, 0, 0, 0, 0, 1000.0, 1.0, false)		\
+			Define_Symbol("m", 1, 0, 0, 0, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("g", 0, 1, 0, 0, 0, 0, 0, 1.0, 1000.0, true)		\
+			Define_Symbol("s", 0, 0, 1, 0, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("A", 0, 0, 0, 1, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("K", 0, 0, 0, 0, 1, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("mol", 0, 0, 0, 0, 0, 1, 0, 1.0, 1.0, true)		\
+			Define_Symbol("cd", 0, 0, 0, 0, 0, 0, 1, 1.0, 1.0, true)			\
+			Define_Symbol("Hz", 0, 0, -1, 0, 0, 0, 0, 1.0, 1.0, true)		\
+			Define_Symbol("N", 1, 1, -2, 0, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("Pa", -1, 1, -2, 0, 0, 0, 0, 1.0, 1.0, true)		\
+			Define_Symbol("J", 2, 1, -2, 0, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("Wh", 2, 1, -2, 0, 0, 0, 0, 3600.0, 1.0, true)		\
+			Define_Symbol("W", 2, 1, -3, 0, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("C", 0, 0, 1, 1, 0, 0, 0, 1.0, 1.0, true)			\
+			Define_Symbol("V", 2, 1, -3, -1, 0, 0, 0, 1.0, 1.0, true)		\
+			Define_Symbol("T", 0, 1, -2, -1, 0, 0, 0, 1.0, 1.0, true)		\
+			Define_Symbol("Wb", 2, 1, -2, -1, 0, 0, 0, 1.0, 1.0, true)		\
+			Define_Symbol("L", 3, 0, 0, 0, 0, 0, 0, 1.0, 1000.0, true)
+
+		//a symbol of up to 8 bytes packed into an integer, so it is looked up by a switch instead of string comparisons.
+		constexpr std::uint64_t _symbolKey(const char* text, std::size_t index = 0)
+		{
+			return text[index] == '\0' ? 0
+				: (static_cast<std::uint64_t>(static_cast<unsigned char>(text[index])) << (8 * index)) | _symbolKey(text, index + 1);
+		}
+
+		inline std::uint64_t _symbolKey(const char* first, const char* last)
+		{
+			std::uint64_t key = 0;
+			for (std::size_t i = 0; first + i != last; i++)
+				key |= static_cast<std::uint64_t>(static_cast<unsigned char>(first[i])) << (8 * i);
+			return key;
+		}
+
+		//the symbol of "key", or nullptr.
+		//the compiler turns the switch on constant keys into a jump table or a binary search.
+		inline const _UnitSymbol* _findSymbol(std::uint64_t key)
+		{
+			#define Define_Symbol(text, L, M, T, I, P, N, J, numerator, denominator, prefixable)		\
+			case _symbolKey(text):													\
+			{																		\
+				static const _UnitSymbol symbol = { text, { L, M, T, I, P, N, J }, { numerator, denominator }, prefixable };	\
+				return &symbol;														\
+			}
+
+			switch (key)
+			{
+			UNIT_TEXT_SYMBOLS(Define_Symbol)
+			default:
+				return nullptr;
+			}
+
+			#undef Define_Symbol
+		}
+
+		//the scale of an SI prefix, or 0 over 1.
+		inline _Ratio _findPrefix(std::uint64_t key)
+		{
+			switch (key)
+			{
+			case _symbolKey("Y"): return _Ratio{ 1.0e24, 1.0 };
+			case _symbolKey("Z"): return _Ratio{ 1.0e21, 1.0 };
+			case _symbolKey("E"): return _Ratio{ 1.0e18, 1.0 };
+			case _symbolKey("P"): return _Ratio{ 1.0e15, 1.0 };
+			case _symbolKey("T"): return _Ratio{ 1.0e12, 1.0 };
+			case _symbolKey("G"): return _Ratio{ 1.0e9, 1.0 };
+			case _symbolKey("M"): return _Ratio{ 1.0e6, 1.0 };
+			case _symbolKey("k"): return _Ratio{ 1.0e3, 1.0 };
+			case _symbolKey("h"): return _Ratio{ 1.0e2, 1.0 };
+			case _symbolKey("da"): return _Ratio{ 1.0e1, 1.0 };
+			case _symbolKey("d"): return _Ratio{ 1.0, 1.0e1 };
+			case _symbolKey("c"): return _Ratio{ 1.0, 1.0e2 };
+			case _symbolKey("m"): return _Ratio{ 1.0, 1.0e3 };
+			case _symbolKey("u"): return _Ratio{ 1.0, 1.0e6 };
+			case _symbolKey("\xC2\xB5"): return _Ratio{ 1.0, 1.0e6 }; //micro sign in UTF-8
+			case _symbolKey("n"): return _Ratio{ 1.0, 1.0e9 };
+			case _symbolKey("p"): return _Ratio{ 1.0, 1.0e12 };
+			case _symbolKey("f"): return _Ratio{ 1.0, 1.0e15 };
+			case _symbolKey("a"): return _Ratio{ 1.0, 1.0e18 };
+			case _symbolKey("z"): return _Ratio{ 1.0, 1.0e21 };
+			case _symbolKey("y"): return _Ratio{ 1.0, 1.0e24 };
+			default: return _Ratio{ 0.0, 1.0 };
+			}
+		}
+
+		//the prefixes in the order the formatter tries them.
+		struct _Prefix
+		{
+			const char* text;
+			double scale;
+		};
+
+		constexpr _Prefix _formatPrefixes[] = {
+			{ "", 1.0 }, { "k", 1.0e3 }, { "m", 1.0e-3 }, { "M", 1.0e6 }, { "u", 1.0e-6 }, { "G", 1.0e9 }, { "n", 1.0e-9 },
+			{ "T", 1.0e12 }, { "p", 1.0e-12 }, { "P", 1.0e15 }, { "f", 1.0e-15 }, { "E", 1.0e18 }, { "a", 1.0e-18 },
+			{ "c", 1.0e-2 }, { "d", 1.0e-1 }, { "h", 1.0e2 }, { "da", 1.0e1 },
+			{ "Z", 1.0e21 }, { "z", 1.0e-21 }, { "Y", 1.0e24 }, { "y", 1.0e-24 } };
+
+		inline bool _isSymbolCharacter(const char* position, const char* last)
+		{
+			const auto c = static_cast<unsigned char>(*position);
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c == 0xC2 && position + 1 != last && static_cast<unsigned char>(position[1]) == 0xB5);
+		}
+
+		//the dimension and the scale to the coherent SI unit of a parsed unit.
+		//the numerator and the denominator are kept apart and divided only once, when the value is converted,
+		//so "36 km/h" is 36 * 1000 / 3600, exactly 10 m/s, as Unit converts it.
+		struct _ParsedUnit
+		{
+			IntegerType exponents[7];
+			double numerator;
+			double denominator;
+
+			double getScale() const { return numerator / denominator; }
+		};
+
+		//the symbol in [first, last), possibly with a prefix.
+		inline bool _resolveSymbol(const char* first, const char* last, const _UnitSymbol*& symbol, _Ratio& prefix)
+		{
+			if (last - first > 8)
+				return false;
+			prefix = _Ratio{ 1.0, 1.0 };
+			if ((symbol = _findSymbol(_symbolKey(first, last))) != nullptr)
+				return true;
+			//"da" and the micro sign take two bytes.
+			for (std::ptrdiff_t prefixLength = 2; prefixLength >= 1; prefixLength--)
+			{
+				if (last - first <= prefixLength)
+					continue;
+				prefix = _findPrefix(_symbolKey(first, first + prefixLength));
+				if (prefix.numerator == 0.0)
+					continue;
+				symbol = _findSymbol(_symbolKey(first + prefixLength, last));
+				if (symbol && symbol->prefixable)
+					return true;
+			}
+			return false;
+		}
+
+		//read a unit from "first", or nothing if there is no symbol there.
+		inline ParseResult _parseUnit(const char* first, const char* last, _ParsedUnit& unit)
+		{
+			unit = _ParsedUnit{ { 0, 0, 0, 0, 0, 0, 0 }, 1.0, 1.0 };
+			auto position = first;
+			if (position == last || !_isSymbolCharacter(position, last))
+				return ParseResult{ position, TextError::None };
+
+			IntegerType sign = 1;
+			while (true)
+			{
+				const auto symbolBegin = position;
+				while (position != last && _isSymbolCharacter(position, last))
+					position += static_cast<unsigned char>(*position) == 0xC2 ? 2 : 1;
+
+				const _UnitSymbol* symbol;
+				_Ratio prefix;
+				if (!_resolveSymbol(symbolBegin, position, symbol, prefix))
+					return ParseResult{ position, TextError::UnknownUnit };
+
+				//"^2", "2", "^-1" or "-1".
+				IntegerType exponent = 1;
+				const bool hasCaret = position != last && *position == '^';
+				if (hasCaret)
+					position++;
+				const bool negative = position != last && *position == '-';
+				if (negative)
+					position++;
+				if (position != last && *position >= '0' && *position <= '9')
+				{
+					exponent = 0;
+					while (position != last && *position >= '0' && *position <= '9' && exponent < 100)
+						exponent = exponent * 10 + (*position++ - '0');
+				}
+				else if (hasCaret || negative)
+					return ParseResult{ position, TextError::UnknownUnit };
+				exponent *= negative ? -sign : sign;
+
+				for (std::size_t i = 0; i < 7; i++)
+					unit.exponents[i] += symbol->exponents[i] * exponent;
+				//a negative exponent swaps the numerator and the denominator.
+				const double numerator = symbol->scale.numerator * prefix.numerator;
+				const double denominator = symbol->scale.denominator * prefix.denominator;
+				for (IntegerType i = 0; i < exponent; i++)
+				{
+					unit.numerator *= numerator;
+					unit.denominator *= denominator;
+				}
+				for (IntegerType i = 0; i > exponent; i--)
+				{
+					unit.numerator *= denominator;
+					unit.denominator *= numerator;
+				}
+
+				//another factor only if a symbol follows the operator, so "km/" ends after "km".
+				if (position == last || (*position != '*' && *position != '/') || position + 1 == last || !_isSymbolCharacter(position + 1, last))
+					return ParseResult{ position, TextError::None };
+				sign = *position == '/' ? -1 : 1;
+				position++;
+			}
+		}
+
+		//read a number from "first", which must not be empty.
+#ifndef UNIT_TEXT_CHARCONV
+		inline bool _isNumberCharacter(char c)
+		{
+			return (c >= '0' && c <= '9') || c == '+' || c == '-' || c == '.' || c == 'e' || c == 'E'
+				|| ((c | 0x20) >= 'a' && (c | 0x20) <= 'z' && std::strchr("infaty", c | 0x20));
+		}
+#endif
+
+		inline ParseResult _parseNumber(const char* first, const char* last, double& value)
+		{
+			if (first != last && *first == '+')
+				first++;
+#ifdef UNIT_TEXT_CHARCONV
+			const auto result = std::from_chars(first, last, value);
+			if (result.ec == std::errc::invalid_argument)
+				return ParseResult{ first, TextError::InvalidNumber };
+			if (result.ec == std::errc::result_out_of_range)
+				return ParseResult{ result.ptr, TextError::OutOfRange };
+			return ParseResult{ result.ptr, TextError::None };
+#else
+			//std::strtod needs a terminated string, so the characters a number can have are copied first.
+			char buffer[128];
+			std::size_t length = 0;
+			while (first + length != last && length + 1 < sizeof(buffer) && _isNumberCharacter(first[length]))
+			{
+				buffer[length] = first[length];
+				length++;
+			}
+			buffer[length] = '\0';
+			if (length == 0 || buffer[0] == '+' || buffer[0] == ' ')
+				return ParseResult{ first, TextError::InvalidNumber };
+			char* end;
+			value = std::strtod(buffer, &end);
+			if (end == buffer)
+				return ParseResult{ first, TextError::InvalidNumber };
+			if (std::isinf(value) && !std::strchr("iI", buffer[buffer[0] == '-' ? 1 : 0]))
+				return ParseResult{ first + (end - buffer), TextError::OutOfRange };
+			return ParseResult{ first + (end - buffer), TextError::None };
+#endif
+		}
+
+		//write "value" from "first".
+		template<typename T>
+		inline FormatResult _formatNumber(char* first, char* last, T value)
+		{
+#ifdef UNIT_TEXT_CHARCONV
+			const auto result = std::to_chars(first, last, value);
+			if (result.ec != std::errc())
+				return FormatResult{ last, TextError::BufferTooSmall };
+			return FormatResult{ result.ptr, TextError::None };
+#else
+			//the fewest digits that read back as the same value, as std::to_chars gives.
+			char buffer[64];
+			int length;
+			if (std::is_integral<T>::value)
+				length = std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value));
+			else
+				for (int precision = std::numeric_limits<T>::digits10; ; precision++)
+				{
+					length = std::snprintf(buffer, sizeof(buffer), "%.*Lg", precision, static_cast<long double>(value));
+					if (precision >= std::numeric_limits<T>::max_digits10 || static_cast<T>(std::strtold(buffer, nullptr)) == value)
+						break;
+				}
+			if (length < 0 || length > last - first)
+				return FormatResult{ last, TextError::BufferTooSmall };
+			std::memcpy(first, buffer, static_cast<std::size_t>(length));
+			return FormatResult{ first + length, TextError::None };
+#endif
+		}
+
+		//------------------------------
+		//the text of the symbol of a Unit, worked out once per type.
+		//it is a known symbol with a prefix if one has the dimension and the multiple factor,
+		//otherwise a product of SI base units, in which case the value is written in the coherent SI unit.
+		struct _FormatSymbol
+		{
+			char text[64];
+			bool isCoherent;
+		};
+
+		inline bool _isScaleEqual(double left, double right)
+		{
+			return std::abs(left - right) <= 1e-12 * std::abs(right);
+		}
+
+		inline _FormatSymbol _makeFormatSymbol(const IntegerType (&exponents)[7], double multipleFactor)
+		{
+			_FormatSymbol result = { {}, false };
+			bool dimensionless = true;
+			for (auto i : exponents)
+				dimensionless = dimensionless && i == 0;
+			if (dimensionless && _isScaleEqual(multipleFactor, 1.0))
+				return result;
+
+			#define Define_Symbol(text, L, M, T, I, P, N, J, numerator, denominator, prefixable) { text, { L, M, T, I, P, N, J }, { numerator, denominator }, prefixable },
+			static const _UnitSymbol symbols[] = { UNIT_TEXT_SYMBOLS(Define_Symbol) };
+			#undef Define_Symbol
+
+			//a symbol without a prefix first, so "N" is never "mkN".
+			//the coherent unit is written in base units rather than with a prefixed symbol, so m3 is never "kL".
+			for (int pass = 0; pass < (_isScaleEqual(multipleFactor, 1.0) ? 1 : 2); pass++)
+			{
+				for (auto& symbol : symbols)
+				{
+					if (std::memcmp(symbol.exponents, exponents, sizeof(exponents)) != 0 || (pass == 1 && !symbol.prefixable))
+						continue;
+					for (auto& prefix : _formatPrefixes)
+					{
+						if ((prefix.text[0] == '\0') != (pass == 0))
+							continue;
+						if (_isScaleEqual(symbol.scale.numerator / symbol.scale.denominator * prefix.scale, multipleFactor))
+						{
+							std::snprintf(result.text, sizeof(result.text), "%s%s", prefix.text, symbol.text);
+							return result;
+						}
+					}
+				}
+			}
+
+			//for example "kg*m^2/s^2", or "s^-1" with nothing above the line.
+			//every factor below the line follows a '/', as the parser reads it.
+			static const char* const baseSymbols[] = { "m", "kg", "s", "A", "K", "mol", "cd" };
+			bool hasPositive = false;
+			for (auto i : exponents)
+				hasPositive = hasPositive || i > 0;
+			std::size_t length = 0;
+			for (int pass = 0; pass < 2; pass++)
+			{
+				bool first = true;
+				for (std::size_t i = 0; i < 7; i++)
+				{
+					const bool positive = exponents[i] > 0;
+					if (exponents[i] == 0 || (hasPositive && positive != (pass == 0)) || (!hasPositive && pass == 1))
+						continue;
+					const char* separator = pass == 1 ? "/" : first ? "" : "*";
+					const auto exponent = hasPositive && !positive ? -exponents[i] : exponents[i];
+					length += exponent == 1
+						? std::snprintf(result.text + length, sizeof(result.text) - length, "%s%s", separator, baseSymbols[i])
+						: std::snprintf(result.text + length, sizeof(result.text) - length, "%s%s^%d", separator, baseSymbols[i], exponent);
+					first = false;
+				}
+			}
+			result.isCoherent = true;
+			return result;
+		}
+
+		//------------------------------
+		//"value" then the symbol, see formatQuantity.
+		template<typename T>
+		inline FormatResult _formatQuantity(char* first, char* last, T value, const _FormatSymbol& symbol)
+		{
+			const auto number = _formatNumber(first, last, value);
+			if (number.error != TextError::None || symbol.text[0] == '\0')
+				return number;
+
+			const auto length = std::strlen(symbol.text);
+			if (static_cast<std::size_t>(last - number.end) < length + 1)
+				return FormatResult{ last, TextError::BufferTooSmall };
+			*number.end = ' ';
+			std::memcpy(number.end + 1, symbol.text, length);
+			return FormatResult{ number.end + 1 + length, TextError::None };
+		}
+
+		//------------------------------
+		//the number and the unit of a quantity at the beginning of [first, last), see parseQuantity.
+		inline ParseResult _parseQuantity(const char* first, const char* last, double& value, _ParsedUnit& unit)
+		{
+			while (first != last && (*first == ' ' || *first == '\t'))
+				first++;
+			const auto number = _parseNumber(first, last, value);
+			if (number.error != TextError::None)
+				return number;
+
+			auto unitBegin = number.end;
+			while (unitBegin != last && (*unitBegin == ' ' || *unitBegin == '\t'))
+				unitBegin++;
+			const auto parsed = _parseUnit(unitBegin, last, unit);
+			if (parsed.error != TextError::None)
+				return parsed;
+			return ParseResult{ parsed.end == unitBegin ? number.end : parsed.end, TextError::None };
+		}
+
+		//------------------------------
+		//the multiple factor of a Unit as a ratio, exact when the factor is rational.
+		template<typename _MultipleFactorType>
+		constexpr _Ratio _getMultipleFactorRatio(std::true_type)
+		{
+			return _Ratio{ static_cast<double>(_MultipleFactorType::num), static_cast<double>(_MultipleFactorType::den) };
+		}
+
+		template<typename _MultipleFactorType>
+		constexpr _Ratio _getMultipleFactorRatio(std::false_type)
+		{
+			return _Ratio{ static_cast<double>(_MultipleFactorType::value), 1.0 };
+		}
+
+		//------------------------------
+		//the parsed value in the representation of a Unit, false when an integer one can't hold it.
+		template<typename Rep>
+		inline bool _toTextRep(double value, Rep& result, YesType)
+		{
+			if (!_isTruncatable<Rep>(static_cast<long double>(value)))
+				return false;
+			result = static_cast<Rep>(value);
+			return true;
+		}
+
+		template<typename Rep>
+		inline bool _toTextRep(double value, Rep& result, NoType)
+		{
+			result = static_cast<Rep>(value);
+			return true;
+		}
+
+		//------------------------------
+		template<typename _UnitType>
+		inline const _FormatSymbol& _getFormatSymbol()
+		{
+			typedef typename _UnitType::Dimension D;
+			static const IntegerType exponents[7] = { D::L, D::M, D::T, D::I, D::P, D::N, D::J };
+			static const _FormatSymbol symbol = _makeFormatSymbol(exponents, _UnitType::multipleFactor);
+			return symbol;
+		}
+	}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//		Parser and formatter
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	//read a quantity like "12.5 km" from the beginning of [first, last) into "result", converted to its multiple factor.
+	//spaces may come before the number and between the number and the unit, and a number alone is dimensionless.
+	//reading stops after the unit, like std::from_chars, so "12.5 km,3 m" ends at ','.
+	//an integer representation takes the value truncated toward zero, as a conversion of Unit does,
+	//so "1.9 m" is 1 m and "1 mm" is 0 m, and a value out of its range is TextError::OutOfRange.
+	//"result" is left alone on an error.
+	//
+	//  unit::km distance;
+	//  auto result = unit::parseQuantity(field.data(), field.data() + field.size(), distance);
+	//  if (result.error != unit::TextError::None) ...
+	template<typename _UnitType>
+	inline ParseResult parseQuantity(const char* first, const char* last, _UnitType& result)
+	{
+		typedef typename _UnitType::Dimension D;
+		double value;
+		internal::_ParsedUnit unit;
+		const auto parsed = internal::_parseQuantity(first, last, value, unit);
+		if (parsed.error != TextError::None)
+			return parsed;
+
+		const internal::IntegerType expected[7] = { D::L, D::M, D::T, D::I, D::P, D::N, D::J };
+		for (std::size_t i = 0; i < 7; i++)
+			if (unit.exponents[i] != expected[i])
+				return ParseResult{ parsed.end, TextError::DimensionMismatch };
+
+		//multiply by the numerators and divide once by the denominators, so "1500 mm" is exactly 1.5 m and "36 km/h" exactly 10 m/s.
+		typedef typename _UnitType::MultipleFactorType MultipleFactorType;
+		const auto multipleFactor = internal::_getMultipleFactorRatio<MultipleFactorType>(
+			std::integral_constant<bool, internal::IsRationalMultipleFactor<MultipleFactorType>::resultValue>());
+		const auto numerator = unit.numerator * multipleFactor.denominator;
+		const auto denominator = unit.denominator * multipleFactor.numerator;
+		if (numerator != denominator)
+			value = value * numerator / denominator;
+		typename _UnitType::Rep rep;
+		if (!internal::_toTextRep(value, rep, typename internal::BoolToType<std::is_integral<typename _UnitType::Rep>::value>::ResultType()))
+			return ParseResult{ parsed.end, TextError::OutOfRange };
+		result = _UnitType(rep);
+		return ParseResult{ parsed.end, TextError::None };
+	}
+
+#ifdef UNIT_TEXT_STRING_VIEW
+	template<typename _UnitType>
+	inline ParseResult parseQuantity(std::string_view text, _UnitType& result)
+	{
+		return parseQuantity(text.data(), text.data() + text.size(), result);
+	}
+#endif
+
+	//write "quantity" like "12.5 km" into [first, last), with no terminating '\0'.
+	//the number is the shortest text that reads back to the same value where std::to_chars is there.
+	//a Unit without a symbol of its own is written in SI base units, such as "3 kg*m^2/s^2".
+	template<typename _UnitType>
+	inline FormatResult formatQuantity(char* first, char* last, const _UnitType& quantity)
+	{
+		const auto& symbol = internal::_getFormatSymbol<_UnitType>();
+		return symbol.isCoherent
+			? internal::_formatQuantity(first, last, static_cast<double>(quantity.value) * _UnitType::multipleFactor, symbol)
+			: internal::_formatQuantity(first, last, quantity.value, symbol);
+	}
+}
@@ -0,0 +1,115 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "DynamicQuantity.h"
+#include "QuantityText.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	template<typename _UnitType>
+	ParseResult parse(const char* text, _UnitType& result)
+	{
+		return parseQuantity(text, text + std::strlen(text), result);
+	}
+
+	template<typename _UnitType>
+	std::string format(const _UnitType& quantity)
+	{
+		char buffer[64];
+		const auto result = formatQuantity(buffer, buffer + sizeof(buffer), quantity);
+		return result.error == TextError::None ? std::string(buffer, result.end) : std::string("error");
+	}
+}
+
+UNIT_TEST(ParseConvertsExactly)
+{
+	m_ps speed(0);
+	UNIT_CHECK(parse("36 km/h", speed).error == TextError::None);
+	//36 * 1000 / 3600, not 36 * (1000 / 3600) = 10.000000000000002.
+	UNIT_CHECK(speed.value == 10);
+	UNIT_CHECK(parse("36 km*h^-1", speed).error == TextError::None && speed.value == 10);
+
+	m distance(0);
+	UNIT_CHECK(parse("1500 mm", distance).error == TextError::None && distance.value == 1.5);
+	km longDistance(0);
+	UNIT_CHECK(parse("12500 m", longDistance).error == TextError::None && longDistance.value == 12.5);
+	s time(0);
+	UNIT_CHECK(parse("90 min", time).error == TextError::None && time.value == 5400);
+	kg mass(0);
+	UNIT_CHECK(parse("5 t", mass).error == TextError::None && mass.value == 5000);
+	UNIT_CHECK(parse("250 g", mass).error == TextError::None && mass.value == 0.25);
+	m3 volume(0);
+	UNIT_CHECK(parse("2 L", volume).error == TextError::None && volume.value == 0.002);
+	J energy(0);
+	UNIT_CHECK(parse("1 kWh", energy).error == TextError::None && energy.value == 3.6e6);
+	m_ps2 acceleration(0);
+	UNIT_CHECK(parse("9.8 m/s^2", acceleration).error == TextError::None && acceleration.value == 9.8);
+	UNIT_CHECK(parse("9.8 m*s^-2", acceleration).error == TextError::None && acceleration.value == 9.8);
+	WithRep<ms, std::int64_t> milliseconds(0);
+	UNIT_CHECK(parse("2 s", milliseconds).error == TextError::None && milliseconds.value == 2000);
+}
+
+UNIT_TEST(ParseReportsErrors)
+{
+	m distance(7);
+	UNIT_CHECK(parse("abc", distance).error == TextError::InvalidNumber);
+	UNIT_CHECK(parse("5 foo", distance).error == TextError::UnknownUnit);
+	UNIT_CHECK(parse("5 s", distance).error == TextError::DimensionMismatch);
+	UNIT_CHECK(parse("1e999 m", distance).error == TextError::OutOfRange);
+	//left alone on an error.
+	UNIT_CHECK(distance.value == 7);
+
+	//reading stops after the unit.
+	const char text[] = "12.5 km,3 m";
+	const auto result = parse(text, distance);
+	UNIT_CHECK(result.error == TextError::None && result.end == text + 7 && distance.value == 12500);
+	const char trailing[] = "5 km/";
+	UNIT_CHECK(parse(trailing, distance).end == trailing + 4);
+}
+
+UNIT_TEST(ParseIntoIntegerRepresentation)
+{
+	typedef WithRep<m, std::int32_t> IntegerMetre;
+	IntegerMetre distance(7);
+	//out of the range of the representation, and left alone.
+	UNIT_CHECK(parse("1e12 m", distance).error == TextError::OutOfRange && distance.value == 7);
+	UNIT_CHECK(parse("-3e9 m", distance).error == TextError::OutOfRange && distance.value == 7);
+	UNIT_CHECK(parse("3000000 km", distance).error == TextError::OutOfRange && distance.value == 7);
+	UNIT_CHECK(parse("2147483647 m", distance).error == TextError::None && distance.value == 2147483647);
+	UNIT_CHECK(parse("-2147483648.5 m", distance).error == TextError::None && distance.value == -2147483647 - 1);
+
+	//truncated toward zero.
+	UNIT_CHECK(parse("1.9 m", distance).error == TextError::None && distance.value == 1);
+	UNIT_CHECK(parse("-1.9 m", distance).error == TextError::None && distance.value == -1);
+	UNIT_CHECK(parse("1999 mm", distance).error == TextError::None && distance.value == 1);
+	UNIT_CHECK(parse("2.5 km", distance).error == TextError::None && distance.value == 2500);
+}
+
+UNIT_TEST(FormatWritesTheSymbol)
+{
+	UNIT_CHECK(format(km(12.5)) == "12.5 km");
+	UNIT_CHECK(format(m_ps2(9.5)) == "9.5 m/s^2");
+	UNIT_CHECK(format(kg(3)) == "3 kg");
+	UNIT_CHECK(format(N(4)) == "4 N");
+
+	char small[8];
+	UNIT_CHECK(formatQuantity(small, small + 4, km(12.5)).error == TextError::BufferTooSmall);
+
+	//what is written reads back to the same value.
+	km distance(0);
+	const auto text = format(km(0.1));
+	UNIT_CHECK(parse(text.c_str(), distance).error == TextError::None && distance.value == 0.1);
+}
+
+UNIT_TEST(ParseDynamicQuantity)
+{
+	DynamicQuantity quantity;
+	const char text[] = "12.5 km";
+	UNIT_CHECK(parseQuantity(text, text + std::strlen(text), quantity).error == TextError::None);
+	UNIT_CHECK(quantity.value == 12.5 && quantity.scale == 1000);
+	UNIT_CHECK(quantity.to<m>().value == 12500);
+}
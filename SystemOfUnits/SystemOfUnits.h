@@ -21,6 +21,11 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 namespace unit
 {
@@ -37,7 +42,8 @@ namespace unit
 		//define the float type
 		using FloatType = double;
 
-		//define the type to store value of the quantity in class Unit.
+		//define the default type to store value of the quantity in class Unit.
+		//a Unit can choose another one with its third template argument, see class Unit.
 		using NumericType = double;
 		constexpr NumericType numericZero = 0.0;
 		constexpr NumericType numericTen = 10.0;
@@ -74,8 +80,38 @@ namespace unit
 		#define Define_MultipleFactorType(multipleFactor, className) \
 			Define_MultipleFactorValueWrapperType(multipleFactor, className)
 
+		//define the integer type of numerators and denominators of rational multiple factors.
+		using RationalIntegerType = std::intmax_t;
+
+		//macro to define a multiple factor that is exactly "numerator / denominator", like std::ratio.
+		//no ';' in the end
+		//Remember that class name can't be identical
+		//explanation:
+		//A conversion between two rational multiple factors uses their ratio reduced at compile time,
+		//so it does nothing when they are equal,
+		//and otherwise multiplies or divides once by an exact integer wherever it can.
+		//Member "value" is still there for everything that needs the factor as a float.
+		#define Define_RationalMultipleFactorType(numerator, denominator, className)							\
+		struct className																					\
+		{																									\
+			static_assert((numerator) > 0 && (denominator) > 0, "A multiple factor must be positive.");		\
+			constexpr static unit::internal::RationalIntegerType num = numerator;							\
+			constexpr static unit::internal::RationalIntegerType den = denominator;							\
+			constexpr static unit::internal::MultipleFactorValueType value =								\
+				static_cast<unit::internal::MultipleFactorValueType>(numerator) / (denominator);			\
+		};
+
 		//multiple factor is 1.
-		Define_MultipleFactorType(defaultMultipleFactorValue, DefaultMultipleFactorType)
+		Define_RationalMultipleFactorType(1, 1, DefaultMultipleFactorType)
+
+		//the conversion of a value from one multiple factor to another.
+		//static member "scale" is the value to multiply by, and static function "convert" converts a value of any representation.
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType>
+		struct ConversionFactor;
+
+		//convert a value to another multiple factor and another representation.
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType, typename ToRep, typename FromRep>
+		constexpr ToRep _convertRep(FromRep value);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //		Classes definitions
@@ -109,80 +145,77 @@ namespace unit
 		using NoDimension = Dimension<0, 0, 0, 0, 0, 0, 0>;
 
 		//class of unit
-		template<typename _Dimension, typename _MultipleFactorType = DefaultMultipleFactorType>
+		//_Rep is the type to store the value, such as float, long double or std::int64_t.
+		//arithmetic of Units of different representations promotes them like the built-in types do,
+		//while converting a Unit to another representation must be explicit:
+		//  static_cast<unit::internal::Unit<Dimension, MultipleFactorType, float>>(quantity)
+		//with an integer representation, changing the multiple factor checks for overflow and truncates toward zero.
+		template<typename _Dimension, typename _MultipleFactorType = DefaultMultipleFactorType, typename _Rep = NumericType>
 		struct Unit
 		{
-			NumericType value = numericZero;
+			_Rep value = _Rep();
 
 			typedef _Dimension Dimension;
 			typedef _MultipleFactorType MultipleFactorType;
+			typedef _Rep Rep;
 			constexpr static MultipleFactorValueType multipleFactor = MultipleFactorType::value;
 
 			Unit() = default;
 
-			explicit Unit(NumericType _value) : value(_value) { }
-
-			Unit(const Unit&) = default;
-			Unit& operator = (const Unit&) = default;
+			constexpr explicit Unit(Rep _value) : value(_value) { }
 
-			Unit operator - () const { return Unit(-value); }
-			template<typename _OtherMultipleFactorType>
-			Unit& operator +=(const Unit<Dimension, _OtherMultipleFactorType>& other);
-			template<typename _OtherMultipleFactorType>
-			Unit& operator -=(const Unit<Dimension, _OtherMultipleFactorType>& other);
-			Unit& operator *=(NumericType factor);
-			Unit& operator /=(NumericType factor);
+			//copying is implicit, and the other operators are free functions after "Operators of Unit",
+			//as every member is instantiated again for every Unit a program names.
 
 			////////////////////////////////////////////////
 			//type conversion operators
 
 			//sometimes extremely dangerous!!!
-			explicit operator NumericType() const { return value; }
+			constexpr explicit operator Rep() const { return value; }
 
-			explicit operator bool() const { return value; }
+			constexpr explicit operator bool() const { return value != Rep(); }
 
-			template<typename _NewMultipleFactorType>
-			operator Unit<Dimension, _NewMultipleFactorType>() const { return Unit<Dimension, _NewMultipleFactorType>(value * multipleFactor / _NewMultipleFactorType::value); }
+			template<typename _NewMultipleFactorType, typename _NewRep, typename = std::enable_if_t<std::is_same<_NewRep, Rep>::value>>
+			constexpr operator Unit<Dimension, _NewMultipleFactorType, _NewRep>() const { return Unit<Dimension, _NewMultipleFactorType, _NewRep>(ConversionFactor<MultipleFactorType, _NewMultipleFactorType>::convert(value)); }
+
+			template<typename _NewMultipleFactorType, typename _NewRep, typename = std::enable_if_t<!std::is_same<_NewRep, Rep>::value>, typename = void>
+			constexpr explicit operator Unit<Dimension, _NewMultipleFactorType, _NewRep>() const { return Unit<Dimension, _NewMultipleFactorType, _NewRep>(_convertRep<MultipleFactorType, _NewMultipleFactorType, _NewRep>(value)); }
 		
 		};
 
 		
 		//when no dimension,
-		//it acts like a NumericType.
+		//it acts like a Rep.
 		//just like autoboxing and autounboxing.
-		template<typename _MultipleFactorType>
-		struct Unit<NoDimension, _MultipleFactorType>
+		template<typename _MultipleFactorType, typename _Rep>
+		struct Unit<NoDimension, _MultipleFactorType, _Rep>
 		{
-			NumericType value = numericZero;
+			_Rep value = _Rep();
 
 			typedef NoDimension Dimension;
 			typedef _MultipleFactorType MultipleFactorType;
+			typedef _Rep Rep;
 			constexpr static MultipleFactorValueType multipleFactor = MultipleFactorType::value;
 
 			Unit() = default;
 
-			Unit(NumericType _value) : value(_value) { }
+			constexpr Unit(Rep _value) : value(_value) { }
 
-			Unit(const Unit&) = default;
-			Unit& operator = (const Unit&) = default;
-
-			Unit operator - () const { return Unit(-value); }
-			template<typename _OtherMultipleFactorType>
-			Unit& operator +=(const Unit<Dimension, _OtherMultipleFactorType>& other);
-			template<typename _OtherMultipleFactorType>
-			Unit& operator -=(const Unit<Dimension, _OtherMultipleFactorType>& other);
-			Unit& operator *=(NumericType factor);
-			Unit& operator /=(NumericType factor);
+			//copying is implicit, and the other operators are free functions after "Operators of Unit",
+			//as every member is instantiated again for every Unit a program names.
 
 			////////////////////////////////////////////////
 			//type conversion operators
 
-			operator NumericType() const { return value; }
+			constexpr operator Rep() const { return value; }
+
+			constexpr explicit operator bool() const { return value != Rep(); }
 
-			explicit operator bool() const { return value; }
+			template<typename _NewMultipleFactorType, typename _NewRep, typename = std::enable_if_t<std::is_same<_NewRep, Rep>::value>>
+			constexpr operator Unit<Dimension, _NewMultipleFactorType, _NewRep>() const { return Unit<Dimension, _NewMultipleFactorType, _NewRep>(ConversionFactor<MultipleFactorType, _NewMultipleFactorType>::convert(value)); }
 
-			template<typename _NewMultipleFactorType>
-			operator Unit<Dimension, _NewMultipleFactorType>() const { return Unit<Dimension, _NewMultipleFactorType>(value * multipleFactor / _NewMultipleFactorType::value); }
+			template<typename _NewMultipleFactorType, typename _NewRep, typename = std::enable_if_t<!std::is_same<_NewRep, Rep>::value>, typename = void>
+			constexpr explicit operator Unit<Dimension, _NewMultipleFactorType, _NewRep>() const { return Unit<Dimension, _NewMultipleFactorType, _NewRep>(_convertRep<MultipleFactorType, _NewMultipleFactorType, _NewRep>(value)); }
 
 		};
 
@@ -240,6 +273,10 @@ namespace unit
 
 		////////////////////////////////////////////////////////////////////////
 		//check whether two types are the same
+		//the variable template is the lighter one to instantiate, and the class gives ResultType for the rest.
+		template<typename LeftType, typename RightType>
+		constexpr bool isTypeSame = std::is_same<LeftType, RightType>::value;
+
 		template<typename LeftType, typename RightType>
 		struct IsTypeSame
 		{
@@ -261,23 +298,20 @@ namespace unit
 		template<typename LeftType, typename RightType, bool condition>
 		struct TypeConditionStatement
 		{
-			typedef RightType ResultType;
-		};
-
-		template<typename LeftType, typename RightType>
-		struct TypeConditionStatement<LeftType, RightType, true>
-		{
-			typedef LeftType ResultType;
+			typedef std::conditional_t<condition, LeftType, RightType> ResultType;
 		};
 
 
 		////////////////////////////////////////////////////////////////////////
 		//check whether two Units have the same Dimension
+		template<typename LeftUnit, typename RightUnit>
+		constexpr bool isDimensionSame = std::is_same<typename LeftUnit::Dimension, typename RightUnit::Dimension>::value;
+
 		template<typename LeftUnit, typename RightUnit>
 		struct IsDimensionSame
 		{
-			typedef typename IsTypeSame<typename LeftUnit::Dimension, typename RightUnit::Dimension>::ResultType ResultType;
-			DEFINERESULTVALUE;
+			static const bool resultValue = isDimensionSame<LeftUnit, RightUnit>;
+			DEFINERESULTTYPE;
 		};
 
 
@@ -302,13 +336,184 @@ namespace unit
 			return _getBetterMultipleFactorTypeHelper1(left) <= _getBetterMultipleFactorTypeHelper1(right);
 		}
 
+		//the operators of Unit use the alias, which instantiates no class of its own.
+		template<typename LeftMultipleFactorType, typename RightMultipleFactorType>
+		using BetterMultipleFactorType = std::conditional_t<_getBetterMultipleFactorTypeHelper2(LeftMultipleFactorType::value, RightMultipleFactorType::value),
+			LeftMultipleFactorType, RightMultipleFactorType>;
+
 		template<typename LeftMultipleFactorType, typename RightMultipleFactorType>
 		struct GetBetterMultipleFactorType
 		{
-			typedef typename TypeConditionStatement<LeftMultipleFactorType, RightMultipleFactorType, _getBetterMultipleFactorTypeHelper2(LeftMultipleFactorType::value, RightMultipleFactorType::value)>::ResultType ResultType;
+			typedef BetterMultipleFactorType<LeftMultipleFactorType, RightMultipleFactorType> ResultType;
 		};
 
 
+		////////////////////////////////////////////////////////////////////////
+		//check whether a multiple factor is rational, defined by Define_RationalMultipleFactorType.
+		template<typename _MultipleFactorType>
+		struct IsRationalMultipleFactor
+		{
+		private:
+			template<typename T>
+			static YesType _check(decltype(T::num)*, decltype(T::den)*);
+			template<typename T>
+			static NoType _check(...);
+		public:
+			typedef decltype(_check<_MultipleFactorType>(nullptr, nullptr)) ResultType;
+			DEFINERESULTVALUE;
+		};
+
+
+		////////////////////////////////////////////////////////////////////////
+		constexpr RationalIntegerType _gcd(RationalIntegerType left, RationalIntegerType right)
+		{
+			return right == 0 ? left : _gcd(right, left % right);
+		}
+
+		constexpr bool _isMultiplyOverflow(RationalIntegerType left, RationalIntegerType right)
+		{
+			return left != 0 && right > INTMAX_MAX / left;
+		}
+
+		//how ConversionFactor converts a value, known at compile time.
+		enum class ConversionKind
+		{
+			None,			//the multiple factors are equal.
+			Multiply,		//multiply by num.
+			Divide,			//divide by den.
+			MultiplyDivide,	//multiply by num, then divide by den.
+			Scale			//multiply by the float scale.
+		};
+
+		//when either multiple factor is a float, the conversion multiplies by the ratio computed at compile time.
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType,
+			bool isExact = IsRationalMultipleFactor<FromMultipleFactorType>::resultValue && IsRationalMultipleFactor<ToMultipleFactorType>::resultValue>
+		struct _ConversionFactorHelper
+		{
+			constexpr static RationalIntegerType num = 1;
+			constexpr static RationalIntegerType den = 1;
+			constexpr static MultipleFactorValueType scale = FromMultipleFactorType::value / ToMultipleFactorType::value;
+			constexpr static ConversionKind kind = scale == defaultMultipleFactorValue ? ConversionKind::None : ConversionKind::Scale;
+		};
+
+		//when both are rational, the ratio is reduced at compile time and stays exact.
+		//a ratio that doesn't fit in RationalIntegerType is a compile error.
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType>
+		struct _ConversionFactorHelper<FromMultipleFactorType, ToMultipleFactorType, true>
+		{
+		private:
+			constexpr static RationalIntegerType numeratorGcd = _gcd(FromMultipleFactorType::num, ToMultipleFactorType::num);
+			constexpr static RationalIntegerType denominatorGcd = _gcd(FromMultipleFactorType::den, ToMultipleFactorType::den);
+			constexpr static RationalIntegerType leftNumerator = FromMultipleFactorType::num / numeratorGcd;
+			constexpr static RationalIntegerType rightNumerator = ToMultipleFactorType::den / denominatorGcd;
+			constexpr static RationalIntegerType leftDenominator = FromMultipleFactorType::den / denominatorGcd;
+			constexpr static RationalIntegerType rightDenominator = ToMultipleFactorType::num / numeratorGcd;
+			static_assert(!_isMultiplyOverflow(leftNumerator, rightNumerator) && !_isMultiplyOverflow(leftDenominator, rightDenominator),
+				"The ratio of the multiple factors overflows RationalIntegerType.");
+			constexpr static RationalIntegerType resultGcd = _gcd(leftNumerator * rightNumerator, leftDenominator * rightDenominator);
+
+		public:
+			constexpr static RationalIntegerType num = leftNumerator * rightNumerator / resultGcd;
+			constexpr static RationalIntegerType den = leftDenominator * rightDenominator / resultGcd;
+			constexpr static MultipleFactorValueType scale = static_cast<MultipleFactorValueType>(num) / den;
+			constexpr static ConversionKind kind = num == den ? ConversionKind::None
+				: den == 1 ? ConversionKind::Multiply
+				: num == 1 ? ConversionKind::Divide
+				: ConversionKind::MultiplyDivide;
+		};
+
+
+		////////////////////////////////////////////////////////////////////////
+		//the largest value of an integer representation that RationalIntegerType can hold.
+		template<typename Rep>
+		constexpr RationalIntegerType _maxRational()
+		{
+			return static_cast<std::uintmax_t>(std::numeric_limits<Rep>::max()) > static_cast<std::uintmax_t>(INTMAX_MAX)
+				? INTMAX_MAX : static_cast<RationalIntegerType>(std::numeric_limits<Rep>::max());
+		}
+
+		//integer value * factor, throwing std::overflow_error if it doesn't fit in Rep.
+		template<typename Rep>
+		constexpr Rep _checkedMultiply(Rep value, RationalIntegerType factor)
+		{
+			return value == 0 ? value
+				: factor > _maxRational<Rep>()
+					|| value > std::numeric_limits<Rep>::max() / static_cast<Rep>(factor)
+					|| value < std::numeric_limits<Rep>::min() / static_cast<Rep>(factor)
+				? throw std::overflow_error("unit: the value overflows its representation when converting the multiple factor.")
+				: value * static_cast<Rep>(factor);
+		}
+
+		//integer value / divisor, truncated toward zero.
+		template<typename Rep>
+		constexpr Rep _integerDivide(Rep value, RationalIntegerType divisor)
+		{
+			return divisor > _maxRational<Rep>() ? Rep() : value / static_cast<Rep>(divisor);
+		}
+
+		//whether a float truncated toward zero fits in an integer Rep, which a NaN doesn't.
+		//the bounds are max + 1 and min - 1, both excluded. min - 1 isn't representable when long double is double,
+		//as with msvc, and would round to min, so the distance to min is compared instead.
+		template<typename Rep>
+		constexpr bool _isTruncatable(long double value)
+		{
+			return value < static_cast<long double>(std::numeric_limits<Rep>::max()) + 1.0L
+				&& value - static_cast<long double>(std::numeric_limits<Rep>::min()) > -1.0L;
+		}
+
+		//a float result truncated toward zero into an integer Rep, throwing std::overflow_error if it doesn't fit.
+		template<typename Rep>
+		constexpr Rep _checkedTruncate(long double value)
+		{
+			return !_isTruncatable<Rep>(value)
+				? throw std::overflow_error("unit: the value overflows its representation when converting the multiple factor.")
+				: static_cast<Rep>(value);
+		}
+
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType>
+		struct ConversionFactor : _ConversionFactorHelper<FromMultipleFactorType, ToMultipleFactorType>
+		{
+		private:
+			using Helper = _ConversionFactorHelper<FromMultipleFactorType, ToMultipleFactorType>;
+
+			template<typename Rep>
+			constexpr static Rep _convert(Rep value, std::false_type)
+			{
+				return Helper::kind == ConversionKind::None ? value
+					: Helper::kind == ConversionKind::Multiply ? value * static_cast<Rep>(Helper::num)
+					: Helper::kind == ConversionKind::Divide ? value / static_cast<Rep>(Helper::den)
+					: Helper::kind == ConversionKind::MultiplyDivide ? value * static_cast<Rep>(Helper::num) / static_cast<Rep>(Helper::den)
+					: value * static_cast<Rep>(Helper::scale);
+			}
+
+			template<typename Rep>
+			constexpr static Rep _convert(Rep value, std::true_type)
+			{
+				return Helper::kind == ConversionKind::None ? value
+					: Helper::kind == ConversionKind::Multiply ? _checkedMultiply(value, Helper::num)
+					: Helper::kind == ConversionKind::Divide ? _integerDivide(value, Helper::den)
+					: Helper::kind == ConversionKind::MultiplyDivide ? _integerDivide(_checkedMultiply(value, Helper::num), Helper::den)
+					: _checkedTruncate<Rep>(static_cast<long double>(value) * Helper::scale);
+			}
+
+		public:
+			//an integer representation is converted exactly where the ratio is rational, truncating toward zero,
+			//and throws std::overflow_error where the result doesn't fit.
+			template<typename Rep>
+			constexpr static Rep convert(Rep value) { return _convert(value, std::is_integral<Rep>()); }
+		};
+
+		//the operators of Unit convert their operands with it rather than with a static_cast to a Unit:
+		//its instantiations depend on the multiple factors and the representations but not on the dimension,
+		//so they are shared by all the Units of a program, and no Unit is instantiated for an intermediate value.
+		template<typename FromMultipleFactorType, typename ToMultipleFactorType, typename ToRep, typename FromRep>
+		constexpr ToRep _convertRep(FromRep value)
+		{
+			//convert in the common type of both representations, so no precision is lost before the final cast.
+			return static_cast<ToRep>(ConversionFactor<FromMultipleFactorType, ToMultipleFactorType>::convert(static_cast<std::common_type_t<FromRep, ToRep>>(value)));
+		}
+
+
 		////////////////////////////////////////////////////////////////////////
 		//------------------------------
 		//get the result type of multiplying two Dimensions.
@@ -334,154 +539,268 @@ namespace unit
 			LeftDimension::N - RightDimension::N,
 			LeftDimension::J - RightDimension::J>;
 
+		//------------------------------
+		//get the result type of raising a Dimension to the power "exponent".
+		template<typename _Dimension, IntegerType exponent>
+		using DimensionPowerResultType =
+			Dimension<_Dimension::L * exponent,
+			_Dimension::M * exponent,
+			_Dimension::T * exponent,
+			_Dimension::I * exponent,
+			_Dimension::P * exponent,
+			_Dimension::N * exponent,
+			_Dimension::J * exponent>;
+
+		//------------------------------
+		//get the result type of the "degree"-th root of a Dimension.
+		//every exponent must be a multiple of the degree, or it's a compile error.
+		template<typename _Dimension, IntegerType degree>
+		struct _DimensionRootHelper
+		{
+			static_assert(degree > 0, "The degree of a root must be positive.");
+			static_assert(_Dimension::L % degree == 0 && _Dimension::M % degree == 0 && _Dimension::T % degree == 0 && _Dimension::I % degree == 0
+				&& _Dimension::P % degree == 0 && _Dimension::N % degree == 0 && _Dimension::J % degree == 0,
+				"Every exponent of the Dimension must be a multiple of the degree of the root.");
+			typedef Dimension<_Dimension::L / degree,
+				_Dimension::M / degree,
+				_Dimension::T / degree,
+				_Dimension::I / degree,
+				_Dimension::P / degree,
+				_Dimension::N / degree,
+				_Dimension::J / degree> ResultType;
+		};
+
+		template<typename _Dimension, IntegerType degree>
+		using DimensionRootResultType = typename _DimensionRootHelper<_Dimension, degree>::ResultType;
+
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //		Operators of Unit
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+		//------------------------------
+		//the Unit two Units are converted to before an addition, a subtraction or a comparison:
+		//the better multiple factor, and the representation their values promote to.
+		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+		using CommonUnitType = Unit<_Dimension, BetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>, std::common_type_t<_LeftRep, _RightRep>>;
+
+		//------------------------------
+		//enable the operators of a Unit and a number only for arithmetic types.
+		template<typename _Number, typename _Type = void>
+		using EnableIfNumber = std::enable_if_t<std::is_arithmetic<_Number>::value, _Type>;
+
+
 		////////////////////////////////////////////////////
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline auto operator + (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+		constexpr auto operator + (const Unit<_Dimension, _LeftMultipleFactorType, _LeftRep>& left, const Unit<_Dimension, _RightMultipleFactorType, _RightRep>& right)
 		{
-			using ResultType = Unit<_Dimension, typename GetBetterMultipleFactorType<_LeftMultipleFactorType,_RightMultipleFactorType>::ResultType>;
-			return ResultType(static_cast<ResultType>(left).value + static_cast<ResultType>(right).value);
+			using ResultType = CommonUnitType<_Dimension, _LeftMultipleFactorType, _RightMultipleFactorType, _LeftRep, _RightRep>;
+			return ResultType(_convertRep<_LeftMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(left.value)
+				+ _convertRep<_RightMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(right.value));
 		}
 		
 		
 		////////////////////////////////////////////////////
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline auto operator - (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+		constexpr auto operator - (const Unit<_Dimension, _LeftMultipleFactorType, _LeftRep>& left, const Unit<_Dimension, _RightMultipleFactorType, _RightRep>& right)
 		{
-			using ResultType = Unit<_Dimension, typename GetBetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>::ResultType>;
-			return ResultType(static_cast<ResultType>(left).value - static_cast<ResultType>(right).value);
+			using ResultType = CommonUnitType<_Dimension, _LeftMultipleFactorType, _RightMultipleFactorType, _LeftRep, _RightRep>;
+			return ResultType(_convertRep<_LeftMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(left.value)
+				- _convertRep<_RightMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(right.value));
 		}
 
 
 		////////////////////////////////////////////////////
-		template<typename _LDimension, typename _RDimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline auto operator * (const Unit<_LDimension, _LeftMultipleFactorType>& left, const Unit<_RDimension, _RightMultipleFactorType>& right)
+		template<typename _LDimension, typename _RDimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+		constexpr auto operator * (const Unit<_LDimension, _LeftMultipleFactorType, _LeftRep>& left, const Unit<_RDimension, _RightMultipleFactorType, _RightRep>& right)
 		{
-			using ResultMutilpleFactorType = typename GetBetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>::ResultType;
-			using ResultType = Unit<DimensionMultiplyResultType<_LDimension, _RDimension>, ResultMutilpleFactorType>;
-			return ResultType(static_cast<Unit<_LDimension, ResultMutilpleFactorType>>(left).value * static_cast<Unit<_RDimension, ResultMutilpleFactorType>>(right).value);
+			using ResultMutilpleFactorType = BetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>;
+			using ResultRep = std::common_type_t<_LeftRep, _RightRep>;
+			using ResultType = Unit<DimensionMultiplyResultType<_LDimension, _RDimension>, ResultMutilpleFactorType, ResultRep>;
+			return ResultType(_convertRep<_LeftMultipleFactorType, ResultMutilpleFactorType, ResultRep>(left.value) * _convertRep<_RightMultipleFactorType, ResultMutilpleFactorType, ResultRep>(right.value));
 		}
 
-		template<typename _Dimension, typename _MultipleTypeDimension>
-		inline auto operator * (const Unit<_Dimension, _MultipleTypeDimension>& left, NumericType right)
+		template<typename _Dimension, typename _MultipleTypeDimension, typename _Rep, typename _Number, typename = EnableIfNumber<_Number>>
+		constexpr auto operator * (const Unit<_Dimension, _MultipleTypeDimension, _Rep>& left, _Number right)
 		{
-			return Unit<_Dimension, _MultipleTypeDimension>(left.value * right);
+			return Unit<_Dimension, _MultipleTypeDimension, std::common_type_t<_Rep, _Number>>(left.value * right);
 		}
 
-		template<typename _Dimension, typename _MultipleTypeDimension>
-		inline auto operator * (NumericType left, const Unit<_Dimension, _MultipleTypeDimension>& right)
+		template<typename _Dimension, typename _MultipleTypeDimension, typename _Rep, typename _Number, typename = EnableIfNumber<_Number>>
+		constexpr auto operator * (_Number left, const Unit<_Dimension, _MultipleTypeDimension, _Rep>& right)
 		{
-			return Unit<_Dimension, _MultipleTypeDimension>(right.value * left);
+			return Unit<_Dimension, _MultipleTypeDimension, std::common_type_t<_Rep, _Number>>(right.value * left);
 		}
 
 
 		////////////////////////////////////////////////////
-		template<typename _LDimension, typename _RDimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline auto operator / (const Unit<_LDimension, _LeftMultipleFactorType>& left, const Unit<_RDimension, _RightMultipleFactorType>& right)
+		template<typename _LDimension, typename _RDimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+		constexpr auto operator / (const Unit<_LDimension, _LeftMultipleFactorType, _LeftRep>& left, const Unit<_RDimension, _RightMultipleFactorType, _RightRep>& right)
 		{
-			using ResultMutilpleFactorType = typename GetBetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>::ResultType;
-			using ResultType = Unit<DimensionDivideResultType<_LDimension, _RDimension>, ResultMutilpleFactorType>;
-			return ResultType(static_cast<Unit<_LDimension, ResultMutilpleFactorType>>(left).value / static_cast<Unit<_RDimension, ResultMutilpleFactorType>>(right).value);
+			using ResultMutilpleFactorType = BetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>;
+			using ResultRep = std::common_type_t<_LeftRep, _RightRep>;
+			using ResultType = Unit<DimensionDivideResultType<_LDimension, _RDimension>, ResultMutilpleFactorType, ResultRep>;
+			return ResultType(_convertRep<_LeftMultipleFactorType, ResultMutilpleFactorType, ResultRep>(left.value) / _convertRep<_RightMultipleFactorType, ResultMutilpleFactorType, ResultRep>(right.value));
 		}
 		
-		template<typename _Dimension, typename _MultipleTypeDimension>
-		inline auto operator / (const Unit<_Dimension, _MultipleTypeDimension>& left, NumericType right)
+		template<typename _Dimension, typename _MultipleTypeDimension, typename _Rep, typename _Number, typename = EnableIfNumber<_Number>>
+		constexpr auto operator / (const Unit<_Dimension, _MultipleTypeDimension, _Rep>& left, _Number right)
 		{
-			return Unit<_Dimension, _MultipleTypeDimension>(left.value / right);
+			return Unit<_Dimension, _MultipleTypeDimension, std::common_type_t<_Rep, _Number>>(left.value / right);
 		}
 
 
 		////////////////////////////////////////////////////
-		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType _compare(const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
-		{
-			using ResultType = Unit<_Dimension, typename GetBetterMultipleFactorType<_LeftMultipleFactorType, _RightMultipleFactorType>::ResultType>;
-			return static_cast<ResultType>(left).value - static_cast<ResultType>(right).value;
+		//comparisons convert both sides to their CommonUnitType and compare the values,
+		//which also works for unsigned representations.
+		#define Define_UnitComparison(theOperator)																			\
+		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>	\
+		constexpr bool operator theOperator (const Unit<_Dimension, _LeftMultipleFactorType, _LeftRep>& left,				\
+			const Unit<_Dimension, _RightMultipleFactorType, _RightRep>& right)												\
+		{																													\
+			using ResultType = CommonUnitType<_Dimension, _LeftMultipleFactorType, _RightMultipleFactorType, _LeftRep, _RightRep>;	\
+			return _convertRep<_LeftMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(left.value)					\
+				theOperator _convertRep<_RightMultipleFactorType, typename ResultType::MultipleFactorType, typename ResultType::Rep>(right.value);			\
 		}
 
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator == (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
-		{
-			return _compare(left, right) == numericZero;
-		}
+		Define_UnitComparison(==)
+		//------------------------------
+		Define_UnitComparison(!=)
+		//------------------------------
+		Define_UnitComparison(>=)
+		//------------------------------
+		Define_UnitComparison(<=)
+		//------------------------------
+		Define_UnitComparison(>)
+		//------------------------------
+		Define_UnitComparison(<)
 
+		#undef Define_UnitComparison
 
+
+		////////////////////////////////////////////////////
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator != (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+		constexpr Unit<_Dimension, _MultipleFactorType, _Rep> operator - (const Unit<_Dimension, _MultipleFactorType, _Rep>& operand)
 		{
-			return _compare(left, right) != numericZero;
+			return Unit<_Dimension, _MultipleFactorType, _Rep>(-operand.value);
 		}
 
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator >= (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep, typename _OtherMultipleFactorType, typename _OtherRep>
+		inline Unit<_Dimension, _MultipleFactorType, _Rep>& operator += (Unit<_Dimension, _MultipleFactorType, _Rep>& left, const Unit<_Dimension, _OtherMultipleFactorType, _OtherRep>& right)
 		{
-			return _compare(left, right) >= numericZero;
+			left.value += _convertRep<_OtherMultipleFactorType, _MultipleFactorType, _Rep>(right.value);
+			return left;
 		}
 
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator <= (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep, typename _OtherMultipleFactorType, typename _OtherRep>
+		inline Unit<_Dimension, _MultipleFactorType, _Rep>& operator -= (Unit<_Dimension, _MultipleFactorType, _Rep>& left, const Unit<_Dimension, _OtherMultipleFactorType, _OtherRep>& right)
 		{
-			return _compare(left, right) <= numericZero;
+			left.value -= _convertRep<_OtherMultipleFactorType, _MultipleFactorType, _Rep>(right.value);
+			return left;
 		}
 
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator > (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		//the factor isn't deduced, so any number converts to the representation first, as it did to a member taking Rep.
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+		inline Unit<_Dimension, _MultipleFactorType, _Rep>& operator *= (Unit<_Dimension, _MultipleFactorType, _Rep>& left, typename Unit<_Dimension, _MultipleFactorType, _Rep>::Rep factor)
 		{
-			return _compare(left, right) > numericZero;
+			left.value *= factor;
+			return left;
 		}
 
 		//------------------------------
-		template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType>
-		inline NumericType operator < (const Unit<_Dimension, _LeftMultipleFactorType>& left, const Unit<_Dimension, _RightMultipleFactorType>& right)
+		template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+		inline Unit<_Dimension, _MultipleFactorType, _Rep>& operator /= (Unit<_Dimension, _MultipleFactorType, _Rep>& left, typename Unit<_Dimension, _MultipleFactorType, _Rep>::Rep factor)
 		{
-			return _compare(left, right) < numericZero;
+			left.value /= factor;
+			return left;
 		}
 
 
 		////////////////////////////////////////////////////
-		//------------------------------
-		template<typename _Dimension, typename _MultipleFactorType>
-		template<typename _OtherMultipleFactorType>
-		inline Unit<_Dimension, _MultipleFactorType>& Unit<_Dimension, _MultipleFactorType>::operator+=(const Unit<Dimension, _OtherMultipleFactorType>& other)
+		//value^exponent by square-and-multiply, unrolled at compile time,
+		//so a power is at most 2 * log2(exponent) multiplications and never a call to std::pow.
+		template<IntegerType exponent, typename Rep>
+		constexpr std::enable_if_t<exponent == 0, Rep> _power(Rep)
 		{
-			value += static_cast<Unit<_Dimension, _MultipleFactorType>>(other).value;
-			return *this;
+			return static_cast<Rep>(1);
 		}
 
-		//------------------------------
-		template<typename _Dimension, typename _MultipleFactorType>
-		template<typename _OtherMultipleFactorType>
-		inline Unit<_Dimension, _MultipleFactorType>& Unit<_Dimension, _MultipleFactorType>::operator-=(const Unit<Dimension, _OtherMultipleFactorType>& other)
+		template<IntegerType exponent, typename Rep>
+		constexpr std::enable_if_t<exponent == 1, Rep> _power(Rep value)
 		{
-			value -= static_cast<Unit<_Dimension, _MultipleFactorType>>(other).value;
-			return *this;
+			return value;
 		}
 
-		//------------------------------
-		template<typename _Dimension, typename _MultipleFactorType>
-		inline Unit<_Dimension, _MultipleFactorType> & Unit<_Dimension, _MultipleFactorType>::operator*=(NumericType factor)
+		template<typename Rep>
+		constexpr Rep _square(Rep value)
 		{
-			value *= factor;
-			return *this;
+			return static_cast<Rep>(value * value);
 		}
-		
+
+		template<IntegerType exponent, typename Rep>
+		constexpr std::enable_if_t<(exponent > 1), Rep> _power(Rep value)
+		{
+			return exponent % 2 == 0 ? _square(_power<exponent / 2>(value)) : static_cast<Rep>(_square(_power<exponent / 2>(value)) * value);
+		}
+
+		template<IntegerType exponent, typename Rep>
+		constexpr std::enable_if_t<(exponent < 0), Rep> _power(Rep value)
+		{
+			return static_cast<Rep>(1) / _power<-exponent>(value);
+		}
+
 		//------------------------------
-		template<typename _Dimension, typename _MultipleFactorType>
-		inline Unit<_Dimension, _MultipleFactorType> & Unit<_Dimension, _MultipleFactorType>::operator/=(NumericType factor)
+		//the "degree"-th root of a float value: square roots and cube roots as far as the degree splits into them,
+		//and std::pow only for what's left, with the sign kept as the degree left is odd.
+		enum class _RootKind
+		{
+			None,		//the degree is 1.
+			Square,		//the degree is even.
+			Cube,		//the degree is odd and a multiple of 3.
+			Power		//any other degree.
+		};
+
+		template<IntegerType degree, _RootKind = degree == 1 ? _RootKind::None
+			: degree % 2 == 0 ? _RootKind::Square
+			: degree % 3 == 0 ? _RootKind::Cube
+			: _RootKind::Power>
+		struct _Root
+		{
+			template<typename Rep>
+			static Rep apply(Rep value) { return value; }
+		};
+
+		template<IntegerType degree>
+		struct _Root<degree, _RootKind::Square>
+		{
+			template<typename Rep>
+			static Rep apply(Rep value) { return std::sqrt(_Root<degree / 2>::apply(value)); }
+		};
+
+		template<IntegerType degree>
+		struct _Root<degree, _RootKind::Cube>
+		{
+			template<typename Rep>
+			static Rep apply(Rep value) { return std::cbrt(_Root<degree / 3>::apply(value)); }
+		};
+
+		template<IntegerType degree>
+		struct _Root<degree, _RootKind::Power>
 		{
-			value /= factor;
-			return *this;
+			template<typename Rep>
+			static Rep apply(Rep value) { return value < 0 ? -std::pow(-value, static_cast<Rep>(1) / degree) : std::pow(value, static_cast<Rep>(1) / degree); }
+		};
+
+		template<IntegerType degree, typename Rep>
+		inline Rep _root(Rep value)
+		{
+			return _Root<degree>::apply(value);
 		}
 
 	}//close namespace "internal"
@@ -492,53 +811,88 @@ namespace unit
 //		Functions of Unit
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	template<typename _Dimension, typename _MultipleFactorType>
-	auto sqrt(const internal::Unit<_Dimension, _MultipleFactorType>& quantity)
+	//the quantity to the power "exponent" known at compile time, as unit::pow<3>(length) gives a volume.
+	//it's an unrolled chain of multiplications in the representation of the quantity, not std::pow,
+	//and keeps the multiple factor as a product of Units does.
+	//a negative exponent needs a float representation.
+	template<internal::IntegerType exponent, typename _Dimension, typename _MultipleFactorType, typename _Rep>
+	constexpr auto pow(const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& quantity)
+	{
+		static_assert(exponent >= 0 || std::is_floating_point<_Rep>::value, "A negative power of a Unit needs a float representation.");
+		return internal::Unit<internal::DimensionPowerResultType<_Dimension, exponent>, _MultipleFactorType, _Rep>(internal::_power<exponent>(quantity.value));
+	}
+
+	//the "degree"-th root, the inverse of pow, so it keeps the multiple factor too.
+	//every exponent of the dimension must be a multiple of the degree, so unit::sqrt(unit::m3()) doesn't compile.
+	//the result is a float representation even for an integer one, as std::sqrt returns.
+	template<internal::IntegerType degree, typename _Dimension, typename _MultipleFactorType, typename _Rep>
+	auto root(const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& quantity)
+	{
+		using Rep = decltype(std::sqrt(quantity.value));
+		return internal::Unit<internal::DimensionRootResultType<_Dimension, degree>, _MultipleFactorType, Rep>(internal::_root<degree>(static_cast<Rep>(quantity.value)));
+	}
+
+	template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+	auto sqrt(const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& quantity)
+	{
+		return root<2>(quantity);
+	}
+
+	template<typename _Dimension, typename _MultipleFactorType, typename _Rep>
+	auto cbrt(const internal::Unit<_Dimension, _MultipleFactorType, _Rep>& quantity)
 	{
-		return internal::Unit<internal::Dimension
-			<_Dimension::L/2,
-			_Dimension::M/2,
-			_Dimension::T/2,
-			_Dimension::I/2,
-			_Dimension::P/2,
-			_Dimension::N/2,
-			_Dimension::J/2>,
-			_MultipleFactorType>
-			(std::sqrt(quantity.value));
+		return root<3>(quantity);
 	}
 
+	//sqrt(left * left + right * right) of two quantities of the same dimension, without overflow or underflow in between,
+	//in their CommonUnitType with a float representation.
+	template<typename _Dimension, typename _LeftMultipleFactorType, typename _RightMultipleFactorType, typename _LeftRep, typename _RightRep>
+	auto hypot(const internal::Unit<_Dimension, _LeftMultipleFactorType, _LeftRep>& left, const internal::Unit<_Dimension, _RightMultipleFactorType, _RightRep>& right)
+	{
+		using CommonType = internal::CommonUnitType<_Dimension, _LeftMultipleFactorType, _RightMultipleFactorType, _LeftRep, _RightRep>;
+		using Rep = decltype(std::sqrt(std::declval<typename CommonType::Rep>()));
+		return internal::Unit<_Dimension, typename CommonType::MultipleFactorType, Rep>(std::hypot(
+			internal::_convertRep<_LeftMultipleFactorType, typename CommonType::MultipleFactorType, Rep>(left.value),
+			internal::_convertRep<_RightMultipleFactorType, typename CommonType::MultipleFactorType, Rep>(right.value)));
+	}
+
+	//the same Unit with another representation, such as WithRep<km, float> or WithRep<ms, std::int64_t>.
+	template<typename _UnitType, typename _Rep>
+	using WithRep = internal::Unit<typename _UnitType::Dimension, typename _UnitType::MultipleFactorType, _Rep>;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //		Concrete multipleFactorTypes
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 	namespace multipleFactorType
 	{
+		//the prefixes beyond 10^18 don't fit in RationalIntegerType, so they stay floats.
 		Define_MultipleFactorType(1.0e+24, prefix_Y);
 		Define_MultipleFactorType(1.0e+21, prefix_Z);
-		Define_MultipleFactorType(1.0e+18, prefix_E);
-		Define_MultipleFactorType(1.0e+15, prefix_P);
-		Define_MultipleFactorType(1.0e+12, prefix_T);
-		Define_MultipleFactorType(1.0e+9, prefix_G);
-		Define_MultipleFactorType(1.0e+6, prefix_M);
-		Define_MultipleFactorType(1.0e+3, prefix_k);
-		Define_MultipleFactorType(1.0e+2, prefix_h);
-		Define_MultipleFactorType(1.0e+1, prefix_da);
-		Define_MultipleFactorType(1.0e-1, prefix_d);
-		Define_MultipleFactorType(1.0e-2, prefix_c);
-		Define_MultipleFactorType(1.0e-3, prefix_m);
-		Define_MultipleFactorType(1.0e-6, prefix_w); // use w instead of micro
-		Define_MultipleFactorType(1.0e-9, prefix_n);
-		Define_MultipleFactorType(1.0e-12, prefix_p);
-		Define_MultipleFactorType(1.0e-15, prefix_f);
-		Define_MultipleFactorType(1.0e-18, prefix_a);
+		Define_RationalMultipleFactorType(1000000000000000000, 1, prefix_E);
+		Define_RationalMultipleFactorType(1000000000000000, 1, prefix_P);
+		Define_RationalMultipleFactorType(1000000000000, 1, prefix_T);
+		Define_RationalMultipleFactorType(1000000000, 1, prefix_G);
+		Define_RationalMultipleFactorType(1000000, 1, prefix_M);
+		Define_RationalMultipleFactorType(1000, 1, prefix_k);
+		Define_RationalMultipleFactorType(100, 1, prefix_h);
+		Define_RationalMultipleFactorType(10, 1, prefix_da);
+		Define_RationalMultipleFactorType(1, 10, prefix_d);
+		Define_RationalMultipleFactorType(1, 100, prefix_c);
+		Define_RationalMultipleFactorType(1, 1000, prefix_m);
+		Define_RationalMultipleFactorType(1, 1000000, prefix_w); // use w instead of micro
+		Define_RationalMultipleFactorType(1, 1000000000, prefix_n);
+		Define_RationalMultipleFactorType(1, 1000000000000, prefix_p);
+		Define_RationalMultipleFactorType(1, 1000000000000000, prefix_f);
+		Define_RationalMultipleFactorType(1, 1000000000000000000, prefix_a);
 		Define_MultipleFactorType(1.0e-21, prefix_z);
 		Define_MultipleFactorType(1.0e-24, prefix_y);
 
-		Define_MultipleFactorType(60, _MiniteToSecond);
-		Define_MultipleFactorType(3600, _HourToSecond);
-		Define_MultipleFactorType(3600 * 24, _DayToSecond);
+		Define_RationalMultipleFactorType(60, 1, _MiniteToSecond);
+		Define_RationalMultipleFactorType(3600, 1, _HourToSecond);
+		Define_RationalMultipleFactorType(3600 * 24, 1, _DayToSecond);
 
-		Define_MultipleFactorType(3.6e6, _kw_hToJ);
+		Define_RationalMultipleFactorType(3600000, 1, _kw_hToJ);
 	}
 
 
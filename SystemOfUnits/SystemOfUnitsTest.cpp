@@ -0,0 +1,137 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SystemOfUnits.h"
+#include "Test.h"
+
+using namespace unit;
+
+namespace
+{
+	using mi = WithRep<m, std::int64_t>;
+	using mmi = WithRep<mm, std::int64_t>;
+	using kmi = WithRep<km, std::int64_t>;
+	using mi32 = WithRep<m, std::int32_t>;
+	using kmi32 = WithRep<km, std::int32_t>;
+	using mmi32 = WithRep<mm, std::int32_t>;
+	using Ymi = internal::Unit<internal::Dimension<1>, multipleFactorType::prefix_Y, std::int64_t>;
+	using ymi = internal::Unit<internal::Dimension<1>, multipleFactorType::prefix_y, std::int64_t>;
+}
+
+//mixed representations promote like the representations themselves do.
+static_assert(std::is_same<m::Rep, double>::value, "double is the default representation.");
+static_assert(sizeof(WithRep<km, float>) == sizeof(float), "a Unit is nothing but its value.");
+static_assert(std::is_same<decltype(m(1) + mi(2))::Rep, double>::value, "");
+static_assert(std::is_same<decltype(mi(1) + WithRep<km, float>(1.0f))::Rep, float>::value, "");
+static_assert(std::is_same<decltype(mi(3) * 2)::Rep, std::int64_t>::value, "");
+static_assert(std::is_same<decltype(mi(3) * 2.0)::Rep, double>::value, "");
+//a change of representation is explicit, a change of multiple factor alone isn't.
+static_assert(!std::is_convertible<m, WithRep<km, float>>::value, "");
+static_assert(std::is_constructible<WithRep<km, float>, m>::value, "");
+static_assert(std::is_convertible<m, km>::value, "");
+static_assert(std::is_convertible<mi, mmi>::value, "");
+//integer conversions of constants happen at compile time.
+static_assert(mmi(mi(1500)).value == 1500000, "");
+static_assert(static_cast<kmi>(mi(1500)).value == 1, "");
+static_assert(mi(3) < m(3.5), "");
+//powers and roots change the dimension and keep the multiple factor.
+static_assert(std::is_same<decltype(pow<3>(m(2))), m3>::value, "");
+static_assert(std::is_same<decltype(pow<2>(km(2)))::MultipleFactorType, km::MultipleFactorType>::value, "");
+static_assert(std::is_same<decltype(pow<-2>(s(2)))::Dimension, internal::Dimension<0, 0, -2>>::value, "");
+static_assert(std::is_same<decltype(pow<0>(m(5)))::Dimension, internal::NoDimension>::value, "");
+static_assert(std::is_same<decltype(sqrt(m2(4))), m>::value, "");
+static_assert(std::is_same<decltype(cbrt(m3(27))), m>::value, "");
+static_assert(std::is_same<decltype(root<2>(pow<4>(m_ps(1)))), internal::Unit<internal::Dimension<2, 0, -2>>>::value, "");
+static_assert(std::is_same<decltype(hypot(m(3), km(4)))::Dimension, m::Dimension>::value, "");
+//an integer keeps its representation in a power, and a root is a float as std::sqrt returns.
+static_assert(std::is_same<decltype(pow<5>(mi32(3)))::Rep, std::int32_t>::value, "");
+static_assert(std::is_same<decltype(sqrt(WithRep<m2, std::int32_t>(9)))::Rep, double>::value, "");
+static_assert(std::is_same<decltype(cbrt(WithRep<m3, float>(8)))::Rep, float>::value, "");
+//powers are computed at compile time.
+static_assert(pow<3>(m(2)).value == 8, "");
+static_assert(pow<0>(m(5)).value == 1, "");
+static_assert(pow<-2>(s(2)).value == 0.25, "");
+static_assert(pow<5>(mi32(3)).value == 243, "");
+
+UNIT_TEST(IntegerConversionIsExact)
+{
+	UNIT_CHECK(mmi(kmi(7)).value == 7000000);
+	//truncated toward zero, as integer division does.
+	UNIT_CHECK(mi32(mmi32(-2999)).value == -2);
+	UNIT_CHECK(mi32(mmi32(2999)).value == 2);
+	UNIT_CHECK(WithRep<km, std::int16_t>(WithRep<mm, std::int16_t>(30000)).value == 0);
+	UNIT_CHECK(mi32(kmi32(-2000000)).value == -2000000000);
+	UNIT_CHECK(mi32(kmi32(2147483)).value == 2147483000);
+}
+
+UNIT_TEST(IntegerConversionOverflowThrows)
+{
+	UNIT_CHECK_THROWS(std::overflow_error, mi32(kmi32(3000000)));
+	UNIT_CHECK_THROWS(std::overflow_error, mi32(kmi32(-2147484)));
+	UNIT_CHECK_THROWS(std::overflow_error, mmi(kmi(std::numeric_limits<std::int64_t>::max() / 10)));
+	UNIT_CHECK_THROWS(std::overflow_error, WithRep<m, std::uint8_t>(WithRep<km, std::uint8_t>(1)));
+}
+
+//factors that aren't rationals of RationalIntegerType go through a long double and _checkedTruncate.
+UNIT_TEST(IntegerConversionOfFloatFactor)
+{
+	UNIT_CHECK_THROWS(std::overflow_error, mi(Ymi(1)));
+	UNIT_CHECK(mi(ymi(5)).value == 0);
+	UNIT_CHECK(mi(ymi(-5)).value == 0);
+	UNIT_CHECK(mi(Ymi(0)).value == 0);
+}
+
+UNIT_TEST(CheckedTruncateBounds)
+{
+	const auto int32Max = std::numeric_limits<std::int32_t>::max();
+	const auto int32Min = std::numeric_limits<std::int32_t>::min();
+	UNIT_CHECK(internal::_checkedTruncate<std::int32_t>(int32Max + 0.9L) == int32Max);
+	UNIT_CHECK(internal::_checkedTruncate<std::int32_t>(int32Min - 0.9L) == int32Min);
+	UNIT_CHECK(internal::_checkedTruncate<std::int32_t>(-0.9L) == 0);
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int32_t>(int32Max + 1.0L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int32_t>(int32Min - 1.0L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int32_t>(1e30L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int32_t>(-1e30L));
+
+	const auto int64Max = std::numeric_limits<std::int64_t>::max();
+	const auto int64Min = std::numeric_limits<std::int64_t>::min();
+	UNIT_CHECK(internal::_checkedTruncate<std::int64_t>(static_cast<long double>(int64Min)) == int64Min);
+	UNIT_CHECK(internal::_checkedTruncate<std::int64_t>(9.2e18L) == static_cast<std::int64_t>(9.2e18L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int64_t>(static_cast<long double>(int64Max) + 1.0L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::int64_t>(-1e19L));
+
+	UNIT_CHECK(internal::_checkedTruncate<std::uint8_t>(255.5L) == 255);
+	UNIT_CHECK(internal::_checkedTruncate<std::uint8_t>(-0.5L) == 0);
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::uint8_t>(256.0L));
+	UNIT_CHECK_THROWS(std::overflow_error, internal::_checkedTruncate<std::uint8_t>(-1.0L));
+}
+
+UNIT_TEST(MixedRepresentationArithmetic)
+{
+	const WithRep<m, long double> sum = WithRep<m, long double>(1) + m(2);
+	UNIT_CHECK(sum.value == 3);
+	const auto mixed = mi(1500) + WithRep<km, float>(1.0f);
+	UNIT_CHECK(m(mixed).value == 2500);
+	UNIT_CHECK(m(mi(3) * 2.5).value == 7.5);
+}
+
+UNIT_TEST(PowerAndRootValues)
+{
+	UNIT_CHECK(sqrt(m2(4)).value == 2);
+	UNIT_CHECK(sqrt(WithRep<m2, std::int32_t>(9)).value == 3);
+	UNIT_CHECK(std::abs(cbrt(m3(-27)).value + 3) < 1e-12);
+	UNIT_CHECK(std::abs(root<4>(pow<4>(m(3))).value - 3) < 1e-12);
+	UNIT_CHECK(std::abs(root<5>(pow<5>(m(-2))).value + 2) < 1e-12);
+	UNIT_CHECK(std::abs(root<6>(pow<6>(m(1.5))).value - 1.5) < 1e-12);
+	UNIT_CHECK(pow<-3>(m(2)).value == 0.125);
+
+	UNIT_CHECK(hypot(m(3), m(4)).value == 5);
+	UNIT_CHECK(std::abs(m(hypot(km(3), m(4000))).value - 5000) < 1e-9);
+	//no overflow or underflow in between.
+	UNIT_CHECK(hypot(m(3e300), m(4e300)).value == 5e300);
+	UNIT_CHECK(hypot(m(3e-300), m(4e-300)).value == 5e-300);
+	UNIT_CHECK(hypot(m(0), m(0)).value == 0);
+}
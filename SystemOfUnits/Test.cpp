@@ -0,0 +1,18 @@
+#include <cstdio>
+
+#include "Test.h"
+
+using namespace unit::test;
+
+//run every test, and exit with a failure if any check failed.
+int main()
+{
+	for (auto& testCase : getTestCases())
+	{
+		const auto failureCount = getFailureCount();
+		testCase.function();
+		std::printf("%s %s\n", getFailureCount() == failureCount ? "passed" : "FAILED", testCase.name);
+	}
+	std::printf("%zu tests, %zu failed checks\n", getTestCases().size(), getFailureCount());
+	return getFailureCount() == 0 ? 0 : 1;
+}
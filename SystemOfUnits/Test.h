@@ -0,0 +1,66 @@
+//A small harness for the tests of SystemOfUnits: define tests with UNIT_TEST, check with UNIT_CHECK,
+//and the main in Test.cpp runs all of them.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace unit
+{
+	namespace test
+	{
+		//a test registered by UNIT_TEST.
+		struct TestCase
+		{
+			const char* name;
+			void (*function)();
+		};
+
+		inline std::vector<TestCase>& getTestCases()
+		{
+			static std::vector<TestCase> testCases;
+			return testCases;
+		}
+
+		inline std::size_t& getFailureCount()
+		{
+			static std::size_t failureCount = 0;
+			return failureCount;
+		}
+
+		inline void reportFailure(const char* file, int line, const char* expression)
+		{
+			std::printf("%s(%d): check failed: %s\n", file, line, expression);
+			++getFailureCount();
+		}
+
+		struct TestRegistrar
+		{
+			TestRegistrar(const char* name, void (*function)()) { getTestCases().push_back(TestCase{ name, function }); }
+		};
+	}
+}
+
+//define a test function, registered to run with every other one.
+#define UNIT_TEST(name) \
+	static void name(); \
+	static const ::unit::test::TestRegistrar name##Registrar(#name, &name); \
+	static void name()
+
+//report the failure and go on with the test.
+#define UNIT_CHECK(...) \
+	do { if (!(__VA_ARGS__)) ::unit::test::reportFailure(__FILE__, __LINE__, #__VA_ARGS__); } while (false)
+
+//check that the statement throws an exception of "exceptionType".
+#define UNIT_CHECK_THROWS(exceptionType, ...) \
+	do \
+	{ \
+		bool thrown = false; \
+		try { __VA_ARGS__; } \
+		catch (const exceptionType&) { thrown = true; } \
+		if (!thrown) \
+			::unit::test::reportFailure(__FILE__, __LINE__, #__VA_ARGS__ " throws " #exceptionType); \
+	} while (false)